@@ -0,0 +1,88 @@
+//===-- bwslcol.cpp --------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Inspect a binary columnar file or convert it to CSV
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/IOUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+// std
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+auto
+type_name(bwsl::io::ColumnType type) -> char const*
+{
+  switch (type) {
+    case bwsl::io::ColumnType::Int32:
+      return "int32";
+    case bwsl::io::ColumnType::Int64:
+      return "int64";
+    case bwsl::io::ColumnType::UInt32:
+      return "uint32";
+    case bwsl::io::ColumnType::UInt64:
+      return "uint64";
+    case bwsl::io::ColumnType::Float32:
+      return "float32";
+    case bwsl::io::ColumnType::Float64:
+      return "float64";
+  }
+  return "unknown";
+}
+
+} // namespace
+
+int
+main (int ac, char **av)
+{
+  if (ac < 2) {
+    fmt::print(std::cerr, "usage: {} <file> [<output.csv> | -]\n", av[0]);
+    return EXIT_FAILURE;
+  }
+
+  try {
+    auto in = bwsl::io::ColumnarReader(av[1]);
+
+    if (ac < 3) {
+      fmt::print("rows: {}\nblocks: {}\n", in.GetNumRows(), in.GetNumBlocks());
+      if (in.IsTruncated()) {
+        fmt::print("warning: incomplete trailing block ignored\n");
+      }
+      for (auto const& c : in.GetColumns()) {
+        fmt::print("{} {}\n", c.name, type_name(c.type));
+      }
+      return EXIT_SUCCESS;
+    }
+
+    if (std::string(av[2]) == "-") {
+      in.WriteCSV(std::cout);
+    } else {
+      auto out = std::ofstream(av[2]);
+      in.WriteCSV(out);
+    }
+  } catch (std::exception const& e) {
+    fmt::print(std::cerr, "{}\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,164 @@
+//===-- CheckpointBenchmark.cpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Compare the size and speed of checkpoints with Boost archives
+///             and with the native binary archive
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/RNGUtils.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+#include <bwsl/io/CheckpointManager.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// boost
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+// std
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Everything a simulation needs to restart
+struct State
+{
+  bwsl::HistAccumulator hist{};
+  std::vector<std::mt19937_64> engines{};
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    // clang-format off
+    ar & hist;
+    ar & engines;
+    // clang-format on
+  }
+};
+
+int
+main (int ac, char **av)
+{
+  auto nbins = ac > 1 ? std::stoul(av[1]) : 1000000UL;
+  auto nengines = ac > 2 ? std::stoul(av[2]) : 10000UL;
+  auto dir = std::filesystem::temp_directory_path();
+
+  auto state = State{};
+  state.hist = bwsl::HistAccumulator(nbins);
+  for (auto i = 0UL; i < nengines; i++) {
+    state.engines.emplace_back(i);
+  }
+  auto& rng = state.engines.front();
+  for (auto i = 0UL; i < 4UL * nbins; i++) {
+    state.hist.Add(rng() % nbins);
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto seconds = [](auto d) { return std::chrono::duration<double>(d).count(); };
+
+  auto run = [&](std::string const& name, auto save, auto load) {
+    auto fname = (dir / ("bwsl_checkpoint." + name)).string();
+
+    auto t0 = clock::now();
+    {
+      auto out = std::ofstream(fname, std::ios::binary);
+      save(out);
+    }
+    auto tsave = seconds(clock::now() - t0);
+
+    auto restored = State{};
+    t0 = clock::now();
+    {
+      auto in = std::ifstream(fname, std::ios::binary);
+      load(in, restored);
+    }
+    auto tload = seconds(clock::now() - t0);
+
+    auto size = std::filesystem::file_size(fname);
+    auto ok = restored.engines == state.engines &&
+              restored.hist.GetResults() == state.hist.GetResults();
+    fmt::print("{:<14} {:8.3f} s {:8.3f} s {:10.1f} MB {}\n", name, tsave,
+               tload, size / 1e6, ok ? "" : "MISMATCH");
+    std::filesystem::remove(fname);
+  };
+
+  fmt::print("{} bins, {} mt19937_64 engines\n", nbins, nengines);
+  fmt::print("{:<14} {:>10} {:>10} {:>13}\n", "archive", "save", "load",
+             "size");
+
+  run(
+    "boost-text",
+    [&](std::ostream& out) {
+      auto oa = boost::archive::text_oarchive(out);
+      oa << state;
+    },
+    [&](std::istream& in, State& s) {
+      auto ia = boost::archive::text_iarchive(in);
+      ia >> s;
+    });
+
+  run(
+    "boost-binary",
+    [&](std::ostream& out) {
+      auto oa = boost::archive::binary_oarchive(out);
+      oa << state;
+    },
+    [&](std::istream& in, State& s) {
+      auto ia = boost::archive::binary_iarchive(in);
+      ia >> s;
+    });
+
+  run(
+    "native",
+    [&](std::ostream& out) {
+      auto oa = bwsl::io::BinaryOArchive(out);
+      oa << state;
+    },
+    [&](std::istream& in, State& s) {
+      auto ia = bwsl::io::BinaryIArchive(in);
+      ia >> s;
+    });
+
+  // time the simulation is stopped by a checkpoint, synced to the disk
+  auto fname = (dir / "bwsl_checkpoint.managed").string();
+  auto ckp = bwsl::io::CheckpointManager(fname);
+  ckp.Register("state", state);
+
+  auto t0 = clock::now();
+  ckp.Save();
+  auto tsync = seconds(clock::now() - t0);
+
+  t0 = clock::now();
+  ckp.SaveAsync();
+  auto tasync = seconds(clock::now() - t0);
+  ckp.Wait();
+
+  fmt::print("\n{:<14} {:8.3f} s\n{:<14} {:8.3f} s\n",
+             "manager",
+             tsync,
+             "manager-async",
+             tasync);
+  std::filesystem::remove(fname);
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
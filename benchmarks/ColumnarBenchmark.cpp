@@ -0,0 +1,98 @@
+//===-- ColumnarBenchmark.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Compare the CSV and the binary columnar output
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/IOUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+// std
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+int
+main (int ac, char **av)
+{
+  auto nrows = ac > 1 ? std::stoul(av[1]) : 200000UL;
+  auto ncols = ac > 2 ? std::stoul(av[2]) : 16UL;
+  auto dir = std::filesystem::temp_directory_path();
+
+  auto rng = std::mt19937_64{ 42UL };
+  auto udist = std::uniform_real_distribution<double>{ -1.0, 1.0 };
+
+  // random values generated upfront so that only the output is timed
+  auto pool = std::vector<std::vector<double>>(1024UL);
+  for (auto& row : pool) {
+    for (auto j = 0UL; j < ncols; j++) {
+      row.push_back(udist(rng));
+    }
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto seconds = [](auto d) { return std::chrono::duration<double>(d).count(); };
+
+  // formatted text, as written by ObservableGroup::PrintAndReset
+  auto csvname = (dir / "bwsl_bench.csv").string();
+  auto t0 = clock::now();
+  {
+    auto out = std::ofstream(csvname);
+    for (auto i = 0UL; i < nrows; i++) {
+      auto const& row = pool[i % pool.size()];
+      fmt::print(out, "{:.{}e}", row[0], 10);
+      for (auto j = 1UL; j < ncols; j++) {
+        fmt::print(out, ",{:.{}e}", row[j], 10);
+      }
+      fmt::print(out, "\n");
+    }
+  }
+  auto tcsv = seconds(clock::now() - t0);
+
+  auto binname = (dir / "bwsl_bench.bcol").string();
+  auto columns = std::vector<bwsl::io::Column>{};
+  for (auto j = 0UL; j < ncols; j++) {
+    columns.push_back({ fmt::format("c{}", j), bwsl::io::ColumnType::Float64 });
+  }
+  t0 = clock::now();
+  {
+    auto out = bwsl::io::ColumnarWriter(binname, columns);
+    for (auto i = 0UL; i < nrows; i++) {
+      auto const& row = pool[i % pool.size()];
+      out.AppendRow(row.begin(), row.end());
+    }
+  }
+  auto tbin = seconds(clock::now() - t0);
+
+  auto scsv = std::filesystem::file_size(csvname);
+  auto sbin = std::filesystem::file_size(binname);
+
+  fmt::print("{} rows x {} columns\n", nrows, ncols);
+  fmt::print("csv:      {:8.3f} s {:10.1f} MB\n", tcsv, scsv / 1e6);
+  fmt::print("columnar: {:8.3f} s {:10.1f} MB\n", tbin, sbin / 1e6);
+  fmt::print("speedup:  {:8.1f}x size ratio {:.2f}\n", tcsv / tbin,
+             static_cast<double>(scsv) / sbin);
+
+  std::filesystem::remove(csvname);
+  std::filesystem::remove(binname);
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,86 @@
+//===-- ConcurrentHistBenchmark.cpp ----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Throughput of the ConcurrentHistAccumulator with many threads
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/ConcurrentHistAccumulator.hpp>
+#include <bwsl/HistAccumulator.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int
+main (int ac, char **av)
+{
+  auto nsteps = ac > 1 ? std::stoul(av[1]) : 10000000UL;
+  auto nbins = ac > 2 ? std::stoul(av[2]) : 256UL;
+  auto maxthreads = ac > 3 ? std::stoul(av[3]) : 64UL;
+
+  using clock = std::chrono::steady_clock;
+
+  // run @p body on @p nthreads threads, each doing nsteps / nthreads steps
+  auto run = [nsteps, nbins](size_t nthreads, auto body) {
+    auto threads = std::vector<std::thread>{};
+    auto t0 = clock::now();
+    for (auto t = 0UL; t < nthreads; t++) {
+      threads.emplace_back([=]() {
+        auto rng = std::minstd_rand(t + 1UL);
+        for (auto i = 0UL; i < nsteps / nthreads; i++) {
+          body(rng() % nbins);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    return std::chrono::duration<double>(clock::now() - t0).count();
+  };
+
+  fmt::print("{} measurements on {} bins, {} hardware threads\n",
+             nsteps, nbins, std::thread::hardware_concurrency());
+  fmt::print("{:>8} {:>14} {:>14} {:>14}\n", "threads", "mutex [M/s]",
+             "unit [M/s]", "weighted [M/s]");
+
+  for (auto nthreads = 1UL; nthreads <= maxthreads; nthreads *= 2UL) {
+    // baseline: a single HistAccumulator behind a mutex
+    auto h = bwsl::HistAccumulator(nbins);
+    auto m = std::mutex{};
+    auto tmutex = run(nthreads, [&h, &m](size_t idx) {
+      auto lock = std::lock_guard<std::mutex>(m);
+      h.Add(idx);
+    });
+
+    auto c = bwsl::ConcurrentHistAccumulator(nbins);
+    auto tunit = run(nthreads, [&c](size_t idx) { c.Add(idx); });
+
+    c.Reset();
+    auto tweight = run(nthreads, [&c](size_t idx) { c.Add(idx, 0.5); });
+
+    auto rate = [nsteps](double t) { return nsteps / t / 1e6; };
+    fmt::print("{:>8} {:>14.1f} {:>14.1f} {:>14.1f}\n", nthreads,
+               rate(tmutex), rate(tunit), rate(tweight));
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
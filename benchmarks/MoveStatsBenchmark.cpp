@@ -0,0 +1,108 @@
+//===-- MoveStatsBenchmark.cpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Cost of the bookkeeping of a move with MoveStats,
+///             FastMoveStats and TimedMoveStats
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/MonteCarloUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <chrono>
+#include <string>
+#include <vector>
+
+int
+main (int ac, char **av)
+{
+  using namespace bwsl::montecarlo;
+
+  auto nsteps = ac > 1 ? std::stoul(av[1]) : 100000000UL;
+
+  using clock = std::chrono::steady_clock;
+
+  // a fixed pattern of results, so that only the bookkeeping is timed
+  auto results = std::vector<MoveResult>(1024UL);
+  for (auto i = 0UL; i < results.size(); i++) {
+    auto prob = static_cast<double>((i * 37UL) % 101UL) / 100.0;
+    results[i] = (i * 7UL) % 10UL < 3UL ? MoveResult::Accept(prob)
+                                        : MoveResult::Reject(prob);
+  }
+
+  // time nsteps updates, returns nanoseconds per update
+  auto run = [&](auto& stats) {
+    auto t0 = clock::now();
+    for (auto i = 0UL; i < nsteps; i++) {
+      stats.Add(results[i % results.size()]);
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    // keep the loop alive
+    if (stats.GetProposed() == nsteps + 1UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(nsteps);
+  };
+
+  // the same through Run, which times the move if the statistics do
+  auto runtimed = [&](auto& stats) {
+    auto t0 = clock::now();
+    for (auto i = 0UL; i < nsteps; i++) {
+      stats.Run([&]() { return results[i % results.size()]; });
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    if (stats.GetProposed() == nsteps + 1UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(nsteps);
+  };
+
+  // the same a batch at a time
+  auto runbatch = [&](auto& stats) {
+    auto t0 = clock::now();
+    for (auto i = 0UL; i < nsteps; i += results.size()) {
+      stats.AddBatch(results);
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    if (stats.GetProposed() == 1UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(nsteps);
+  };
+
+  auto checked = MoveStats("Move");
+  auto fast = FastMoveStats("Move");
+  auto perthread = PerThreadMoveStats<>("Move", 1UL);
+  auto fastrun = FastMoveStats("Move");
+  auto timed = TimedMoveStats("Move");
+  auto checkedbatch = MoveStats("Move");
+  auto fastbatch = FastMoveStats("Move");
+
+  fmt::print("{} updates\n", nsteps);
+  fmt::print("{:<24} {:>10}\n", "statistics", "ns/update");
+  fmt::print("{:<24} {:10.2f}\n", "MoveStats", run(checked));
+  fmt::print("{:<24} {:10.2f}\n", "FastMoveStats", run(fast));
+  fmt::print("{:<24} {:10.2f}\n", "PerThreadMoveStats", run(perthread.Get(0)));
+  fmt::print("{:<24} {:10.2f}\n", "FastMoveStats::Run", runtimed(fastrun));
+  fmt::print("{:<24} {:10.2f}\n", "TimedMoveStats::Run", runtimed(timed));
+  fmt::print(
+    "{:<24} {:10.2f}\n", "MoveStats::AddBatch", runbatch(checkedbatch));
+  fmt::print(
+    "{:<24} {:10.2f}\n", "FastMoveStats::AddBatch", runbatch(fastbatch));
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
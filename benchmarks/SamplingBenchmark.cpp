@@ -0,0 +1,109 @@
+//===-- SamplingBenchmark.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Cost of drawing from weighted discrete distributions
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Sampling.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+int
+main (int ac, char **av)
+{
+  auto ndraws = ac > 1 ? std::stoul(av[1]) : 1000000UL;
+
+  using clock = std::chrono::steady_clock;
+
+  // time ndraws calls of @p draw, returns nanoseconds per draw
+  auto run = [ndraws](auto draw) {
+    auto check = 0UL;
+    auto t0 = clock::now();
+    for (auto i = 0UL; i < ndraws; i++) {
+      check += draw();
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    if (check == 0UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(ndraws);
+  };
+
+  fmt::print("{} draws, ns per draw\n", ndraws);
+  fmt::print("{:>8} {:>12} {:>12} {:>12} {:>12} {:>12} {:>12} {:>12}\n",
+             "n",
+             "choose",
+             "psums",
+             "alias",
+             "sumtree",
+             "sumtree+set",
+             "fenwick+set",
+             "kary+set");
+
+  auto rng = std::mt19937_64(1UL);
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+  for (auto n : { 16UL, 256UL, 4096UL, 65536UL }) {
+    auto weights = std::vector<double>(n);
+    for (auto& w : weights) {
+      w = udist(rng);
+    }
+    auto psums = weights;
+    std::partial_sum(weights.begin(), weights.end(), psums.begin());
+    auto table = bwsl::sampling::AliasTable(weights);
+    auto tree = bwsl::sampling::SumTree(weights);
+    auto fenwick = bwsl::sampling::FenwickTree(weights);
+    auto kary = bwsl::sampling::KarySumTree<>(weights);
+
+    // draw an event and change its rate, as a kinetic Monte Carlo step
+    auto step = [&](auto& t) {
+      return [&]() {
+        auto i = t.Sample(rng);
+        t.Set(i, udist(rng));
+        return i + 1UL;
+      };
+    };
+
+    auto tchoose = run([&]() { return bwsl::choose_between(weights, rng); });
+    auto tpsums =
+      run([&]() { return bwsl::choose_between_psums(psums, rng); });
+    auto talias = run([&]() { return table.Sample(rng); });
+    auto ttree = run([&]() { return tree.Sample(rng); });
+    auto tupdate = run(step(tree));
+    auto tfenwick = run(step(fenwick));
+    auto tkary = run(step(kary));
+
+    fmt::print(
+      "{:>8} {:12.1f} {:12.1f} {:12.1f} {:12.1f} {:12.1f} {:12.1f} {:12.1f}\n",
+      n,
+      tchoose,
+      tpsums,
+      talias,
+      ttree,
+      tupdate,
+      tfenwick,
+      tkary);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,70 @@
+//===-- UniformBufferBenchmark.cpp -----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Cost of Metropolis acceptance tests with and without a
+///             UniformBuffer
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/UniformBuffer.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <chrono>
+#include <random>
+#include <string>
+
+int
+main (int ac, char **av)
+{
+  auto nsteps = ac > 1 ? std::stoul(av[1]) : 100000000UL;
+
+  using clock = std::chrono::steady_clock;
+
+  // time nsteps acceptance tests, returns nanoseconds per test
+  auto run = [nsteps](auto& rng) {
+    auto accepted = 0UL;
+    auto t0 = clock::now();
+    for (auto i = 0UL; i < nsteps; i++) {
+      accepted += bwsl::choose_with_probability(0.3, rng) ? 1UL : 0UL;
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    // keep the loop alive
+    if (accepted == nsteps + 1UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(nsteps);
+  };
+
+  auto mt = std::mt19937_64(1UL);
+  auto philox = bwsl::Philox4x32(1UL);
+  auto mtbuf = bwsl::UniformBuffer<std::mt19937_64>(std::mt19937_64(1UL));
+  auto pbuf = bwsl::UniformBuffer<bwsl::Philox4x32>(bwsl::Philox4x32(1UL));
+  auto fbuf =
+    bwsl::UniformBuffer<bwsl::Philox4x32, float>(bwsl::Philox4x32(1UL));
+
+  fmt::print("{} acceptance tests\n", nsteps);
+  fmt::print("{:<28} {:>8}\n", "source", "ns/test");
+  fmt::print("{:<28} {:8.2f}\n", "mt19937_64", run(mt));
+  fmt::print("{:<28} {:8.2f}\n", "Philox4x32", run(philox));
+  fmt::print("{:<28} {:8.2f}\n", "UniformBuffer<mt19937_64>", run(mtbuf));
+  fmt::print("{:<28} {:8.2f}\n", "UniformBuffer<Philox4x32>", run(pbuf));
+  fmt::print("{:<28} {:8.2f}\n", "UniformBuffer<Philox, float>", run(fbuf));
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,108 @@
+//===-- UpperBoundBenchmark.cpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Searches into uniform and skewed cumulative distributions
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/EytzingerTable.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+int
+main (int ac, char **av)
+{
+  auto nqueries = ac > 1 ? std::stoul(av[1]) : 1000000UL;
+  auto threshold = ac > 2 ? std::stol(av[2]) : bwsl::upper_bound_threshold;
+
+  using clock = std::chrono::steady_clock;
+  auto rng = std::mt19937_64(1UL);
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+
+  // time one search for each query, returns nanoseconds per search
+  auto run = [](std::vector<double> const& queries, auto search) {
+    auto check = 0UL;
+    auto t0 = clock::now();
+    for (auto x : queries) {
+      check += search(x);
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    if (check == 1UL) {
+      fmt::print("?");
+    }
+    return dt * 1e9 / static_cast<double>(queries.size());
+  };
+
+  fmt::print("{} queries, threshold {}, ns per search\n", nqueries, threshold);
+  fmt::print("{:>8} {:>10} {:>10} {:>12} {:>12} {:>12}\n",
+             "cdf",
+             "n",
+             "std",
+             "bwsl",
+             "branchless",
+             "eytzinger");
+
+  for (auto skewed : { false, true }) {
+    for (auto n : { 1000UL, 100000UL, 10000000UL }) {
+      // uniform weights, or weights decaying over many orders of magnitude
+      auto cdf = std::vector<double>(n);
+      for (auto i = 0UL; i < n; i++) {
+        auto x = static_cast<double>(i) / static_cast<double>(n);
+        cdf[i] = skewed ? std::exp(-30.0 * x) * udist(rng) : udist(rng);
+      }
+      std::partial_sum(cdf.begin(), cdf.end(), cdf.begin());
+
+      auto queries = std::vector<double>(nqueries);
+      for (auto& q : queries) {
+        q = udist(rng) * cdf.back();
+      }
+      auto table = bwsl::EytzingerTable<double>(cdf);
+
+      auto tstd = run(queries, [&](double x) {
+        return std::upper_bound(cdf.begin(), cdf.end(), x) - cdf.begin();
+      });
+      auto tbwsl = run(queries, [&](double x) {
+        return bwsl::upper_bound(cdf.begin(), cdf.end(), x, threshold) -
+               cdf.begin();
+      });
+      auto tbranchless = run(queries, [&](double x) {
+        return bwsl::branchless_upper_bound(cdf.begin(), cdf.end(), x) -
+               cdf.begin();
+      });
+      auto teytzinger =
+        run(queries, [&](double x) { return table.UpperBound(x); });
+
+      fmt::print("{:>8} {:>10} {:10.1f} {:12.1f} {:12.1f} {:12.1f}\n",
+                 skewed ? "skewed" : "uniform",
+                 n,
+                 tstd,
+                 tbwsl,
+                 tbranchless,
+                 teytzinger);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,118 @@
+//===-- WalkerScalingBenchmark.cpp -----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Strong scaling of MultiWalker with the number of threads
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/ParallelUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// A chain of spins in a field, a sweep is a Metropolis update of each spin
+struct Chain
+{
+  std::vector<int> spins = std::vector<int>(256UL, 1);
+};
+
+/// A sweep of the chain at beta = 0.5, measuring the magnetization
+template<class G>
+auto
+sweep(Chain& c, G& rng, bwsl::accumulators::NeumaierAccumulator& acc) -> void
+{
+  auto const n = c.spins.size();
+  auto m = 0L;
+  for (auto i = 0UL; i < n; i++) {
+    auto h = c.spins[(i + n - 1UL) % n] + c.spins[(i + 1UL) % n] + 0.1;
+    auto de = 2.0 * c.spins[i] * h;
+    if (de <= 0.0 || bwsl::draw_uniform(1.0, rng) < std::exp(-0.5 * de)) {
+      c.spins[i] = -c.spins[i];
+    }
+    m += c.spins[i];
+  }
+  acc.Add(static_cast<double>(m) / static_cast<double>(n));
+}
+
+} // namespace
+
+int
+main (int ac, char **av)
+{
+  using namespace bwsl;
+  using namespace bwsl::montecarlo;
+  using Driver = MultiWalker<Chain, accumulators::NeumaierAccumulator>;
+
+  auto nwalkers = ac > 1 ? std::stoul(av[1]) : 256UL;
+  auto nsweeps = ac > 2 ? std::stoul(av[2]) : 2000UL;
+  auto maxthreads = ac > 3 ? std::stoul(av[3]) : default_num_threads();
+
+  using clock = std::chrono::steady_clock;
+
+  // time the run on nthreads threads, returns seconds and the result
+  auto run = [&](size_t nthreads) {
+    auto driver = Driver(std::vector<Chain>(nwalkers), 2022UL);
+    auto pool = ThreadPool(nthreads);
+    auto t0 = clock::now();
+    for (auto b = 0; b < 10; b++) {
+      driver.RunBlock(pool, nsweeps / 10UL, sweep<Philox4x32>);
+    }
+    auto dt = std::chrono::duration<double>(clock::now() - t0).count();
+    auto all = accumulators::NeumaierAccumulator{};
+    for (auto const& block : driver.GetBlocks()) {
+      all.Merge(block);
+    }
+    return std::make_pair(dt, all.Mean());
+  };
+
+  fmt::print("{} walkers, {} sweeps of 256 spins, up to {} threads\n\n",
+             nwalkers,
+             nsweeps,
+             maxthreads);
+  fmt::print("{:>8} {:>10} {:>8} {:>10}  {}\n",
+             "threads",
+             "time [s]",
+             "speedup",
+             "efficiency",
+             "<m>");
+
+  auto [t1, m1] = run(1UL);
+  fmt::print("{:>8} {:>10.3f} {:>8.2f} {:>10.2f}  {}\n", 1, t1, 1.0, 1.0, m1);
+  auto same = true;
+  for (auto n = 2UL; n <= maxthreads; n *= 2UL) {
+    auto [t, m] = run(n);
+    auto speedup = t1 / t;
+    fmt::print("{:>8} {:>10.3f} {:>8.2f} {:>10.2f}  {}\n",
+               n,
+               t,
+               speedup,
+               speedup / static_cast<double>(n),
+               m);
+    same = same && m == m1;
+  }
+  fmt::print("\nresults {} the number of threads\n",
+             same ? "do not depend on" : "DEPEND ON");
+  return same ? 0 : 1;
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
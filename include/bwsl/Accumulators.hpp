@@ -15,6 +15,7 @@
 #pragma once
 
 #include <bwsl/accumulators/KahanAccumulator.hpp>
+#include <bwsl/accumulators/KahanAccumulatorArray.hpp>
 #include <bwsl/accumulators/KnuthWelfordAccumulator.hpp>
 #include <bwsl/accumulators/NeumaierAccumulator.hpp>
 #include <bwsl/accumulators/WestAccumulator.hpp>
@@ -18,13 +18,14 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <type_traits>
 
 namespace bwsl {
 
 ///
 /// Smart type for comparison of floating point numbers
 ///
-class Approx
+class Approx final
 {
 public:
   /// Default constructor
@@ -43,7 +44,7 @@ public:
   auto operator=(Approx&& that) -> Approx& = delete;
 
   /// Default destructor
-  virtual ~Approx() = default;
+  ~Approx() = default;
 
   /// Constructor
   Approx(double val);
@@ -136,6 +137,9 @@ inline Approx::Approx(double val)
 {
 }
 
+static_assert(sizeof(Approx) == 3UL * sizeof(double));
+static_assert(std::is_trivially_copyable<Approx>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,451 @@
+//===-- Binning.hpp --------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Policies mapping values to the bins of an histogram
+///
+/// A binning policy provides
+///
+///     Index(x)   bin of the value x, negative below the range and not less
+///                than GetNbins() above it
+///     GetNbins() number of bins
+///     GetEdges() the GetNbins() + 1 edges of the bins
+///     Widen(up)  double the range upward or downward so that every new bin
+///                is the union of two adjacent old ones, false if impossible
+///     Fits(x)    whether x can enter the range after enough widening, as
+///                long as Widen does not run out of doubles first
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/LinSpace.hpp>
+#include <bwsl/LogSpace.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Equally spaced bins
+///
+class LinearBinning
+{
+public:
+  /// Default constructor
+  LinearBinning() = default;
+
+  /// Split [@p first, @p last) in @p nbins bins
+  LinearBinning(double first, double last, size_t nbins);
+
+  /// Use the steps of a LinSpace as bins
+  template<typename T>
+  LinearBinning(LinSpace<T> const& space)
+    : LinearBinning(static_cast<double>(space.GetFirst()),
+                    static_cast<double>(space.GetLast()),
+                    space.GetSteps())
+  {
+  }
+
+  /// Bin of a value
+  [[nodiscard]] auto Index(double x) const -> long
+  {
+    return to_index(std::floor(std::fma(x, scale_, offset_)), nbins_);
+  };
+
+  /// Number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return nbins_; };
+
+  /// Edges of the bins
+  [[nodiscard]] auto GetEdges() const -> std::vector<double>;
+
+  /// Double the range
+  auto Widen(bool up) -> bool;
+
+  /// Finite values can enter the range
+  [[nodiscard]] auto Fits(double x) const -> bool { return std::isfinite(x); };
+
+  /// Convert a floored position to an index, guarding against NaN
+  static auto to_index(double t, size_t nbins) -> long
+  {
+    if (t < 0.0) {
+      return -1L;
+    }
+    if (!(t < static_cast<double>(nbins))) {
+      return static_cast<long>(nbins);
+    }
+    return static_cast<long>(t);
+  };
+
+protected:
+  /// Compute scale and offset from the range
+  auto Update() -> void;
+
+private:
+  /// Lower edge
+  double first_{ 0.0 };
+
+  /// Upper edge
+  double last_{ 1.0 };
+
+  /// Number of bins
+  size_t nbins_{ 1UL };
+
+  /// Bins per unit
+  double scale_{ 1.0 };
+
+  /// Position of zero in bins
+  double offset_{ 0.0 };
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class LinearBinning
+
+///
+/// Logarithmically spaced bins
+///
+class LogBinning
+{
+public:
+  /// Default constructor
+  LogBinning() = default;
+
+  /// Split [@p first, @p last) in @p nbins bins of equal ratio
+  LogBinning(double first, double last, size_t nbins);
+
+  /// Use the steps of a LogSpace as bins
+  template<typename T>
+  LogBinning(LogSpace<T> const& space)
+    : LogBinning(static_cast<double>(space.GetFirst()),
+                 static_cast<double>(space.GetLast()),
+                 space.GetSteps())
+  {
+  }
+
+  /// Bin of a value, non positive values are below the range
+  [[nodiscard]] auto Index(double x) const -> long
+  {
+    if (!(x > 0.0)) {
+      return -1L;
+    }
+    return LinearBinning::to_index(
+      std::floor(std::fma(std::log2(x), scale_, offset_)), nbins_);
+  };
+
+  /// Number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return nbins_; };
+
+  /// Edges of the bins
+  [[nodiscard]] auto GetEdges() const -> std::vector<double>;
+
+  /// Double the range in logarithmic scale
+  auto Widen(bool up) -> bool;
+
+  /// Finite positive values can enter the range
+  [[nodiscard]] auto Fits(double x) const -> bool
+  {
+    return x > 0.0 && std::isfinite(x);
+  };
+
+protected:
+  /// Compute scale and offset from the range
+  auto Update() -> void;
+
+private:
+  /// Binary logarithm of the lower edge
+  double first_{ 0.0 };
+
+  /// Binary logarithm of the upper edge
+  double last_{ 1.0 };
+
+  /// Number of bins
+  size_t nbins_{ 1UL };
+
+  /// Bins per octave
+  double scale_{ 1.0 };
+
+  /// Position of one in bins
+  double offset_{ 0.0 };
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class LogBinning
+
+///
+/// Logarithmic bins read directly from the bits of a double.
+///
+/// The range [2^emin, 2^emax) is split in octaves, each one divided in
+/// 2^subbits bins of equal width. The bin of a value is given by its exponent
+/// and its leading mantissa bits, so no logarithm is needed.
+///
+class Log2Binning
+{
+public:
+  /// Default constructor
+  Log2Binning() = default;
+
+  /// Cover [2^@p emin, 2^@p emax) with 2^@p subbits bins per octave
+  Log2Binning(int emin, int emax, unsigned subbits);
+
+  /// Bin of a value, non positive values are below the range
+  [[nodiscard]] auto Index(double x) const -> long
+  {
+    if (!(x > 0.0)) {
+      return -1L;
+    }
+    auto bits = std::uint64_t{};
+    std::memcpy(&bits, &x, sizeof(bits));
+    auto key = static_cast<long>(bits >> (52U - subbits_));
+    auto idx = key - base_;
+    return idx < static_cast<long>(nbins_) ? idx : static_cast<long>(nbins_);
+  };
+
+  /// Number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return nbins_; };
+
+  /// Edges of the bins
+  [[nodiscard]] auto GetEdges() const -> std::vector<double>;
+
+  /// Double the number of octaves halving the bins per octave
+  auto Widen(bool up) -> bool;
+
+  /// Finite positive values can enter the range
+  [[nodiscard]] auto Fits(double x) const -> bool
+  {
+    return x > 0.0 && std::isfinite(x);
+  };
+
+protected:
+  /// Compute the number of bins and the base key
+  auto Update() -> void;
+
+private:
+  /// Exponent of the lower edge
+  int emin_{ 0 };
+
+  /// Exponent of the upper edge
+  int emax_{ 1 };
+
+  /// Binary logarithm of the bins per octave
+  unsigned subbits_{ 0U };
+
+  /// Number of bins
+  size_t nbins_{ 1UL };
+
+  /// Key of the first bin
+  long base_{ 1023L };
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class Log2Binning
+
+inline LinearBinning::LinearBinning(double first, double last, size_t nbins)
+  : first_(first)
+  , last_(last)
+  , nbins_(nbins)
+{
+  assert(first < last);
+  assert(nbins > 0UL);
+  Update();
+}
+
+inline auto
+LinearBinning::Update() -> void
+{
+  scale_ = static_cast<double>(nbins_) / (last_ - first_);
+  offset_ = -first_ * scale_;
+}
+
+inline auto
+LinearBinning::GetEdges() const -> std::vector<double>
+{
+  auto r = std::vector<double>(nbins_ + 1UL);
+  auto width = (last_ - first_) / static_cast<double>(nbins_);
+  for (auto i = 0UL; i < nbins_; i++) {
+    r[i] = first_ + width * static_cast<double>(i);
+  }
+  r[nbins_] = last_;
+  return r;
+}
+
+inline auto
+LinearBinning::Widen(bool up) -> bool
+{
+  if (nbins_ % 2UL != 0UL) {
+    return false;
+  }
+  // the new range must be finite too, or the scale would vanish
+  auto range = last_ - first_;
+  if (!std::isfinite(2.0 * range) ||
+      !std::isfinite(up ? last_ + range : first_ - range)) {
+    return false;
+  }
+  if (up) {
+    last_ += range;
+  } else {
+    first_ -= range;
+  }
+  Update();
+  return true;
+}
+
+template<class Archive>
+void
+LinearBinning::serialize(Archive& ar, const unsigned int /* version */)
+{
+  // clang-format off
+  ar & first_;
+  ar & last_;
+  ar & nbins_;
+  ar & scale_;
+  ar & offset_;
+  // clang-format on
+}
+
+inline LogBinning::LogBinning(double first, double last, size_t nbins)
+  : first_(std::log2(first))
+  , last_(std::log2(last))
+  , nbins_(nbins)
+{
+  assert(0.0 < first && first < last);
+  assert(nbins > 0UL);
+  Update();
+}
+
+inline auto
+LogBinning::Update() -> void
+{
+  scale_ = static_cast<double>(nbins_) / (last_ - first_);
+  offset_ = -first_ * scale_;
+}
+
+inline auto
+LogBinning::GetEdges() const -> std::vector<double>
+{
+  auto r = std::vector<double>(nbins_ + 1UL);
+  auto width = (last_ - first_) / static_cast<double>(nbins_);
+  for (auto i = 0UL; i <= nbins_; i++) {
+    r[i] = std::exp2(first_ + width * static_cast<double>(i));
+  }
+  return r;
+}
+
+inline auto
+LogBinning::Widen(bool up) -> bool
+{
+  if (nbins_ % 2UL != 0UL) {
+    return false;
+  }
+  // both edges must stay within the range of the doubles
+  auto range = last_ - first_;
+  if ((up && last_ + range > 1024.0) || (!up && first_ - range < -1074.0)) {
+    return false;
+  }
+  if (up) {
+    last_ += range;
+  } else {
+    first_ -= range;
+  }
+  Update();
+  return true;
+}
+
+template<class Archive>
+void
+LogBinning::serialize(Archive& ar, const unsigned int /* version */)
+{
+  // clang-format off
+  ar & first_;
+  ar & last_;
+  ar & nbins_;
+  ar & scale_;
+  ar & offset_;
+  // clang-format on
+}
+
+inline Log2Binning::Log2Binning(int emin, int emax, unsigned subbits)
+  : emin_(emin)
+  , emax_(emax)
+  , subbits_(subbits)
+{
+  assert(emin < emax);
+  assert(-1022 <= emin && emax <= 1024);
+  assert(subbits <= 52U);
+  Update();
+}
+
+inline auto
+Log2Binning::Update() -> void
+{
+  nbins_ = static_cast<size_t>(emax_ - emin_) << subbits_;
+  base_ = static_cast<long>(emin_ + 1023) << subbits_;
+}
+
+inline auto
+Log2Binning::GetEdges() const -> std::vector<double>
+{
+  auto r = std::vector<double>(nbins_ + 1UL);
+  auto const nsub = 1UL << subbits_;
+  for (auto i = 0UL; i <= nbins_; i++) {
+    auto octave = emin_ + static_cast<int>(i >> subbits_);
+    auto sub = static_cast<double>(i & (nsub - 1UL));
+    r[i] = std::ldexp(1.0 + sub / static_cast<double>(nsub), octave);
+  }
+  return r;
+}
+
+inline auto
+Log2Binning::Widen(bool up) -> bool
+{
+  auto const octaves = emax_ - emin_;
+  if (subbits_ == 0U || (up && emax_ + octaves > 1024) ||
+      (!up && emin_ - octaves < -1022)) {
+    return false;
+  }
+  if (up) {
+    emax_ += octaves;
+  } else {
+    emin_ -= octaves;
+  }
+  subbits_--;
+  Update();
+  return true;
+}
+
+template<class Archive>
+void
+Log2Binning::serialize(Archive& ar, const unsigned int /* version */)
+{
+  // clang-format off
+  ar & emin_;
+  ar & emax_;
+  ar & subbits_;
+  ar & nbins_;
+  ar & base_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,434 @@
+//===-- ConcurrentHistAccumulator.hpp --------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ConcurrentHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Histogram which can be filled by many threads at the same time.
+///
+/// Every thread writes in one of several shards, chosen from a per-thread
+/// index, so that threads never share the cache lines of the bins they
+/// touch. The shards are merged only when the results are read. Unit
+/// measurements only increment an atomic integer, weighted measurements
+/// update an atomic sum.
+///
+/// The bins of each shard live in segments of doubling size which are never
+/// moved, so the histogram can grow with ForceAdd while other threads are
+/// adding. Reading the results while other threads are still adding is safe
+/// but gives a snapshot which is not necessarily consistent.
+///
+class ConcurrentHistAccumulator
+{
+public:
+  /// Construct an histogram
+  ConcurrentHistAccumulator(size_t nbins, size_t nshards = DefaultShards());
+
+  /// Copy constructor
+  ConcurrentHistAccumulator(ConcurrentHistAccumulator const&) = delete;
+
+  /// Move constructor
+  ConcurrentHistAccumulator(ConcurrentHistAccumulator&&) = delete;
+
+  /// Copy assignment operator
+  auto operator=(ConcurrentHistAccumulator const&)
+    -> ConcurrentHistAccumulator& = delete;
+
+  /// Move assignment operator
+  auto operator=(ConcurrentHistAccumulator&&)
+    -> ConcurrentHistAccumulator& = delete;
+
+  /// Default destructor
+  ~ConcurrentHistAccumulator() = default;
+
+  /// Add a measurement
+  template<class T>
+  auto Add(size_t idx, T val) -> void;
+
+  /// Add a unitary measurement
+  auto Add(size_t idx) -> void;
+
+  /// Add a measurement and increase the number of bins
+  template<class T>
+  auto ForceAdd(size_t idx, T val) -> void;
+
+  /// Add an unitary measurement and increase the number of bins
+  auto ForceAdd(size_t idx) -> void;
+
+  /// Reset the histogram, not to be called while other threads are adding
+  auto Reset() -> void;
+
+  /// Get a single component result
+  [[nodiscard]] auto GetResult(size_t idx) const -> double;
+
+  /// Get the result of all the components
+  [[nodiscard]] auto GetResults() const -> std::vector<double>;
+
+  /// Get the results of all the components but divide by the one
+  /// given.
+  [[nodiscard]] auto GetResults(size_t idx) const -> std::vector<double>;
+
+  /// Get the number of measurements in total
+  [[nodiscard]] auto GetCount() const -> size_t;
+
+  /// Get the count of a single observable
+  [[nodiscard]] auto GetCount(size_t idx) const -> size_t;
+
+  /// Get the number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t
+  {
+    return nbins_.load(std::memory_order_acquire);
+  };
+
+  /// Get the number of shards
+  [[nodiscard]] auto GetNshards() const -> size_t { return shards_.size(); };
+
+  /// Default number of shards, one per hardware thread
+  [[nodiscard]] static auto DefaultShards() -> size_t
+  {
+    return std::max(1U, std::thread::hardware_concurrency());
+  };
+
+protected:
+  /// Bins of a segment
+  struct Segment
+  {
+    /// Construct a segment with @p n empty bins
+    Segment(size_t n)
+      : units(new std::atomic<std::uint64_t>[n])
+      , counts(new std::atomic<std::uint64_t>[n])
+      , sums(new std::atomic<double>[n])
+      , size(n)
+    {
+      Reset();
+    }
+
+    /// Empty all the bins
+    auto Reset() -> void
+    {
+      for (auto i = 0UL; i < size; i++) {
+        units[i].store(0UL, std::memory_order_relaxed);
+        counts[i].store(0UL, std::memory_order_relaxed);
+        sums[i].store(0.0, std::memory_order_relaxed);
+      }
+    }
+
+    /// Number of unitary measurements
+    std::unique_ptr<std::atomic<std::uint64_t>[]> units;
+
+    /// Number of weighted measurements
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+
+    /// Sum of the weighted measurements
+    std::unique_ptr<std::atomic<double>[]> sums;
+
+    /// Number of bins
+    size_t size;
+  };
+
+  /// Maximum number of segments of a shard
+  static constexpr size_t max_segments_ = 48UL;
+
+  /// Bins written by a group of threads
+  struct alignas(64) Shard
+  {
+    /// Segments, allocated on demand and never moved
+    std::array<std::atomic<Segment*>, max_segments_> segments{};
+
+    /// Number of measurements added to the shard, in a cache line after
+    /// the read-mostly segments
+    std::atomic<std::uint64_t> count{ 0UL };
+
+    /// Free the segments
+    ~Shard()
+    {
+      for (auto& s : segments) {
+        delete s.load(std::memory_order_relaxed);
+      }
+    }
+  };
+
+  /// Segment and offset of a bin
+  [[nodiscard]] auto Locate(size_t idx) const -> std::pair<size_t, size_t>;
+
+  /// Get the segment @p seg of @p shard, allocating it if needed
+  auto EnsureSegment(Shard& shard, size_t seg) -> Segment*;
+
+  /// Shard used by the calling thread
+  auto GetShard() -> Shard& { return shards_[ThreadIndex() % shards_.size()]; };
+
+  /// Index of the calling thread, assigned on first use
+  static auto ThreadIndex() -> size_t;
+
+  /// Increase the number of bins to at least @p nbins
+  auto Grow(size_t nbins) -> void;
+
+  /// Apply @p fn to the bin @p idx of every shard which has it
+  template<class Fn>
+  auto ForEachShard(size_t idx, Fn fn) const -> void;
+
+private:
+  /// Size of the first segment, a power of two
+  size_t base_;
+
+  /// Binary logarithm of base_
+  size_t logbase_{ 0UL };
+
+  /// Number of bins
+  std::atomic<size_t> nbins_;
+
+  /// The shards
+  std::vector<Shard> shards_;
+}; // class ConcurrentHistAccumulator
+
+inline ConcurrentHistAccumulator::ConcurrentHistAccumulator(size_t nbins,
+                                                            size_t nshards)
+  : base_(64UL)
+  , nbins_(nbins)
+  , shards_(std::max(nshards, 1UL))
+{
+  while (base_ < nbins) {
+    base_ <<= 1UL;
+  }
+  while ((1UL << logbase_) < base_) {
+    logbase_++;
+  }
+  for (auto& s : shards_) {
+    EnsureSegment(s, 0UL);
+  }
+}
+
+inline auto
+ConcurrentHistAccumulator::ThreadIndex() -> size_t
+{
+  static std::atomic<size_t> next{ 0UL };
+  thread_local auto const index = next.fetch_add(1UL);
+  return index;
+}
+
+inline auto
+ConcurrentHistAccumulator::Locate(size_t idx) const
+  -> std::pair<size_t, size_t>
+{
+  // segment 0 holds base_ bins, segment k > 0 holds base_ << (k - 1) bins
+  auto q = idx >> logbase_;
+  if (q == 0UL) {
+    return { 0UL, idx };
+  }
+  auto k = 0UL;
+  while (q != 0UL) {
+    q >>= 1UL;
+    k++;
+  }
+  return { k, idx - (base_ << (k - 1UL)) };
+}
+
+inline auto
+ConcurrentHistAccumulator::EnsureSegment(Shard& shard, size_t seg) -> Segment*
+{
+  auto* s = shard.segments[seg].load(std::memory_order_acquire);
+  if (s != nullptr) {
+    return s;
+  }
+
+  auto size = seg == 0UL ? base_ : base_ << (seg - 1UL);
+  auto fresh = std::make_unique<Segment>(size);
+  if (shard.segments[seg].compare_exchange_strong(
+        s, fresh.get(), std::memory_order_acq_rel)) {
+    return fresh.release();
+  }
+  // another thread installed the segment first
+  return s;
+}
+
+inline auto
+ConcurrentHistAccumulator::Grow(size_t nbins) -> void
+{
+  auto n = nbins_.load(std::memory_order_relaxed);
+  while (n < nbins && !nbins_.compare_exchange_weak(
+                        n, nbins, std::memory_order_acq_rel)) {
+  }
+}
+
+inline auto
+ConcurrentHistAccumulator::Add(size_t idx) -> void
+{
+  assert(idx < GetNbins());
+  auto [seg, off] = Locate(idx);
+  auto& shard = GetShard();
+  auto* s = EnsureSegment(shard, seg);
+  s->units[off].fetch_add(1UL, std::memory_order_relaxed);
+  shard.count.fetch_add(1UL, std::memory_order_relaxed);
+}
+
+template<class T>
+inline auto
+ConcurrentHistAccumulator::Add(size_t idx, T val) -> void
+{
+  assert(idx < GetNbins());
+  auto [seg, off] = Locate(idx);
+  auto& shard = GetShard();
+  auto* s = EnsureSegment(shard, seg);
+
+  auto& sum = s->sums[off];
+  auto old = sum.load(std::memory_order_relaxed);
+  while (!sum.compare_exchange_weak(old,
+                                    old + static_cast<double>(val),
+                                    std::memory_order_relaxed)) {
+  }
+  s->counts[off].fetch_add(1UL, std::memory_order_relaxed);
+  shard.count.fetch_add(1UL, std::memory_order_relaxed);
+}
+
+inline auto
+ConcurrentHistAccumulator::ForceAdd(size_t idx) -> void
+{
+  auto [seg, off] = Locate(idx);
+  auto& shard = GetShard();
+  auto* s = EnsureSegment(shard, seg);
+  s->units[off].fetch_add(1UL, std::memory_order_relaxed);
+  shard.count.fetch_add(1UL, std::memory_order_relaxed);
+  Grow(idx + 1UL);
+}
+
+template<class T>
+inline auto
+ConcurrentHistAccumulator::ForceAdd(size_t idx, T val) -> void
+{
+  auto [seg, off] = Locate(idx);
+  EnsureSegment(GetShard(), seg);
+  Grow(idx + 1UL);
+  Add(idx, val);
+}
+
+inline auto
+ConcurrentHistAccumulator::Reset() -> void
+{
+  for (auto& shard : shards_) {
+    for (auto& seg : shard.segments) {
+      auto* s = seg.load(std::memory_order_acquire);
+      if (s != nullptr) {
+        s->Reset();
+      }
+    }
+    shard.count.store(0UL, std::memory_order_relaxed);
+  }
+}
+
+template<class Fn>
+inline auto
+ConcurrentHistAccumulator::ForEachShard(size_t idx, Fn fn) const -> void
+{
+  auto [seg, off] = Locate(idx);
+  for (auto const& shard : shards_) {
+    auto const* s = shard.segments[seg].load(std::memory_order_acquire);
+    if (s != nullptr) {
+      fn(*s, off);
+    }
+  }
+}
+
+inline auto
+ConcurrentHistAccumulator::GetCount(size_t idx) const -> size_t
+{
+  auto count = 0UL;
+  ForEachShard(idx, [&count](Segment const& s, size_t off) {
+    count += s.units[off].load(std::memory_order_relaxed);
+    count += s.counts[off].load(std::memory_order_relaxed);
+  });
+  return count;
+}
+
+inline auto
+ConcurrentHistAccumulator::GetCount() const -> size_t
+{
+  auto count = 0UL;
+  for (auto const& shard : shards_) {
+    count += shard.count.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+inline auto
+ConcurrentHistAccumulator::GetResult(size_t idx) const -> double
+{
+  auto count = GetCount();
+  if (count == 0UL) {
+    return 0.0;
+  }
+
+  auto acc = accumulators::NeumaierAccumulator{};
+  ForEachShard(idx, [&acc](Segment const& s, size_t off) {
+    acc.Add(static_cast<double>(s.units[off].load(std::memory_order_relaxed)));
+    acc.Add(s.sums[off].load(std::memory_order_relaxed));
+  });
+
+  return acc.Sum() / static_cast<double>(count);
+}
+
+inline auto
+ConcurrentHistAccumulator::GetResults() const -> std::vector<double>
+{
+  auto const nbins = GetNbins();
+  auto r = std::vector<double>(nbins, 0.0);
+  auto count = 0UL;
+
+  for (auto i = 0UL; i < nbins; i++) {
+    auto acc = accumulators::NeumaierAccumulator{};
+    ForEachShard(i, [&acc, &count](Segment const& s, size_t off) {
+      auto u = s.units[off].load(std::memory_order_relaxed);
+      acc.Add(static_cast<double>(u));
+      acc.Add(s.sums[off].load(std::memory_order_relaxed));
+      count += u + s.counts[off].load(std::memory_order_relaxed);
+    });
+    r[i] = acc.Sum();
+  }
+
+  if (count != 0UL) {
+    for (auto& v : r) {
+      v /= static_cast<double>(count);
+    }
+  }
+
+  return r;
+}
+
+inline auto
+ConcurrentHistAccumulator::GetResults(size_t idx) const -> std::vector<double>
+{
+  auto r = GetResults();
+  auto norm = r[idx];
+  for (auto& v : r) {
+    v /= norm;
+  }
+  return r;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,300 @@
+//===-- CountingHistAccumulator.hpp ----------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the CountingHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+
+// boost
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Histogram optimized for counting.
+///
+/// Unitary measurements only increment an integer bin. The first weighted
+/// measurement promotes the histogram to compensated storage, after which it
+/// behaves exactly like a HistAccumulator.
+///
+template<typename Count_t = std::uint64_t>
+class CountingHistAccumulator
+{
+  static_assert(std::is_integral<Count_t>::value &&
+                  std::is_unsigned<Count_t>::value,
+                "Unsigned integral type required");
+
+public:
+  /// Default constructor
+  CountingHistAccumulator() = default;
+
+  /// Construct an histogram
+  CountingHistAccumulator(size_t nbins);
+
+  /// Copy constructor
+  CountingHistAccumulator(CountingHistAccumulator const& that) = default;
+
+  /// Move constructor
+  CountingHistAccumulator(CountingHistAccumulator&& that) = default;
+
+  /// Default destructor
+  ~CountingHistAccumulator() = default;
+
+  /// Copy assignment operator
+  auto operator=(CountingHistAccumulator const& that)
+    -> CountingHistAccumulator& = default;
+
+  /// Move assignment operator
+  auto operator=(CountingHistAccumulator&& that)
+    -> CountingHistAccumulator& = default;
+
+  /// Resize the histogram
+  auto Resize(size_t nbins) -> void;
+
+  /// Reset the histogram, the storage goes back to integers
+  auto Reset() -> void;
+
+  /// Add a measurement
+  template<class T>
+  auto Add(size_t idx, T val) -> void;
+
+  /// Add a unitary measurement
+  auto Add(size_t idx) -> void;
+
+  /// Add a measurement and increase the number of bins
+  template<class T>
+  auto ForceAdd(size_t idx, T val) -> void;
+
+  /// Add an unitary measurement and increase the number of bins
+  auto ForceAdd(size_t idx) -> void;
+
+  /// Get a single component result
+  [[nodiscard]] auto GetResult(size_t idx) const -> double;
+
+  /// Get the result of all the components
+  [[nodiscard]] auto GetResults() const -> std::vector<double>;
+
+  /// Get the results of all the components but divide by the one
+  /// given.
+  [[nodiscard]] auto GetResults(size_t idx) const -> std::vector<double>;
+
+  /// Get the number of measurements in total
+  [[nodiscard]] auto GetCount() const -> size_t { return count_; };
+
+  /// Get the count of a single observable
+  [[nodiscard]] auto GetCount(size_t idx) const -> size_t
+  {
+    return bins_[idx];
+  };
+
+  /// Get the number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return bins_.size(); };
+
+  /// Check if weighted measurements were added
+  [[nodiscard]] auto IsPromoted() const -> bool { return !sums_.empty(); };
+
+protected:
+  /// Switch to compensated storage
+  auto Promote() -> void;
+
+  /// Increment the count of a bin
+  auto Count(size_t idx) -> void;
+
+private:
+  /// Number of measurements in each bin
+  std::vector<Count_t> bins_{};
+
+  /// Weighted sums, empty until the first weighted measurement
+  std::vector<accumulators::NeumaierAccumulator> sums_{};
+
+  /// Number of measurements
+  unsigned long count_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class CountingHistAccumulator
+
+/// Counting histogram with 32 bit bins
+using CountingHistAccumulator32 = CountingHistAccumulator<std::uint32_t>;
+
+/// Counting histogram with 64 bit bins
+using CountingHistAccumulator64 = CountingHistAccumulator<std::uint64_t>;
+
+template<typename Count_t>
+inline CountingHistAccumulator<Count_t>::CountingHistAccumulator(size_t nbins)
+  : bins_(nbins, Count_t{ 0 })
+{
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::Resize(size_t nbins) -> void
+{
+  bins_.resize(nbins, Count_t{ 0 });
+  if (IsPromoted()) {
+    sums_.resize(nbins);
+  }
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::Reset() -> void
+{
+  std::fill(bins_.begin(), bins_.end(), Count_t{ 0 });
+  sums_.clear();
+  count_ = 0UL;
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::Count(size_t idx) -> void
+{
+  assert(idx < bins_.size());
+
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (bins_[idx] == std::numeric_limits<Count_t>::max()) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  bins_[idx]++;
+  count_++;
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::Promote() -> void
+{
+  sums_.resize(bins_.size());
+  for (auto i = 0UL; i < bins_.size(); i++) {
+    if (bins_[i] != Count_t{ 0 }) {
+      sums_[i].Add(static_cast<double>(bins_[i]));
+    }
+  }
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::Add(size_t idx) -> void
+{
+  Count(idx);
+  if (IsPromoted()) {
+    sums_[idx].Add(1.0);
+  }
+}
+
+template<typename Count_t>
+template<class T>
+inline auto
+CountingHistAccumulator<Count_t>::Add(size_t idx, T val) -> void
+{
+  if (!IsPromoted()) {
+    Promote();
+  }
+  Count(idx);
+  sums_[idx].Add(val);
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::ForceAdd(size_t idx) -> void
+{
+  if (idx >= bins_.size()) {
+    Resize(idx + 1UL);
+  }
+  Add(idx);
+}
+
+template<typename Count_t>
+template<class T>
+inline auto
+CountingHistAccumulator<Count_t>::ForceAdd(size_t idx, T val) -> void
+{
+  if (idx >= bins_.size()) {
+    Resize(idx + 1UL);
+  }
+  Add(idx, val);
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::GetResult(size_t idx) const -> double
+{
+  if (bins_[idx] == Count_t{ 0 }) {
+    return 0.0;
+  }
+
+  auto sum =
+    IsPromoted() ? sums_[idx].Sum() : static_cast<double>(bins_[idx]);
+
+  return sum / static_cast<double>(count_);
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::GetResults() const -> std::vector<double>
+{
+  auto r = std::vector<double>(bins_.size(), 0.0);
+
+  for (auto i = 0UL; i < bins_.size(); i++) {
+    r[i] = GetResult(i);
+  }
+
+  return r;
+}
+
+template<typename Count_t>
+inline auto
+CountingHistAccumulator<Count_t>::GetResults(size_t idx) const
+  -> std::vector<double>
+{
+  auto r = GetResults();
+  auto norm = r[idx];
+  for (auto& v : r) {
+    v /= norm;
+  }
+  return r;
+}
+
+template<typename Count_t>
+template<class Archive>
+inline auto
+CountingHistAccumulator<Count_t>::serialize(Archive& ar,
+                                            const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & bins_;
+  ar & sums_;
+  ar & count_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,182 @@
+//===-- EytzingerTable.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the EytzingerTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Sorted table stored in Eytzinger (breadth first) order, for many
+/// searches into the same values, like a fixed cumulative distribution.
+///
+/// The children of the node k are 2k and 2k + 1, so the first levels of
+/// the search share a few cache lines and the next nodes to visit can be
+/// prefetched: once the table is larger than the cache this is much faster
+/// than a binary search on the sorted array (Khuong and Morin, "Array
+/// layouts for comparison-based searching", 2017). Results are indices in
+/// the sorted order.
+///
+template<typename T = double>
+class EytzingerTable
+{
+public:
+  /// Default constructor
+  EytzingerTable() = default;
+
+  /// Build the table from sorted values
+  explicit EytzingerTable(std::vector<T> const& sorted);
+
+  /// Copy constructor
+  EytzingerTable(EytzingerTable const& that) = default;
+
+  /// Move constructor
+  EytzingerTable(EytzingerTable&& that) = default;
+
+  /// Default destructor
+  ~EytzingerTable() = default;
+
+  /// Copy assignment operator
+  auto operator=(EytzingerTable const& that) -> EytzingerTable& = default;
+
+  /// Move assignment operator
+  auto operator=(EytzingerTable&& that) -> EytzingerTable& = default;
+
+  /// Index of the first value greater than @p value, or the size if there
+  /// is none, as std::upper_bound on the sorted values
+  [[nodiscard]] auto UpperBound(T const& value) const -> size_t;
+
+  /// Index of the first value not less than @p value, or the size if there
+  /// is none, as std::lower_bound on the sorted values
+  [[nodiscard]] auto LowerBound(T const& value) const -> size_t;
+
+  /// Number of values
+  [[nodiscard]] auto GetSize() const -> size_t { return index_.size() - 1UL; };
+
+protected:
+  /// Fill the node @p k and its subtree with the sorted values from @p i
+  auto Build(std::vector<T> const& sorted, size_t& i, size_t k) -> void;
+
+  /// Node reached by a search, undo the last turns to the right
+  [[nodiscard]] static auto Unwind(size_t k) -> size_t;
+
+private:
+  /// Values in breadth first order, starting from 1
+  std::vector<T> nodes_{ T{} };
+
+  /// Position in the sorted order of each node, the size for node 0
+  std::vector<size_t> index_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class EytzingerTable
+
+template<typename T>
+inline EytzingerTable<T>::EytzingerTable(std::vector<T> const& sorted)
+  : nodes_(sorted.size() + 1UL)
+  , index_(sorted.size() + 1UL)
+{
+  auto i = 0UL;
+  Build(sorted, i, 1UL);
+  index_[0] = sorted.size();
+}
+
+template<typename T>
+inline auto
+EytzingerTable<T>::Build(std::vector<T> const& sorted, size_t& i, size_t k)
+  -> void
+{
+  // in order visit of the implicit tree
+  if (k < nodes_.size()) {
+    Build(sorted, i, 2UL * k);
+    nodes_[k] = sorted[i];
+    index_[k] = i++;
+    Build(sorted, i, 2UL * k + 1UL);
+  }
+}
+
+template<typename T>
+inline auto
+EytzingerTable<T>::Unwind(size_t k) -> size_t
+{
+  // drop the trailing ones (right turns) and the last left turn
+#if defined(__GNUC__)
+  return k >> static_cast<unsigned>(__builtin_ffsl(static_cast<long>(~k)));
+#else
+  while ((k & 1UL) != 0UL) {
+    k >>= 1U;
+  }
+  return k >> 1U;
+#endif
+}
+
+template<typename T>
+inline auto
+EytzingerTable<T>::UpperBound(T const& value) const -> size_t
+{
+  auto const n = nodes_.size();
+  auto const* nodes = nodes_.data();
+  auto k = 1UL;
+  while (k < n) {
+#if defined(__GNUC__)
+    // the descendants four levels below are contiguous, from 16k
+    __builtin_prefetch(nodes + 16UL * k);
+#endif
+    k = 2UL * k + (value < nodes[k] ? 0UL : 1UL);
+  }
+  return index_[Unwind(k)];
+}
+
+template<typename T>
+inline auto
+EytzingerTable<T>::LowerBound(T const& value) const -> size_t
+{
+  auto const n = nodes_.size();
+  auto const* nodes = nodes_.data();
+  auto k = 1UL;
+  while (k < n) {
+#if defined(__GNUC__)
+    __builtin_prefetch(nodes + 16UL * k);
+#endif
+    k = 2UL * k + (nodes[k] < value ? 1UL : 0UL);
+  }
+  return index_[Unwind(k)];
+}
+
+template<typename T>
+template<class Archive>
+inline auto
+EytzingerTable<T>::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & nodes_;
+  ar & index_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
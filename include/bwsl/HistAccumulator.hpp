@@ -20,6 +20,7 @@
 // boost
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/serialization.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/version.hpp>
 
@@ -31,7 +32,7 @@ namespace bwsl {
 ///
 /// Accumulate histogram statistic
 ///
-class HistAccumulator
+class HistAccumulator final
 {
 public:
   /// Default constructor
@@ -47,7 +48,7 @@ public:
   HistAccumulator(HistAccumulator&& that) = default;
 
   /// Default destructor
-  virtual ~HistAccumulator() = default;
+  ~HistAccumulator() = default;
 
   /// Copy assignment operator
   auto operator=(HistAccumulator const& that) -> HistAccumulator& = default;
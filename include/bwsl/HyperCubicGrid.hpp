@@ -18,6 +18,11 @@
 #include <bwsl/MathUtils.hpp>
 #include <bwsl/Pairs.hpp>
 
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
 /// std
 #include <vector>
 
@@ -157,6 +162,13 @@ private:
 
   /// Boundary conditions
   boundaries_t boundaries_{ boundaries_t::Open };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
 }; // class HyperCubicGrid
 
 inline HyperCubicGrid::HyperCubicGrid(gridsize_t const& size,
@@ -267,6 +279,20 @@ HyperCubicGrid::GetJump(size_t a, size_t b) const -> coords_t
   return cb;
 }
 
+template<class Archive>
+inline auto
+HyperCubicGrid::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & dim_;
+  ar & size_;
+  ar & numsites_;
+  ar & numpairs_;
+  ar & boundaries_;
+  // clang-format on
+}
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,24 @@
+//===-- IOUtils.hpp --------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Utilities for the output of the simulations
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+#include <bwsl/io/BinaryArchive.hpp>
+#include <bwsl/io/Checksum.hpp>
+#include <bwsl/io/ColumnarFormat.hpp>
+#include <bwsl/io/ColumnarReader.hpp>
+#include <bwsl/io/ColumnarWriter.hpp>
+#include <bwsl/io/OutputSink.hpp>
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -20,11 +20,20 @@
 #include <bwsl/HyperCubicGrid.hpp>
 #include <bwsl/MathUtils.hpp>
 #include <bwsl/Pairs.hpp>
+#include <bwsl/io/ColumnarWriter.hpp>
 
 // fmt
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+// boost
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/extended_type_info_typeid.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+#include <boost/serialization/void_cast.hpp>
+
 // std
 #include <algorithm>
 #include <cassert>
@@ -122,18 +131,39 @@ public:
                                double mult = 1.0) const -> realvec_t;
 
   /// Save the distances on a file
-  auto SaveDistances(const std::string& fname) const -> void;
+  auto SaveDistances(const std::string& fname,
+                     io::TableFormat format = io::TableFormat::Csv) const
+    -> void;
 
   /// Save the positions on a file
-  auto SavePositions(const std::string& fname) const -> void;
+  auto SavePositions(const std::string& fname,
+                     io::TableFormat format = io::TableFormat::Csv) const
+    -> void;
 
   /// Save the momenta on a file
-  auto SaveMomenta(const std::string& fname) const -> void;
+  auto SaveMomenta(const std::string& fname,
+                   io::TableFormat format = io::TableFormat::Csv) const
+    -> void;
 
   /// Save the distances on a file
-  auto SavePairs(const std::string& fname) const -> void;
+  auto SavePairs(const std::string& fname,
+                 io::TableFormat format = io::TableFormat::Csv) const -> void;
 
 protected:
+  /// Save a table with @p nrows rows in the given format.
+  /// The callable @p row is invoked as `row(i, cell)` and must pass each
+  /// value of the i-th row, in order, to `cell`.
+  template<class RowFn>
+  auto SaveTable(std::string const& fname,
+                 io::TableFormat format,
+                 std::vector<io::Column> const& columns,
+                 size_t nrows,
+                 RowFn row) const -> void;
+
+  /// Columns named @p prefix followed by the dimension
+  [[nodiscard]] auto GetVectorColumns(std::string const& prefix) const
+    -> std::vector<io::Column>;
+
   /// Compute the positions of all the lattice points
   /// NOTE: the positions stored are in real space.
   [[nodiscard]] auto ComputePositions(Bravais const& bravais) const
@@ -182,6 +212,14 @@ private:
 
   /// Allowed values momenta
   std::vector<realvec_t> momenta_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class, the tables are stored so that a
+  /// restart does not compute them again
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
 }; // class Lattice
 
 inline Lattice::Lattice(Bravais const& bravais,
@@ -421,111 +459,138 @@ Lattice::ComputeSk(std::vector<T> const& occupations, double mult) const
   return sk;
 }
 
+template<class RowFn>
 inline auto
-Lattice::SavePositions(std::string const& fname) const -> void
+Lattice::SaveTable(std::string const& fname,
+                   io::TableFormat format,
+                   std::vector<io::Column> const& columns,
+                   size_t nrows,
+                   RowFn row) const -> void
 {
+  if (format == io::TableFormat::Columnar) {
+    auto out = io::ColumnarWriter(fname, columns);
+    for (auto i = 0UL; i < nrows; i++) {
+      row(i, [&out](auto v) { out.Push(v); });
+      out.EndRow();
+    }
+    return;
+  }
+
   auto out = std::ofstream{ fname.c_str() };
 
-  fmt::print(out, "i");
-  for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",x{}", i);
+  fmt::print(out, "{}", columns[0].name);
+  for (auto c = 1UL; c < columns.size(); c++) {
+    fmt::print(out, ",{}", columns[c].name);
   }
   fmt::print(out, "\n");
 
-  for (auto i = 0UL; i < GetNumSites(); i++) {
-    auto vec = GetPosition(i);
-    fmt::print(out, "{}", i);
-    for (auto const& v : vec) {
-      fmt::print(out, ",{}", v);
-    }
+  for (auto i = 0UL; i < nrows; i++) {
+    auto first = true;
+    row(i, [&out, &first](auto v) {
+      if (!first) {
+        fmt::print(out, ",");
+      }
+      fmt::print(out, "{}", v);
+      first = false;
+    });
     fmt::print(out, "\n");
   }
 }
 
 inline auto
-Lattice::SaveDistances(std::string const& fname) const -> void
+Lattice::GetVectorColumns(std::string const& prefix) const
+  -> std::vector<io::Column>
 {
-  auto out = std::ofstream{ fname.c_str() };
-
-  fmt::print(out, "i");
+  auto columns = std::vector<io::Column>{};
   for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",d{}", i);
+    columns.push_back({ fmt::format("{}{}", prefix, i),
+                        io::ColumnType::Float64 });
   }
-  fmt::print(out, "\n");
+  return columns;
+}
 
-  for (auto i = 0UL; i < GetNumSites(); i++) {
-    auto vec = GetVector(0, i);
-    fmt::print(out, "{}", i);
-    for (auto const& v : vec) {
-      fmt::print(out, ",{}", v);
+inline auto
+Lattice::SavePositions(std::string const& fname, io::TableFormat format) const
+  -> void
+{
+  auto columns = std::vector<io::Column>{ { "i", io::ColumnType::UInt64 } };
+  auto x = GetVectorColumns("x");
+  columns.insert(columns.end(), x.begin(), x.end());
+
+  SaveTable(fname, format, columns, GetNumSites(), [this](auto i, auto cell) {
+    cell(i);
+    for (auto const& v : GetPosition(i)) {
+      cell(v);
     }
-    fmt::print(out, "\n");
-  }
+  });
+}
+
+inline auto
+Lattice::SaveDistances(std::string const& fname, io::TableFormat format) const
+  -> void
+{
+  auto columns = std::vector<io::Column>{ { "i", io::ColumnType::UInt64 } };
+  auto d = GetVectorColumns("d");
+  columns.insert(columns.end(), d.begin(), d.end());
+
+  SaveTable(fname, format, columns, GetNumSites(), [this](auto i, auto cell) {
+    cell(i);
+    for (auto const& v : GetVector(0, i)) {
+      cell(v);
+    }
+  });
 }
 
 inline void
-Lattice::SaveMomenta(std::string const& fname) const
+Lattice::SaveMomenta(std::string const& fname, io::TableFormat format) const
 {
-  auto out = std::ofstream{ fname.c_str() };
+  auto columns = std::vector<io::Column>{ { "i", io::ColumnType::UInt64 } };
+  auto k = GetVectorColumns("k");
+  columns.insert(columns.end(), k.begin(), k.end());
 
-  fmt::print(out, "i");
-  for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",k{}", i);
-  }
-  fmt::print(out, "\n");
+  // with open boundaries the momenta are not defined
+  auto nrows = momenta_.empty() ? 0UL : GetNumSites();
 
-  for (auto i = 0UL; i < GetNumSites(); i++) {
-    fmt::print(out, "{}", i);
-    for (auto const& k : momenta_[i]) {
-      fmt::print(out, ",{}", k);
+  SaveTable(fname, format, columns, nrows, [this](auto i, auto cell) {
+    cell(i);
+    for (auto const& v : momenta_[i]) {
+      cell(v);
     }
-    fmt::print(out, "\n");
-  }
+  });
 }
 
 inline auto
-Lattice::SavePairs(std::string const& fname) const -> void
+Lattice::SavePairs(std::string const& fname, io::TableFormat format) const
+  -> void
 {
-  auto out = std::ofstream{ fname.c_str() };
-
-  fmt::print(out, "i,a,b");
-
-  auto npairs = pairs::GetNumPairs(GetNumSites());
-  auto nsites = GetNumSites();
-
-  for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",x{}", i);
-  }
-  for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",y{}", i);
+  auto columns = std::vector<io::Column>{ { "i", io::ColumnType::UInt64 },
+                                          { "a", io::ColumnType::UInt64 },
+                                          { "b", io::ColumnType::UInt64 } };
+  for (auto const* prefix : { "x", "y", "d" }) {
+    auto v = GetVectorColumns(prefix);
+    columns.insert(columns.end(), v.begin(), v.end());
   }
-  for (auto i = 0UL; i < GetDim(); i++) {
-    fmt::print(out, ",d{}", i);
-  }
-  fmt::print(out, "\n");
-
-  for (auto i = 0UL; i < npairs; i++) {
-    auto [a, b] = bwsl::pairs::GetPair(i, nsites);
 
-    auto va = GetVector(0, a);
-    fmt::print(out, "{},{},{}", bwsl::pairs::GetPairIndex(a, b, nsites), a, b);
-
-    for (auto const& v : va) {
-      fmt::print(out, ",{}", v);
-    }
-
-    auto vb = GetVector(0, b);
-    for (auto const& v : vb) {
-      fmt::print(out, ",{}", v);
-    }
+  auto nsites = GetNumSites();
+  auto npairs = pairs::GetNumPairs(nsites);
 
-    auto vec = GetVector(a, b);
-    for (auto const& v : vec) {
-      fmt::print(out, ",{}", v);
-    }
+  SaveTable(
+    fname, format, columns, npairs, [this, nsites](auto i, auto cell) {
+      auto [a, b] = bwsl::pairs::GetPair(i, nsites);
 
-    fmt::print(out, "\n");
-  }
+      cell(bwsl::pairs::GetPairIndex(a, b, nsites));
+      cell(a);
+      cell(b);
+      for (auto const& v : GetVector(0, a)) {
+        cell(v);
+      }
+      for (auto const& v : GetVector(0, b)) {
+        cell(v);
+      }
+      for (auto const& v : GetVector(a, b)) {
+        cell(v);
+      }
+    });
 }
 
 inline auto
@@ -540,6 +605,20 @@ Lattice::GetCoordination() const -> size_t
   return neighbors_[0].size();
 }
 
+template<class Archive>
+inline auto
+Lattice::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & boost::serialization::base_object<HyperCubicGrid>(*this);
+  ar & position_;
+  ar & vectors_;
+  ar & distance_;
+  ar & neighbors_;
+  ar & momenta_;
+  // clang-format on
+}
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
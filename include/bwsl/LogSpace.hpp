@@ -59,6 +59,15 @@ public:
   /// Return a vector filled with values
   auto Collect(unsigned long n) -> std::vector<T>;
 
+  /// First value of the interval
+  [[nodiscard]] auto GetFirst() const -> T { return first_; };
+
+  /// Last value of the interval
+  [[nodiscard]] auto GetLast() const -> T { return last_; };
+
+  /// Number of steps between the first and the last value
+  [[nodiscard]] auto GetSteps() const -> unsigned long { return nsteps_; };
+
 protected:
 private:
   /// The step to take at each iteration
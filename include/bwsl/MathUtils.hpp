@@ -18,7 +18,9 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <functional>
+#include <iterator>
 #include <numeric>
 #include <random>
 #include <type_traits>
@@ -191,7 +193,29 @@ cbinomial(T n, T k) -> double
 }
 
 ///
-/// Choose between the probabilities given
+/// Uniform random number in [0, @p scale).
+///
+/// @p rng is either a UniformRandomBitGenerator or a source of uniform
+/// numbers in [0, 1) with a floating point result_type, like UniformBuffer,
+/// which is used directly without building a distribution.
+///
+template<typename T, typename G>
+inline auto
+draw_uniform(T scale, G& rng) -> T
+{
+  if constexpr (std::is_floating_point<typename G::result_type>::value) {
+    return scale * static_cast<T>(rng());
+  } else {
+    auto udist = std::uniform_real_distribution<T>{ T{ 0 }, scale };
+    return udist(rng);
+  }
+}
+
+///
+/// Choose between the probabilities given.
+///
+/// Each call is O(n), see sampling::AliasTable and sampling::SumTree to draw
+/// many times from the same weights.
 ///
 template<class T = std::vector<double>, typename G>
 inline auto
@@ -201,9 +225,7 @@ choose_between(const T& probs, G& rng) -> SizeType
 
   std::partial_sum(probs.begin(), probs.end(), comul.begin());
 
-  std::uniform_real_distribution<typename T::value_type> udist(0.0,
-                                                               comul.back());
-  auto rnd = udist(rng);
+  auto rnd = draw_uniform(comul.back(), rng);
 
   typename T::iterator choice =
     std::upper_bound(comul.begin(), comul.end(), rnd);
@@ -218,9 +240,7 @@ template<class T = std::vector<double>, typename G>
 inline auto
 choose_between_psums(const T& comul, G& rng) -> SizeType
 {
-  std::uniform_real_distribution<typename T::value_type> udist(0.0,
-                                                               comul.back());
-  auto rnd = udist(rng);
+  auto rnd = draw_uniform(comul.back(), rng);
 
   typename T::const_iterator choice =
     std::upper_bound(comul.cbegin(), comul.cend(), rnd);
@@ -235,8 +255,7 @@ template<typename T = double, typename G>
 inline auto
 choose_with_probability(T prob, G& rng) -> bool
 {
-  auto udist = std::uniform_real_distribution<T>{ 0.0, 1.0 };
-  return static_cast<bool>(udist(rng) < prob);
+  return static_cast<bool>(draw_uniform(T{ 1 }, rng) < prob);
 }
 
 ///
@@ -345,47 +364,111 @@ index_to_array(size_t index, D const& size) -> C
   return result;
 }
 
+/// Window below which bwsl::upper_bound stops interpolating
+constexpr std::ptrdiff_t upper_bound_threshold = 256;
+
+///
+/// Binary search without branches on the comparisons, on a random access
+/// range. The loop always runs log2(n) times and the compiler turns the
+/// choice of the half into a conditional move, so there are no
+/// mispredictions.
+///
+template<class RandomIt, class T>
+inline auto
+branchless_upper_bound(RandomIt first, RandomIt last, const T& value)
+  -> RandomIt
+{
+  auto n = std::distance(first, last);
+  if (n == 0) {
+    return first;
+  }
+  while (n > 1) {
+    auto half = n / 2;
+    first = (value < first[half]) ? first : first + half;
+    n -= half;
+  }
+  return first + (value < *first ? 0 : 1);
+}
+
+///
 /// Interpolation-Binary search.
+///
 /// Mixed interpolation and binary search to squeeze the best possible
-/// performances. Interpolation search is done until a window of 10000
-/// elements is reached. For smaller windows a binary search is performed.
+/// performances. The position of the value is interpolated from the ends of
+/// the search window until the window is smaller than @p threshold, then a
+/// branchless binary search finishes the job. Every interpolated probe is
+/// followed by a guard probe at about sqrt(n) from it, which catches the
+/// value when the interpolation is good, and by a bisection when the window
+/// did not halve, so the search takes O(log log n) steps on smooth data and
+/// never more than O(log n) on skewed data.
+///
+/// The values must support subtraction, as for cumulative distributions.
+/// Strongly skewed data is better served by a threshold larger than the
+/// range, which skips the interpolation, or by EytzingerTable. Other
+/// iterators than random access ones use std::upper_bound.
+///
 template<class ForwardIt, class T>
 inline auto
-upper_bound(ForwardIt first, ForwardIt last, const T& value) -> ForwardIt
+upper_bound(ForwardIt first,
+            ForwardIt last,
+            const T& value,
+            std::ptrdiff_t threshold = upper_bound_threshold) -> ForwardIt
 {
-  auto count = std::distance(first, last);
-  auto it = first;
-  auto to = it;
-  std::advance(to, count - 1);
-
-  while (count > 10000) {
-    auto itval = *it;
-    // check if the value is outside the lower bound of the search interval
-    if (value < itval) {
-      return it;
-    }
-    if (!(itval < value)) { // value <= it (so only if they are equal)
-      return ++it;
-    }
-
-    // check if the value is outside the upper bound of the search interval
-    if (!(value < *to)) { // value >= to
-      return ++to;
-    }
-
-    // compute the new position interpolating the position of the point
-    const auto np = std::round((value - itval) / (*to - itval) * count);
-    auto nt = it;
-    std::advance(nt, np);
-
-    if (!(value < *nt)) { // value >= *nt
-      it = ++nt;
-    } else {
-      to = --nt;
+  using category = typename std::iterator_traits<ForwardIt>::iterator_category;
+  if constexpr (!std::is_base_of<std::random_access_iterator_tag,
+                                 category>::value) {
+    return std::upper_bound(first, last, value);
+  } else {
+    // the result is always in [lo, hi]
+    auto lo = first;
+    auto hi = last;
+    threshold = std::max(threshold, std::ptrdiff_t{ 2 });
+
+    while (hi - lo > threshold) {
+      auto const n = hi - lo;
+      auto const& a = *lo;
+      auto const& b = *(hi - 1);
+      if (value < a) {
+        return lo;
+      }
+      if (!(value < b)) {
+        return hi;
+      }
+
+      // now a <= value < b, so b - a > 0 and both ends can be excluded
+      auto frac = static_cast<double>(value - a) / static_cast<double>(b - a);
+      auto pos = static_cast<std::ptrdiff_t>(frac * static_cast<double>(n - 1));
+      auto probe = lo + std::clamp(pos, std::ptrdiff_t{ 1 }, n - 2);
+      ++lo;
+      --hi;
+
+      // the probe and a guard at the typical error of the interpolation,
+      // which is about sqrt(n) on smooth data
+      auto gap = static_cast<std::ptrdiff_t>(std::sqrt(static_cast<double>(n)));
+      if (value < *probe) {
+        hi = probe;
+        if (probe - lo > gap && !(value < *(probe - gap))) {
+          lo = probe - gap + 1;
+        }
+      } else {
+        lo = probe + 1;
+        if (hi - lo > gap && value < *(lo + gap)) {
+          hi = lo + gap;
+        }
+      }
+
+      // guarantee progress on skewed data
+      if (2 * (hi - lo) > n) {
+        auto mid = lo + (hi - lo) / 2;
+        if (value < *mid) {
+          hi = mid;
+        } else {
+          lo = mid + 1;
+        }
+      }
     }
-    count = std::distance(it, to);
+    return branchless_upper_bound(lo, hi, value);
   }
-  return upper_bound(it, ++to, value);
 }
 
 /// Greater common denominator
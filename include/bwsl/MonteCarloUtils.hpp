@@ -14,7 +14,14 @@
 //===---------------------------------------------------------------------===//
 #pragma once
 
+#include <bwsl/mcutils/MoveRegistry.hpp>
 #include <bwsl/mcutils/MoveResult.hpp>
 #include <bwsl/mcutils/MoveStats.hpp>
+#include <bwsl/mcutils/MultiWalker.hpp>
+#include <bwsl/mcutils/ParallelTempering.hpp>
+#include <bwsl/mcutils/PerThreadMoveStats.hpp>
+#include <bwsl/mcutils/RateCatalog.hpp>
+#include <bwsl/mcutils/WangLandau.hpp>
+#include <bwsl/mcutils/WangLandauWindows.hpp>
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,397 @@
+//===-- MultiHistAccumulator.hpp -------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MultiHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+
+// boost
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/unordered_map.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+namespace bwsl {
+
+namespace exception {
+
+/// Two multidimensional histograms with different shapes were merged
+class MultiHistShapeMismatch : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "Cannot merge histograms with different shapes";
+  }
+};
+
+} // namespace exception
+
+///
+/// Histogram over an N-dimensional grid of bins.
+///
+/// Bins are numbered as the sites of a HyperCubicGrid with the same size,
+/// the last coordinate running fastest. The histogram starts with a sparse
+/// storage holding only the bins which were hit, and switches to a dense
+/// array once the fraction of bins in use exceeds a threshold.
+///
+template<size_t N>
+class MultiHistAccumulator
+{
+public:
+  /// Coordinates of a bin
+  using coords_t = std::array<size_t, N>;
+
+  /// Default constructor
+  MultiHistAccumulator() = default;
+
+  /// Construct an histogram of the given size, going dense when more than
+  /// @p fill of the bins are in use
+  MultiHistAccumulator(coords_t const& size, double fill = 0.25);
+
+  /// Copy constructor
+  MultiHistAccumulator(MultiHistAccumulator const& that) = default;
+
+  /// Move constructor
+  MultiHistAccumulator(MultiHistAccumulator&& that) = default;
+
+  /// Default destructor
+  ~MultiHistAccumulator() = default;
+
+  /// Copy assignment operator
+  auto operator=(MultiHistAccumulator const& that)
+    -> MultiHistAccumulator& = default;
+
+  /// Move assignment operator
+  auto operator=(MultiHistAccumulator&& that)
+    -> MultiHistAccumulator& = default;
+
+  /// Reset the histogram, the storage goes back to sparse
+  auto Reset() -> void;
+
+  /// Add a measurement
+  template<class T>
+  auto Add(coords_t const& coords, T val) -> void
+  {
+    AddIndex(GetIndex(coords), val);
+  }
+
+  /// Add a unitary measurement
+  auto Add(coords_t const& coords) -> void { AddIndex(GetIndex(coords), 1.0); };
+
+  /// Add a measurement to the bin with a given index
+  template<class T>
+  auto AddIndex(size_t idx, T val) -> void;
+
+  /// Add a unitary measurement for each coordinates in [@p first, @p last)
+  template<typename InputIt>
+  auto AddBatch(InputIt first, InputIt last) -> void;
+
+  /// Add the measurements of another histogram with the same shape
+  auto Merge(MultiHistAccumulator const& that) -> void;
+
+  /// Get a single component result
+  [[nodiscard]] auto GetResult(coords_t const& coords) const -> double;
+
+  /// Get the result of all the components, in index order
+  [[nodiscard]] auto GetResults() const -> std::vector<double>;
+
+  /// Get the number of measurements in total
+  [[nodiscard]] auto GetCount() const -> size_t { return count_; };
+
+  /// Get the count of a single bin
+  [[nodiscard]] auto GetCount(coords_t const& coords) const -> size_t;
+
+  /// Get the size of the grid of bins
+  [[nodiscard]] auto GetSize() const -> coords_t const& { return size_; };
+
+  /// Get the number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return nbins_; };
+
+  /// Get the number of bins which were hit at least once
+  [[nodiscard]] auto GetNumFilled() const -> size_t;
+
+  /// Check if the storage is dense
+  [[nodiscard]] auto IsDense() const -> bool { return !dense_.empty(); };
+
+  /// Convert coordinates to an index
+  [[nodiscard]] auto GetIndex(coords_t const& coords) const -> size_t;
+
+  /// Convert an index to coordinates
+  [[nodiscard]] auto GetCoordinates(size_t idx) const -> coords_t;
+
+protected:
+  /// Switch to dense storage if the sparse one is too full
+  auto MaybeDensify() -> void;
+
+  /// Accumulator of a bin, nullptr if it was never hit
+  [[nodiscard]] auto Find(size_t idx) const
+    -> accumulators::NeumaierAccumulator const*;
+
+private:
+  /// Size of the grid of bins
+  coords_t size_{};
+
+  /// Distance in index between neighbouring bins along each direction
+  coords_t strides_{};
+
+  /// Number of bins
+  size_t nbins_{ 0UL };
+
+  /// Fraction of bins in use above which the storage is dense
+  double fill_{ 0.25 };
+
+  /// Sparse storage
+  std::unordered_map<size_t, accumulators::NeumaierAccumulator> sparse_{};
+
+  /// Dense storage, empty while the storage is sparse
+  std::vector<accumulators::NeumaierAccumulator> dense_{};
+
+  /// Number of measurements
+  unsigned long count_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class MultiHistAccumulator
+
+template<size_t N>
+inline MultiHistAccumulator<N>::MultiHistAccumulator(coords_t const& size,
+                                                     double fill)
+  : size_(size)
+  , nbins_(1UL)
+  , fill_(fill)
+{
+  for (auto i = N; i-- > 0UL;) {
+    strides_[i] = nbins_;
+    nbins_ *= size_[i];
+  }
+  MaybeDensify();
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetIndex(coords_t const& coords) const -> size_t
+{
+  auto idx = 0UL;
+  for (auto i = 0UL; i < N; i++) {
+    assert(coords[i] < size_[i]);
+    idx += coords[i] * strides_[i];
+  }
+  return idx;
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetCoordinates(size_t idx) const -> coords_t
+{
+  auto coords = coords_t{};
+  for (auto i = 0UL; i < N; i++) {
+    coords[i] = idx / strides_[i];
+    idx %= strides_[i];
+  }
+  return coords;
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::Reset() -> void
+{
+  sparse_.clear();
+  dense_.clear();
+  dense_.shrink_to_fit();
+  count_ = 0UL;
+  MaybeDensify();
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::MaybeDensify() -> void
+{
+  auto const filled = static_cast<double>(sparse_.size());
+  if (IsDense() || filled < fill_ * static_cast<double>(nbins_)) {
+    return;
+  }
+
+  dense_.resize(nbins_);
+  for (auto const& [idx, acc] : sparse_) {
+    dense_[idx] = acc;
+  }
+  sparse_ = {};
+}
+
+template<size_t N>
+template<class T>
+inline auto
+MultiHistAccumulator<N>::AddIndex(size_t idx, T val) -> void
+{
+  assert(idx < nbins_);
+
+  if (IsDense()) {
+    dense_[idx].Add(val);
+  } else {
+    sparse_[idx].Add(val);
+    MaybeDensify();
+  }
+  count_++;
+}
+
+template<size_t N>
+template<typename InputIt>
+inline auto
+MultiHistAccumulator<N>::AddBatch(InputIt first, InputIt last) -> void
+{
+  // compute all the indices first so that the sparse storage grows once
+  auto idx = std::vector<size_t>{};
+  for (; first != last; ++first) {
+    idx.push_back(GetIndex(*first));
+  }
+
+  if (!IsDense()) {
+    sparse_.reserve(std::min(nbins_, sparse_.size() + idx.size()));
+  }
+  for (auto i : idx) {
+    AddIndex(i, 1.0);
+  }
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::Merge(MultiHistAccumulator const& that) -> void
+{
+  if (size_ != that.size_) {
+    throw exception::MultiHistShapeMismatch();
+  }
+
+  auto merge = [this](size_t idx, accumulators::NeumaierAccumulator const& a) {
+    if (IsDense()) {
+      dense_[idx].Merge(a);
+    } else {
+      sparse_[idx].Merge(a);
+      MaybeDensify();
+    }
+  };
+
+  if (that.IsDense()) {
+    for (auto i = 0UL; i < nbins_; i++) {
+      if (that.dense_[i].Count() != 0UL) {
+        merge(i, that.dense_[i]);
+      }
+    }
+  } else {
+    for (auto const& [idx, acc] : that.sparse_) {
+      merge(idx, acc);
+    }
+  }
+  count_ += that.count_;
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::Find(size_t idx) const
+  -> accumulators::NeumaierAccumulator const*
+{
+  if (IsDense()) {
+    return &dense_[idx];
+  }
+  auto it = sparse_.find(idx);
+  return it == sparse_.end() ? nullptr : &it->second;
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetCount(coords_t const& coords) const -> size_t
+{
+  auto const* a = Find(GetIndex(coords));
+  return a == nullptr ? 0UL : a->Count();
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetNumFilled() const -> size_t
+{
+  if (!IsDense()) {
+    return sparse_.size();
+  }
+  auto n = 0UL;
+  for (auto const& a : dense_) {
+    n += a.Count() != 0UL ? 1UL : 0UL;
+  }
+  return n;
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetResult(coords_t const& coords) const -> double
+{
+  auto const* a = Find(GetIndex(coords));
+  if (a == nullptr || a->Count() == 0UL) {
+    return 0.0;
+  }
+  return a->Sum() / static_cast<double>(count_);
+}
+
+template<size_t N>
+inline auto
+MultiHistAccumulator<N>::GetResults() const -> std::vector<double>
+{
+  auto r = std::vector<double>(nbins_, 0.0);
+  if (count_ == 0UL) {
+    return r;
+  }
+
+  auto const norm = static_cast<double>(count_);
+  if (IsDense()) {
+    for (auto i = 0UL; i < nbins_; i++) {
+      r[i] = dense_[i].Count() == 0UL ? 0.0 : dense_[i].Sum() / norm;
+    }
+  } else {
+    for (auto const& [idx, acc] : sparse_) {
+      r[idx] = acc.Sum() / norm;
+    }
+  }
+  return r;
+}
+
+template<size_t N>
+template<class Archive>
+inline auto
+MultiHistAccumulator<N>::serialize(Archive& ar,
+                                   const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & size_;
+  ar & strides_;
+  ar & nbins_;
+  ar & fill_;
+  ar & sparse_;
+  ar & dense_;
+  ar & count_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -16,6 +16,8 @@
 
 // bwsl
 #include <bwsl/Accumulators.hpp>
+#include <bwsl/io/ColumnarWriter.hpp>
+#include <bwsl/io/OutputSink.hpp>
 
 // fmt
 #include <fmt/format.h>
@@ -24,23 +26,87 @@
 // boost
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
 #include <boost/serialization/version.hpp>
 
 // std
+#include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace bwsl {
 
-/// Description
+namespace exception {
+
+/// Observables cannot be added after freezing the group
+class ObservableGroupFrozen : public std::exception
+{
+public:
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "Cannot add observables to a frozen ObservableGroup";
+  }
+}; // class ObservableGroupFrozen
+
+/// Handles can be requested only after freezing the group
+class ObservableGroupNotFrozen : public std::exception
+{
+public:
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "Handles are available only after freezing the ObservableGroup";
+  }
+}; // class ObservableGroupNotFrozen
+
+} // namespace exception
+
+///
+/// Group of observables measured together and printed as a row of a CSV file.
+///
+/// The observables are kept sorted by key in a dense storage. Once all the
+/// keys have been registered the group can be frozen: from that point on no
+/// observable can be added and each key can be turned into a Handle which
+/// addresses its accumulator directly, without any lookup.
+///
+/// By default every print opens the output file. When an io::OutputSink is
+/// attached the rows are formatted into its buffer instead, and the file
+/// stays open for the whole life of the sink.
+///
+/// The name of the output file belongs to the run and is not serialized, a
+/// restored group keeps the one it was constructed with. Saving a group
+/// flushes its sink first, so the rows printed before a checkpoint are on
+/// disk when it is restored.
+///
 template<typename Index_t>
 class ObservableGroup
 {
 public:
+  ///
+  /// Dense index of an observable in a frozen group
+  ///
+  class Handle
+  {
+  public:
+    /// Construct an handle to the given slot
+    explicit Handle(size_t slot)
+      : slot_(slot)
+    {}
+
+    /// Position of the observable in the dense storage
+    [[nodiscard]] auto GetSlot() const -> size_t { return slot_; };
+
+  private:
+    /// Position of the observable in the dense storage
+    size_t slot_;
+  }; // class Handle
+
   /// Default constructor
   ObservableGroup() = default;
 
@@ -68,21 +134,64 @@ public:
   /// Measure an observable
   void Measure(Index_t idx, double val);
 
+  /// Measure an observable through its handle
+  void Measure(Handle h, double val) { accumulator_.Add(h.GetSlot(), val); };
+
   /// Print the headers to the file
   void PrintHeaders() const;
 
   /// Print the results and reset all the accumulators
   void PrintAndReset(size_t precision = 10UL);
 
+  /// Columns describing the observables in a binary columnar file
+  [[nodiscard]] auto GetColumns() const -> std::vector<io::Column>;
+
+  /// Append the results to a binary columnar file and reset the accumulators
+  void WriteAndReset(io::ColumnarWriter& out);
+
+  /// Send the output to @p sink instead of reopening the file at each print
+  auto SetSink(std::shared_ptr<io::OutputSink> sink) -> ObservableGroup&;
+
+  /// Write the output pending in the sink, if any
+  void Flush();
+
+  /// Register a new observable
   auto AddObservable(Index_t key) -> ObservableGroup&;
 
+  /// Forbid the registration of new observables
+  auto Freeze() -> ObservableGroup&;
+
+  /// Check if the group has been frozen
+  [[nodiscard]] auto IsFrozen() const -> bool { return frozen_; };
+
+  /// Get the handle of a registered observable of a frozen group
+  [[nodiscard]] auto GetHandle(Index_t key) const -> Handle;
+
+  /// Number of registered observables
+  [[nodiscard]] auto GetNumObservables() const -> size_t
+  {
+    return keys_.size();
+  };
+
 protected:
+  /// Position of @p key in the dense storage
+  [[nodiscard]] auto GetSlot(Index_t key) const -> size_t;
+
 private:
   /// Name of the associated output file
   std::string output_file_;
 
-  /// Storage for the accumulators
-  std::map<Index_t, accumulators::KahanAccumulator> accumulator_{};
+  /// Registered keys in increasing order
+  std::vector<Index_t> keys_{};
+
+  /// Storage for the accumulators, in the same order of the keys
+  accumulators::KahanAccumulatorArray accumulator_{};
+
+  /// Whether new observables can be registered
+  bool frozen_{ false };
+
+  /// Optional buffered output, not serialized
+  std::shared_ptr<io::OutputSink> sink_{};
 
   friend class boost::serialization::access;
 
@@ -102,27 +211,47 @@ ObservableGroup<Index_t>::ObservableGroup(std::string output_file,
   : output_file_(std::move(output_file))
 {
   for (auto i : indices) {
-    accumulator_.try_emplace(i);
+    AddObservable(i);
+  }
+}
+
+template<typename Index_t>
+inline auto
+ObservableGroup<Index_t>::GetSlot(Index_t key) const -> size_t
+{
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || key < *it) {
+    throw std::out_of_range("ObservableGroup: unknown observable");
   }
+  return static_cast<size_t>(std::distance(keys_.begin(), it));
 }
 
 template<typename Index_t>
 inline void
 ObservableGroup<Index_t>::Measure(Index_t idx, double val)
 {
-  accumulator_.at(idx).Add(val);
+  accumulator_.Add(GetSlot(idx), val);
 }
 
 template<typename Index_t>
 inline void
 ObservableGroup<Index_t>::PrintHeaders() const
 {
+  if (sink_) {
+    sink_->Print("{}", keys_.front());
+    for (auto i = 1UL; i < keys_.size(); i++) {
+      sink_->Print(",{}", keys_[i]);
+    }
+    sink_->Write("\n");
+    return;
+  }
+
   auto out = std::ofstream(output_file_.c_str(), std::ios::trunc);
 
-  auto it = accumulator_.begin();
-  fmt::print(out, "{}", it->first);
-  while (++it != accumulator_.end()) {
-    fmt::print(out, ",{}", it->first);
+  auto it = keys_.begin();
+  fmt::print(out, "{}", *it);
+  while (++it != keys_.end()) {
+    fmt::print(out, ",{}", *it);
   }
   fmt::print(out, "\n");
 }
@@ -131,16 +260,24 @@ template<typename Index_t>
 inline void
 ObservableGroup<Index_t>::PrintAndReset(size_t precision)
 {
+  if (sink_) {
+    sink_->Print("{:.{}e}", accumulator_.Mean(0), precision);
+    for (auto i = 1UL; i < keys_.size(); i++) {
+      sink_->Print(",{:.{}e}", accumulator_.Mean(i), precision);
+    }
+    sink_->Write("\n");
+    accumulator_.Reset();
+    return;
+  }
+
   auto out = std::ofstream(output_file_.c_str(), std::ios::app);
 
-  auto it = accumulator_.begin();
-  fmt::print(out, "{:.{}e}", it->second.Mean(), precision);
-  it->second.Reset();
-  while (++it != accumulator_.end()) {
-    fmt::print(out, ",{:.{}e}", it->second.Mean(), precision);
-    it->second.Reset();
+  fmt::print(out, "{:.{}e}", accumulator_.Mean(0), precision);
+  for (auto i = 1UL; i < keys_.size(); i++) {
+    fmt::print(out, ",{:.{}e}", accumulator_.Mean(i), precision);
   }
   fmt::print(out, "\n");
+  accumulator_.Reset();
 }
 
 template<typename Index_t>
@@ -148,22 +285,131 @@ inline auto
 ObservableGroup<Index_t>::AddObservable(Index_t key)
   -> ObservableGroup<Index_t>&
 {
-  accumulator_.try_emplace(key);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it != keys_.end() && !(key < *it)) {
+    return *this;
+  }
+
+  if (frozen_) {
+    throw exception::ObservableGroupFrozen();
+  }
+
+  auto pos = static_cast<size_t>(std::distance(keys_.begin(), it));
+  keys_.insert(it, key);
+  accumulator_.Insert(pos);
   return *this;
 }
 
+template<typename Index_t>
+inline auto
+ObservableGroup<Index_t>::GetColumns() const -> std::vector<io::Column>
+{
+  auto columns = std::vector<io::Column>{};
+  for (auto const& k : keys_) {
+    columns.push_back({ fmt::format("{}", k), io::ColumnType::Float64 });
+  }
+  return columns;
+}
+
+template<typename Index_t>
+inline void
+ObservableGroup<Index_t>::WriteAndReset(io::ColumnarWriter& out)
+{
+  for (auto i = 0UL; i < keys_.size(); i++) {
+    out.Push(accumulator_.Mean(i));
+  }
+  out.EndRow();
+  accumulator_.Reset();
+}
+
+template<typename Index_t>
+inline auto
+ObservableGroup<Index_t>::SetSink(std::shared_ptr<io::OutputSink> sink)
+  -> ObservableGroup<Index_t>&
+{
+  sink_ = std::move(sink);
+  return *this;
+}
+
+template<typename Index_t>
+inline void
+ObservableGroup<Index_t>::Flush()
+{
+  if (sink_) {
+    sink_->Flush();
+  }
+}
+
+template<typename Index_t>
+inline auto
+ObservableGroup<Index_t>::Freeze() -> ObservableGroup<Index_t>&
+{
+  frozen_ = true;
+  return *this;
+}
+
+template<typename Index_t>
+inline auto
+ObservableGroup<Index_t>::GetHandle(Index_t key) const -> Handle
+{
+  if (!frozen_) {
+    throw exception::ObservableGroupNotFrozen();
+  }
+  return Handle(GetSlot(key));
+}
+
 template<typename Index_t>
 template<class Archive>
 void
-ObservableGroup<Index_t>::serialize(Archive& ar,
-                                    const unsigned int /* version */)
+ObservableGroup<Index_t>::serialize(Archive& ar, const unsigned int version)
 {
+  if (version == 0U) {
+    // only loaded: the output file, then the accumulators by key
+    auto output_file = std::string{};
+    auto legacy = std::map<Index_t, accumulators::KahanAccumulator>{};
+    // clang-format off
+    ar & output_file;
+    ar & legacy;
+    // clang-format on
+
+    keys_.clear();
+    accumulator_ = accumulators::KahanAccumulatorArray(legacy.size());
+    for (auto const& [key, acc] : legacy) {
+      accumulator_.Assign(keys_.size(), acc);
+      keys_.push_back(key);
+    }
+    frozen_ = false;
+    return;
+  }
+
+  if (typename Archive::is_saving()) {
+    Flush();
+  }
+
   // clang-format off
-  ar & output_file_;
+  ar & keys_;
   ar & accumulator_;
+  ar & frozen_;
   // clang-format on
 }
 
 } // namespace bwsl
 
+namespace boost::serialization {
+
+///
+/// Archives of version 0 store the name of the output file and a map from
+/// the keys to the accumulators, version 1 stores the sorted keys, the
+/// dense accumulators and whether the group is frozen.
+///
+template<typename Index_t>
+struct version<bwsl::ObservableGroup<Index_t>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace boost::serialization
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
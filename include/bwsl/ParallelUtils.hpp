@@ -0,0 +1,35 @@
+//===-- ParallelUtils.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Defaults for the multithreaded classes
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+namespace bwsl {
+
+///
+/// Number of threads to use when none is requested
+///
+inline auto
+default_num_threads() -> size_t
+{
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,342 @@
+//===-- Philox.hpp ---------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the Philox4x32 counter based generator
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// boost
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace bwsl {
+
+///
+/// Philox4x32-10 counter based random number generator.
+///
+/// Every block of four numbers is a bijection of a 128 bits counter under a
+/// 64 bits key (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+/// 3", SC11), so the generator has no state besides the counter and any
+/// position can be reached in constant time.
+///
+/// The lower 64 bits of the counter number the blocks, the upper 64 bits
+/// select a stream. Independent streams for threads, walkers or sites are
+/// obtained with Split, which costs nothing and never overlaps with other
+/// streams of the same seed.
+///
+/// The class satisfies the UniformRandomBitGenerator requirements and can
+/// be used with the distributions of the standard library.
+///
+class Philox4x32
+{
+public:
+  /// Type of the generated numbers
+  using result_type = std::uint32_t;
+
+  /// Counter of a block
+  using counter_type = std::array<std::uint32_t, 4>;
+
+  /// Key of the bijection
+  using key_type = std::array<std::uint32_t, 2>;
+
+  /// Number of rounds of the bijection
+  static constexpr size_t rounds = 10UL;
+
+  /// Seed used by the default constructor
+  static constexpr std::uint64_t default_seed = 20111115UL;
+
+  /// Construct the stream @p stream of the generator with seed @p seed
+  explicit Philox4x32(std::uint64_t seed = default_seed,
+                      std::uint64_t stream = 0UL);
+
+  /// Copy constructor
+  Philox4x32(Philox4x32 const& that) = default;
+
+  /// Move constructor
+  Philox4x32(Philox4x32&& that) = default;
+
+  /// Default destructor
+  ~Philox4x32() = default;
+
+  /// Copy assignment operator
+  auto operator=(Philox4x32 const& that) -> Philox4x32& = default;
+
+  /// Move assignment operator
+  auto operator=(Philox4x32&& that) -> Philox4x32& = default;
+
+  /// Smallest value generated
+  static constexpr auto min() -> result_type { return 0U; };
+
+  /// Largest value generated
+  static constexpr auto max() -> result_type
+  {
+    return std::numeric_limits<result_type>::max();
+  };
+
+  /// The Philox bijection of a counter under a key
+  static constexpr auto Generate(counter_type ctr, key_type key)
+    -> counter_type;
+
+  /// Restart the stream @p stream with seed @p seed
+  auto seed(std::uint64_t seed = default_seed, std::uint64_t stream = 0UL)
+    -> void;
+
+  /// Next random number
+  auto operator()() -> result_type;
+
+  /// Skip the next @p z numbers, in constant time
+  auto discard(unsigned long long z) -> void;
+
+  /// Fill [@p first, @p first + @p n) with the next numbers, as @p n calls
+  /// to operator() would do but many blocks at a time
+  auto Fill(result_type* first, size_t n) -> void;
+
+  /// A generator with the same seed at the beginning of the stream
+  /// @p stream
+  [[nodiscard]] auto Split(std::uint64_t stream) const -> Philox4x32;
+
+  /// The seed
+  [[nodiscard]] auto GetSeed() const -> std::uint64_t;
+
+  /// The stream
+  [[nodiscard]] auto GetStream() const -> std::uint64_t;
+
+  /// Check if two generators will produce the same numbers
+  friend auto operator==(Philox4x32 const& lhs, Philox4x32 const& rhs) -> bool
+  {
+    return lhs.key_ == rhs.key_ && lhs.ctr_ == rhs.ctr_ &&
+           lhs.idx_ == rhs.idx_ && (lhs.idx_ == 4U || lhs.buf_ == rhs.buf_);
+  };
+
+  /// Check if two generators will produce different numbers
+  friend auto operator!=(Philox4x32 const& lhs, Philox4x32 const& rhs) -> bool
+  {
+    return !(lhs == rhs);
+  };
+
+protected:
+  /// Generate @p L consecutive blocks of the stream, starting from block
+  /// @p block, into @p out. The lanes are independent so the loops vectorize
+  template<size_t L>
+  auto GenerateLanes(std::uint64_t block, result_type* out) const -> void;
+
+  /// Index of the next block
+  [[nodiscard]] auto GetBlock() const -> std::uint64_t;
+
+  /// Set the index of the next block
+  auto SetBlock(std::uint64_t block) -> void;
+
+private:
+  /// Multipliers of the rounds
+  static constexpr std::uint32_t m0 = 0xD2511F53U;
+  static constexpr std::uint32_t m1 = 0xCD9E8D57U;
+
+  /// Weyl sequence increments of the key
+  static constexpr std::uint32_t w0 = 0x9E3779B9U;
+  static constexpr std::uint32_t w1 = 0xBB67AE85U;
+
+  /// The key
+  key_type key_{};
+
+  /// Counter of the next block
+  counter_type ctr_{};
+
+  /// The current block
+  counter_type buf_{};
+
+  /// Position of the next number in the current block, 4 when it is used up
+  std::uint32_t idx_{ 4U };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class Philox4x32
+
+inline Philox4x32::Philox4x32(std::uint64_t seed, std::uint64_t stream)
+{
+  this->seed(seed, stream);
+}
+
+constexpr auto
+Philox4x32::Generate(counter_type ctr, key_type key) -> counter_type
+{
+  for (auto r = 0UL; r < rounds; r++) {
+    auto p0 = std::uint64_t{ m0 } * ctr[0];
+    auto p1 = std::uint64_t{ m1 } * ctr[2];
+    ctr = { static_cast<std::uint32_t>(p1 >> 32U) ^ ctr[1] ^ key[0],
+            static_cast<std::uint32_t>(p1),
+            static_cast<std::uint32_t>(p0 >> 32U) ^ ctr[3] ^ key[1],
+            static_cast<std::uint32_t>(p0) };
+    key[0] += w0;
+    key[1] += w1;
+  }
+  return ctr;
+}
+
+inline auto
+Philox4x32::seed(std::uint64_t seed, std::uint64_t stream) -> void
+{
+  key_ = { static_cast<std::uint32_t>(seed),
+           static_cast<std::uint32_t>(seed >> 32U) };
+  ctr_ = { 0U,
+           0U,
+           static_cast<std::uint32_t>(stream),
+           static_cast<std::uint32_t>(stream >> 32U) };
+  buf_ = {};
+  idx_ = 4U;
+}
+
+inline auto
+Philox4x32::GetBlock() const -> std::uint64_t
+{
+  return std::uint64_t{ ctr_[0] } | (std::uint64_t{ ctr_[1] } << 32U);
+}
+
+inline auto
+Philox4x32::SetBlock(std::uint64_t block) -> void
+{
+  ctr_[0] = static_cast<std::uint32_t>(block);
+  ctr_[1] = static_cast<std::uint32_t>(block >> 32U);
+}
+
+inline auto
+Philox4x32::operator()() -> result_type
+{
+  if (idx_ == 4U) {
+    buf_ = Generate(ctr_, key_);
+    SetBlock(GetBlock() + 1UL);
+    idx_ = 0U;
+  }
+  return buf_[idx_++];
+}
+
+inline auto
+Philox4x32::discard(unsigned long long z) -> void
+{
+  auto const left = 4U - idx_;
+  if (z <= left) {
+    idx_ += static_cast<std::uint32_t>(z);
+    return;
+  }
+
+  z -= left;
+  SetBlock(GetBlock() + z / 4U);
+  idx_ = 4U;
+  if (z % 4U != 0U) {
+    operator()();
+    idx_ = static_cast<std::uint32_t>(z % 4U);
+  }
+}
+
+template<size_t L>
+inline auto
+Philox4x32::GenerateLanes(std::uint64_t block, result_type* out) const -> void
+{
+  // structure of arrays, one lane per block
+  std::uint32_t c0[L], c1[L], c2[L], c3[L];
+  for (auto l = 0UL; l < L; l++) {
+    c0[l] = static_cast<std::uint32_t>(block + l);
+    c1[l] = static_cast<std::uint32_t>((block + l) >> 32U);
+    c2[l] = ctr_[2];
+    c3[l] = ctr_[3];
+  }
+
+  auto k0 = key_[0];
+  auto k1 = key_[1];
+  for (auto r = 0UL; r < rounds; r++) {
+    for (auto l = 0UL; l < L; l++) {
+      auto p0 = std::uint64_t{ m0 } * c0[l];
+      auto p1 = std::uint64_t{ m1 } * c2[l];
+      c0[l] = static_cast<std::uint32_t>(p1 >> 32U) ^ c1[l] ^ k0;
+      c1[l] = static_cast<std::uint32_t>(p1);
+      c2[l] = static_cast<std::uint32_t>(p0 >> 32U) ^ c3[l] ^ k1;
+      c3[l] = static_cast<std::uint32_t>(p0);
+    }
+    k0 += w0;
+    k1 += w1;
+  }
+
+  for (auto l = 0UL; l < L; l++) {
+    out[4UL * l + 0UL] = c0[l];
+    out[4UL * l + 1UL] = c1[l];
+    out[4UL * l + 2UL] = c2[l];
+    out[4UL * l + 3UL] = c3[l];
+  }
+}
+
+inline auto
+Philox4x32::Fill(result_type* first, size_t n) -> void
+{
+  // finish the current block
+  while (n > 0UL && idx_ < 4U) {
+    *first++ = buf_[idx_++];
+    n--;
+  }
+
+  constexpr auto lanes = 8UL;
+  auto block = GetBlock();
+  while (n >= 4UL * lanes) {
+    GenerateLanes<lanes>(block, first);
+    block += lanes;
+    first += 4UL * lanes;
+    n -= 4UL * lanes;
+  }
+  SetBlock(block);
+
+  while (n > 0UL) {
+    *first++ = operator()();
+    n--;
+  }
+}
+
+inline auto
+Philox4x32::Split(std::uint64_t stream) const -> Philox4x32
+{
+  return Philox4x32(GetSeed(), stream);
+}
+
+inline auto
+Philox4x32::GetSeed() const -> std::uint64_t
+{
+  return std::uint64_t{ key_[0] } | (std::uint64_t{ key_[1] } << 32U);
+}
+
+inline auto
+Philox4x32::GetStream() const -> std::uint64_t
+{
+  return std::uint64_t{ ctr_[2] } | (std::uint64_t{ ctr_[3] } << 32U);
+}
+
+template<class Archive>
+inline auto
+Philox4x32::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & key_;
+  ar & ctr_;
+  ar & buf_;
+  ar & idx_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -15,16 +15,222 @@
 #pragma once
 
 // boost
+#include <boost/serialization/binary_object.hpp>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/version.hpp>
 
 // std
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+
+#define MT_TPARAMS                                                             \
+  typename UIntType, size_t w, size_t n, size_t m, size_t r, UIntType a,       \
+    size_t u, UIntType d, size_t s, UIntType b, size_t t, UIntType c,          \
+    size_t l, UIntType f
+#define MT_TARGLIST UIntType, w, n, m, r, a, u, d, s, b, t, c, l, f
+
+namespace bwsl {
+
+///
+/// Raw state of a Mersenne Twister: the n words of the state followed by
+/// the position of the next word to temper, as laid out by the standard
+/// libraries.
+///
+template<MT_TPARAMS>
+struct MersenneTwisterState
+{
+  /// State words
+  UIntType words[n];
+
+  /// Position in the state
+  size_t pos;
+};
+
+///
+/// Standard libraries whose layout of the Mersenne Twisters is known.
+///
+/// Both keep the n words and a position, but libstdc++ regenerates all the
+/// words at once when the position reaches n, while libc++ keeps the
+/// position in [0, n) and replaces one word at a time: its words are the
+/// last n words of the sequence, rotated by the position.
+///
+enum class MersenneTwisterLayout : std::uint8_t
+{
+  /// Unknown layout, the engines are saved as text
+  Unknown = 0U,
+
+  /// libstdc++
+  LibStdCxx = 1U,
+
+  /// libc++
+  LibCxx = 2U
+};
+
+/// Layout of the standard library in use
+#if defined(_LIBCPP_VERSION)
+constexpr auto mersenne_twister_layout = MersenneTwisterLayout::LibCxx;
+#elif defined(__GLIBCXX__)
+constexpr auto mersenne_twister_layout = MersenneTwisterLayout::LibStdCxx;
+#else
+constexpr auto mersenne_twister_layout = MersenneTwisterLayout::Unknown;
+#endif
+
+/// Check if a type is a Mersenne Twister engine
+template<typename T>
+struct is_mersenne_twister : std::false_type
+{};
+
+/// Check if a type is a Mersenne Twister engine
+template<MT_TPARAMS>
+struct is_mersenne_twister<std::mersenne_twister_engine<MT_TARGLIST>>
+  : std::true_type
+{};
+
+/// Check if the raw state of a Mersenne Twister can be accessed
+template<typename T>
+struct has_raw_state : std::false_type
+{};
+
+/// Check if the raw state of a Mersenne Twister can be accessed
+template<MT_TPARAMS>
+struct has_raw_state<std::mersenne_twister_engine<MT_TARGLIST>>
+  : std::integral_constant<
+      bool,
+      mersenne_twister_layout != MersenneTwisterLayout::Unknown &&
+        std::is_trivially_copyable<
+          std::mersenne_twister_engine<MT_TARGLIST>>::value &&
+        sizeof(std::mersenne_twister_engine<MT_TARGLIST>) ==
+          sizeof(MersenneTwisterState<MT_TARGLIST>)>
+{};
+
+/// Smallest unsigned type holding the words of a Mersenne Twister
+template<size_t w>
+using mersenne_twister_word_t =
+  std::conditional_t<(w <= 32UL), std::uint32_t, std::uint64_t>;
+
+/// Byte order tag of the machine used when serializing the engines,
+/// 1 for little endian and 2 for big endian
+inline auto
+mersenne_twister_byteorder() -> std::uint8_t
+{
+  auto one = std::uint16_t{ 1U };
+  auto first = std::uint8_t{};
+  std::memcpy(&first, &one, 1UL);
+  return first == 1U ? 1U : 2U;
+}
+
+/// Copy the raw state out of a Mersenne Twister
+template<MT_TPARAMS>
+inline auto
+get_state(std::mersenne_twister_engine<MT_TARGLIST> const& mt)
+  -> MersenneTwisterState<MT_TARGLIST>
+{
+  static_assert(has_raw_state<std::mersenne_twister_engine<MT_TARGLIST>>::value,
+                "Unexpected layout of std::mersenne_twister_engine");
+
+  auto state = MersenneTwisterState<MT_TARGLIST>{};
+  std::memcpy(&state, &mt, sizeof(state));
+  return state;
+}
+
+///
+/// Restore the raw state of a Mersenne Twister, written by a standard
+/// library with the given @p layout.
+///
+/// The states of libc++ are converted to the ones of libstdc++ and the
+/// other way around. A libstdc++ engine with unused words cannot be
+/// expressed by libc++, which throws as for invalid states.
+///
+template<MT_TPARAMS>
+inline auto
+set_state(std::mersenne_twister_engine<MT_TARGLIST>& mt,
+          MersenneTwisterState<MT_TARGLIST> const& state,
+          MersenneTwisterLayout layout = mersenne_twister_layout) -> void
+{
+  static_assert(has_raw_state<std::mersenne_twister_engine<MT_TARGLIST>>::value,
+                "Unexpected layout of std::mersenne_twister_engine");
+
+  auto const last = layout == MersenneTwisterLayout::LibCxx ? n - 1UL : n;
+  if (layout == MersenneTwisterLayout::Unknown || state.pos > last) {
+    throw std::invalid_argument("mersenne_twister_engine state");
+  }
+
+  auto native = state;
+  if (layout != mersenne_twister_layout) {
+    // bring the words in the order of the sequence, oldest first
+    if (layout == MersenneTwisterLayout::LibCxx) {
+      std::rotate(std::begin(native.words),
+                  std::begin(native.words) + state.pos,
+                  std::end(native.words));
+    } else if (state.pos != n) {
+      throw std::invalid_argument(
+        "mersenne_twister_engine state of another standard library");
+    }
+    native.pos =
+      mersenne_twister_layout == MersenneTwisterLayout::LibCxx ? 0UL : n;
+  }
+  std::memcpy(static_cast<void*>(&mt), &native, sizeof(native));
+}
+
+/// Text state of a Mersenne Twister, as written by operator<<
+template<MT_TPARAMS>
+inline auto
+get_text(std::mersenne_twister_engine<MT_TARGLIST> const& mt) -> std::string
+{
+  auto oss = std::ostringstream{};
+  oss << mt;
+  return oss.str();
+}
+
+/// Restore the text state of a Mersenne Twister
+template<MT_TPARAMS>
+inline auto
+set_text(std::mersenne_twister_engine<MT_TARGLIST>& mt,
+         std::string const& text) -> void
+{
+  auto iss = std::istringstream(text);
+  if (!(iss >> mt)) {
+    throw std::invalid_argument("mersenne_twister_engine state");
+  }
+}
+
+} // namespace bwsl
 
 namespace boost::serialization {
 
+///
+/// Archives written before version 1 store the engine as the text produced
+/// by operator<<, version 1 stores the raw state:
+///
+///     u8 byteorder (1 little, 2 big)  u8 bytes per word
+///     n words as a binary block       u64 position
+///
+/// and version 2 adds the layout of the standard library which wrote it:
+///
+///     u8 byteorder  u8 bytes per word  u8 layout (0 text, 1 libstdc++,
+///     2 libc++), then the n words and the u64 position, or the text of
+///     operator<< for libraries with an unknown layout
+///
+/// The words are written in the byte order of the machine and swapped on
+/// load if needed, so two saves of the same engine give the same bytes.
+/// Version 1 archives are read with the layout of the library in use.
+///
+template<MT_TPARAMS>
+struct version<std::mersenne_twister_engine<MT_TARGLIST>>
+{
+  typedef mpl::int_<2> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
 // The following code (from START CODE to END CODE)has been taken and modified
 // from StackOverflow It is released on StackOverflow under the
 // LICENSE CC BY-SA 3.0
@@ -33,19 +239,14 @@ namespace boost::serialization {
 // Changes include formatting and stylistics changes.
 // START CODE
 
-#define MT_TPARAMS                                                             \
-  typename UIntType, size_t w, size_t n, size_t m, size_t r, UIntType a,       \
-    size_t u, UIntType d, size_t s, UIntType b, size_t t, UIntType c,          \
-    size_t l, UIntType f
-#define MT_TARGLIST UIntType, w, n, m, r, a, u, d, s, b, t, c, l, f
-
 template<typename Ar, MT_TPARAMS>
 inline auto
-load(Ar& ar, std::mersenne_twister_engine<MT_TARGLIST>& mt, unsigned /*unused*/)
-  -> void
+load_text(Ar& ar, std::mersenne_twister_engine<MT_TARGLIST>& mt) -> void
 {
   std::string text;
-  ar& text;
+  // clang-format off
+  ar & text;
+  // clang-format on
   std::istringstream iss(text);
 
   if (!(iss >> mt)) {
@@ -53,18 +254,128 @@ load(Ar& ar, std::mersenne_twister_engine<MT_TARGLIST>& mt, unsigned /*unused*/)
   }
 }
 
+// END CODE
+
+template<typename Ar, MT_TPARAMS>
+inline auto
+load(Ar& ar, std::mersenne_twister_engine<MT_TARGLIST>& mt, unsigned version)
+  -> void
+{
+  if (version == 0U) {
+    load_text(ar, mt);
+    return;
+  }
+
+  using engine_t = std::mersenne_twister_engine<MT_TARGLIST>;
+  using word_t = bwsl::mersenne_twister_word_t<w>;
+
+  auto byteorder = std::uint8_t{};
+  auto bytes = std::uint8_t{};
+  auto layout = static_cast<std::uint8_t>(bwsl::mersenne_twister_layout);
+  // clang-format off
+  ar & byteorder;
+  ar & bytes;
+  // clang-format on
+  if (version > 1U) {
+    // clang-format off
+    ar & layout;
+    // clang-format on
+  }
+  if (bytes != sizeof(word_t) || (byteorder != 1U && byteorder != 2U)) {
+    throw std::invalid_argument("mersenne_twister_engine state");
+  }
+  if (layout == 0U) {
+    load_text(ar, mt);
+    return;
+  }
+
+  if constexpr (!bwsl::has_raw_state<engine_t>::value) {
+    throw std::invalid_argument(
+      "mersenne_twister_engine state of another standard library");
+  } else {
+    auto state = bwsl::MersenneTwisterState<MT_TARGLIST>{};
+    if constexpr (sizeof(word_t) == sizeof(UIntType)) {
+      // clang-format off
+      ar & make_binary_object(state.words, sizeof(state.words));
+      // clang-format on
+    } else {
+      word_t words[n];
+      // clang-format off
+      ar & make_binary_object(words, sizeof(words));
+      // clang-format on
+      std::copy(std::begin(words), std::end(words), std::begin(state.words));
+    }
+
+    if (byteorder != bwsl::mersenne_twister_byteorder()) {
+      for (auto& x : state.words) {
+        auto y = static_cast<word_t>(x);
+        auto* p = reinterpret_cast<unsigned char*>(&y);
+        std::reverse(p, p + sizeof(y));
+        x = y;
+      }
+    }
+
+    auto pos = std::uint64_t{};
+    // clang-format off
+    ar & pos;
+    // clang-format on
+    state.pos = static_cast<size_t>(pos);
+    bwsl::set_state(
+      mt, state, static_cast<bwsl::MersenneTwisterLayout>(layout));
+  }
+}
+
 template<typename Ar, MT_TPARAMS>
 inline auto
 save(Ar& ar,
      std::mersenne_twister_engine<MT_TARGLIST> const& mt,
      unsigned /*unused*/) -> void
 {
-  std::ostringstream oss;
-  if (!(oss << mt)) {
-    throw std::invalid_argument("mersenne_twister_engine state");
+  using engine_t = std::mersenne_twister_engine<MT_TARGLIST>;
+  using state_t = bwsl::MersenneTwisterState<MT_TARGLIST>;
+  using word_t = bwsl::mersenne_twister_word_t<w>;
+
+  auto byteorder = bwsl::mersenne_twister_byteorder();
+  auto bytes = static_cast<std::uint8_t>(sizeof(word_t));
+  auto layout = bwsl::has_raw_state<engine_t>::value
+                  ? static_cast<std::uint8_t>(bwsl::mersenne_twister_layout)
+                  : std::uint8_t{ 0U };
+  // clang-format off
+  ar & byteorder;
+  ar & bytes;
+  ar & layout;
+  // clang-format on
+
+  if constexpr (!bwsl::has_raw_state<engine_t>::value) {
+    auto text = bwsl::get_text(mt);
+    // clang-format off
+    ar & text;
+    // clang-format on
+  } else {
+    // the engine is read through its bytes, laid out as a state_t
+    auto* raw = reinterpret_cast<unsigned char*>(const_cast<engine_t*>(&mt));
+    if constexpr (sizeof(word_t) == sizeof(UIntType)) {
+      // the words go straight from the engine to the archive
+      // clang-format off
+      ar & make_binary_object(raw + offsetof(state_t, words),
+                              n * sizeof(word_t));
+      // clang-format on
+    } else {
+      auto state = bwsl::get_state(mt);
+      word_t words[n];
+      std::copy(std::begin(state.words), std::end(state.words), words);
+      // clang-format off
+      ar & make_binary_object(words, sizeof(words));
+      // clang-format on
+    }
+
+    auto position = size_t{};
+    std::memcpy(&position, raw + offsetof(state_t, pos), sizeof(position));
+    auto pos = static_cast<std::uint64_t>(position);
+    // clang-format off
+    ar & pos;
+    // clang-format on
   }
-  std::string text = oss.str();
-  ar& text;
 }
 
 template<typename Ar, MT_TPARAMS>
@@ -80,10 +391,9 @@ serialize(Ar& ar,
   }
 }
 
+} // namespace boost::serialization
+
 #undef MT_TPARAMS
 #undef MT_TARGLIST
-// END CODE
-
-} // namespace boost::serialization
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -25,12 +25,13 @@
 // std
 #include <iostream>
 #include <sstream>
+#include <type_traits>
 
 namespace bwsl {
 
 /// Class for managing rational numbers
 template<class T = long>
-class RationalNum
+class RationalNum final
 {
 public:
   /// Default constructor
@@ -49,7 +50,7 @@ public:
   auto operator=(RationalNum&&) noexcept -> RationalNum& = default;
 
   /// Default destructor
-  virtual ~RationalNum() = default;
+  ~RationalNum() = default;
 
   /// Constructor
   RationalNum(T num, T den);
@@ -335,6 +336,9 @@ ToString(RationalNum<T> const& rhs) -> std::string
   return fmt::format("{}", rhs);
 }
 
+static_assert(sizeof(RationalNum<long>) == 2UL * sizeof(long));
+static_assert(std::is_trivially_copyable<RationalNum<long>>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,361 @@
+//===-- Reweighting.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MultiHistogramReweighting Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/ParallelUtils.hpp>
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+namespace exception {
+
+/// An histogram does not have one bin for each energy
+class ReweightingBinMismatch : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The histogram does not match the energy bins";
+  }
+};
+
+/// The self consistent equations did not converge
+class ReweightingNotConverged : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The reweighting did not converge";
+  }
+};
+
+/// There are no simulations to reweight
+class ReweightingNoSimulations : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The reweighting needs at least one simulation";
+  }
+};
+
+} // namespace exception
+
+///
+/// Ferrenberg-Swendsen multiple histogram reweighting (WHAM).
+///
+/// Energy histograms collected at several inverse temperatures are combined
+/// into a single estimate of the density of states, which can then be used
+/// to compute canonical averages at any temperature in the sampled range.
+///
+/// Every quantity is kept as a logarithm and all the sums of exponentials
+/// are shifted by their maximum and summed with Neumaier compensation, so
+/// that widely different temperatures do not overflow or lose precision.
+/// The loops over energies and over temperatures run on a ThreadPool
+/// started once for the whole solution, each loop split in one contiguous
+/// chunk per thread. Interpolate runs on a pool owned by the caller, which
+/// can be shared with the simulations.
+///
+class MultiHistogramReweighting
+{
+public:
+  /// Use the given energy for each bin of the histograms
+  MultiHistogramReweighting(std::vector<double> energies,
+                            size_t nthreads = default_num_threads());
+
+  /// Add the energy histogram of a simulation at inverse temperature
+  /// @p beta
+  auto AddSimulation(double beta, HistAccumulator const& hist) -> void;
+
+  /// Iterate the self consistent equations until the free energies change
+  /// less than @p tol, returns the number of iterations
+  auto Solve(double tol = 1e-10, size_t maxiter = 100000UL) -> size_t;
+
+  /// Logarithm of the density of states, up to a constant
+  [[nodiscard]] auto GetLogDensity() const -> std::vector<double> const&
+  {
+    return logg_;
+  };
+
+  /// Dimensionless free energies of the simulations, the first one is zero
+  [[nodiscard]] auto GetFreeEnergies() const -> std::vector<double> const&
+  {
+    return f_;
+  };
+
+  /// Logarithm of the partition function, up to the same constant as
+  /// the density of states
+  [[nodiscard]] auto GetLogZ(double beta) const -> double;
+
+  /// Canonical average of an observable given its microcanonical average
+  /// @p obs in every energy bin
+  [[nodiscard]] auto GetMean(double beta, std::vector<double> const& obs) const
+    -> double;
+
+  /// Canonical average of the energy
+  [[nodiscard]] auto GetEnergy(double beta) const -> double
+  {
+    return GetMean(beta, energies_);
+  };
+
+  /// Specific heat per system, beta^2 times the variance of the energy
+  [[nodiscard]] auto GetSpecificHeat(double beta) const -> double;
+
+  /// Evaluate @p fn at every inverse temperature in @p betas, in parallel
+  /// on @p pool
+  template<class Fn>
+  [[nodiscard]] auto Interpolate(ThreadPool& pool,
+                                 std::vector<double> const& betas,
+                                 Fn fn) const -> std::vector<double>;
+
+  /// Number of simulations
+  [[nodiscard]] auto GetNumSimulations() const -> size_t
+  {
+    return betas_.size();
+  };
+
+  /// Number of energy bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return energies_.size(); };
+
+protected:
+  /// Logarithm of the sum of the exponentials of @p n terms
+  template<class Term>
+  static auto log_sum_exp(size_t n, Term term) -> double;
+
+  /// Normalized canonical weights of the bins at @p beta
+  [[nodiscard]] auto GetWeights(double beta) const -> std::vector<double>;
+
+  /// Call @p fn(i) for every i in [0, @p n) on @p pool, one chunk per thread
+  template<class Fn>
+  static auto ForEach(ThreadPool& pool, size_t n, Fn fn) -> void;
+
+private:
+  /// Energy of each bin
+  std::vector<double> energies_;
+
+  /// Number of threads
+  size_t nthreads_;
+
+  /// Inverse temperatures of the simulations
+  std::vector<double> betas_{};
+
+  /// Logarithm of the number of samples of each simulation
+  std::vector<double> logn_{};
+
+  /// Logarithm of the total histogram
+  std::vector<double> logh_{};
+
+  /// Total histogram, before taking the logarithm
+  std::vector<accumulators::NeumaierAccumulator> total_{};
+
+  /// Dimensionless free energies
+  std::vector<double> f_{};
+
+  /// Logarithm of the density of states
+  std::vector<double> logg_{};
+}; // class MultiHistogramReweighting
+
+inline MultiHistogramReweighting::MultiHistogramReweighting(
+  std::vector<double> energies,
+  size_t nthreads)
+  : energies_(std::move(energies))
+  , nthreads_(nthreads)
+  , total_(energies_.size())
+  , logg_(energies_.size(), -std::numeric_limits<double>::infinity())
+{
+}
+
+template<class Term>
+inline auto
+MultiHistogramReweighting::log_sum_exp(size_t n, Term term) -> double
+{
+  auto const ninf = -std::numeric_limits<double>::infinity();
+  auto m = ninf;
+  for (auto j = 0UL; j < n; j++) {
+    m = std::max(m, term(j));
+  }
+  if (m == ninf) {
+    return ninf;
+  }
+
+  auto acc = accumulators::NeumaierAccumulator{};
+  for (auto j = 0UL; j < n; j++) {
+    acc.Add(std::exp(term(j) - m));
+  }
+  return m + std::log(acc.Sum());
+}
+
+inline auto
+MultiHistogramReweighting::AddSimulation(double beta,
+                                         HistAccumulator const& hist) -> void
+{
+  if (hist.GetNbins() != energies_.size()) {
+    throw exception::ReweightingBinMismatch();
+  }
+
+  auto const n = static_cast<double>(hist.GetCount());
+  for (auto i = 0UL; i < energies_.size(); i++) {
+    if (hist.GetCount(i) != 0UL) {
+      total_[i].Add(hist.GetResult(i) * n);
+    }
+  }
+
+  betas_.push_back(beta);
+  logn_.push_back(std::log(n));
+  f_.push_back(0.0);
+}
+
+template<class Fn>
+inline auto
+MultiHistogramReweighting::ForEach(ThreadPool& pool, size_t n, Fn fn) -> void
+{
+  auto const nchunks = std::min(pool.GetNumThreads(), n);
+  pool.ParallelFor(0UL, nchunks, [&fn, n, nchunks](size_t c) {
+    for (auto i = n * c / nchunks; i < n * (c + 1UL) / nchunks; i++) {
+      fn(i);
+    }
+  });
+}
+
+inline auto
+MultiHistogramReweighting::Solve(double tol, size_t maxiter) -> size_t
+{
+  auto const nbins = energies_.size();
+  auto const nsims = betas_.size();
+  auto const ninf = -std::numeric_limits<double>::infinity();
+  if (nsims == 0UL) {
+    throw exception::ReweightingNoSimulations();
+  }
+
+  logh_.assign(nbins, ninf);
+  for (auto i = 0UL; i < nbins; i++) {
+    if (total_[i].Count() != 0UL && total_[i].Sum() > 0.0) {
+      logh_[i] = std::log(total_[i].Sum());
+    }
+  }
+
+  auto pool = ThreadPool(nthreads_);
+  auto f = std::vector<double>(nsims, 0.0);
+  for (auto iter = 1UL; iter <= maxiter; iter++) {
+    // density of states from the current free energies
+    ForEach(pool, nbins, [&](size_t i) {
+      if (logh_[i] == ninf) {
+        logg_[i] = ninf;
+        return;
+      }
+      logg_[i] = logh_[i] - log_sum_exp(nsims, [&](size_t k) {
+                   return logn_[k] + f_[k] - betas_[k] * energies_[i];
+                 });
+    });
+
+    // free energies from the density of states
+    ForEach(pool, nsims, [&](size_t k) {
+      f[k] = -log_sum_exp(
+        nbins, [&](size_t i) { return logg_[i] - betas_[k] * energies_[i]; });
+    });
+
+    // the free energies are defined up to a constant, fix the first one
+    auto const f0 = f[0];
+    auto delta = 0.0;
+    for (auto k = 0UL; k < nsims; k++) {
+      f[k] -= f0;
+      delta = std::max(delta, std::abs(f[k] - f_[k]));
+    }
+    f_.swap(f);
+
+    if (delta < tol) {
+      return iter;
+    }
+  }
+
+  throw exception::ReweightingNotConverged();
+}
+
+inline auto
+MultiHistogramReweighting::GetLogZ(double beta) const -> double
+{
+  return log_sum_exp(energies_.size(), [&](size_t i) {
+    return logg_[i] - beta * energies_[i];
+  });
+}
+
+inline auto
+MultiHistogramReweighting::GetWeights(double beta) const -> std::vector<double>
+{
+  auto const logz = GetLogZ(beta);
+  auto w = std::vector<double>(energies_.size());
+  for (auto i = 0UL; i < energies_.size(); i++) {
+    w[i] = std::exp(logg_[i] - beta * energies_[i] - logz);
+  }
+  return w;
+}
+
+inline auto
+MultiHistogramReweighting::GetMean(double beta,
+                                   std::vector<double> const& obs) const
+  -> double
+{
+  assert(obs.size() == energies_.size());
+
+  auto w = GetWeights(beta);
+  auto acc = accumulators::NeumaierAccumulator{};
+  for (auto i = 0UL; i < w.size(); i++) {
+    if (w[i] != 0.0) {
+      acc.Add(w[i] * obs[i]);
+    }
+  }
+  return acc.Sum();
+}
+
+inline auto
+MultiHistogramReweighting::GetSpecificHeat(double beta) const -> double
+{
+  auto w = GetWeights(beta);
+  auto mean = accumulators::NeumaierAccumulator{};
+  for (auto i = 0UL; i < w.size(); i++) {
+    mean.Add(w[i] * energies_[i]);
+  }
+
+  auto var = accumulators::NeumaierAccumulator{};
+  for (auto i = 0UL; i < w.size(); i++) {
+    auto d = energies_[i] - mean.Sum();
+    var.Add(w[i] * d * d);
+  }
+  return beta * beta * var.Sum();
+}
+
+template<class Fn>
+inline auto
+MultiHistogramReweighting::Interpolate(ThreadPool& pool,
+                                       std::vector<double> const& betas,
+                                       Fn fn) const -> std::vector<double>
+{
+  auto r = std::vector<double>(betas.size());
+  ForEach(pool, betas.size(), [&](size_t j) { r[j] = fn(betas[j]); });
+  return r;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
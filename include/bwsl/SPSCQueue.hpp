@@ -0,0 +1,125 @@
+//===-- SPSCQueue.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the SPSCQueue Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Bounded lock-free queue for exactly one producer and one consumer thread.
+/// The capacity is rounded up to a power of two so that the positions can be
+/// wrapped with a mask. Neither TryPush nor TryPop ever wait.
+///
+template<typename T>
+class SPSCQueue
+{
+public:
+  /// Construct a queue holding at least @p capacity elements
+  SPSCQueue(size_t capacity);
+
+  /// Copy constructor
+  SPSCQueue(SPSCQueue const&) = delete;
+
+  /// Move constructor
+  SPSCQueue(SPSCQueue&&) = delete;
+
+  /// Copy assignment operator
+  auto operator=(SPSCQueue const&) -> SPSCQueue& = delete;
+
+  /// Move assignment operator
+  auto operator=(SPSCQueue&&) -> SPSCQueue& = delete;
+
+  /// Default destructor
+  ~SPSCQueue() = default;
+
+  /// Push an element, returns false if the queue is full (producer only)
+  auto TryPush(T&& value) -> bool;
+
+  /// Pop an element, returns false if the queue is empty (consumer only)
+  auto TryPop(T& value) -> bool;
+
+  /// Check if the queue is empty
+  [[nodiscard]] auto Empty() const -> bool
+  {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  };
+
+  /// Maximum number of elements in the queue
+  [[nodiscard]] auto Capacity() const -> size_t { return buffer_.size(); };
+
+private:
+  /// Size of a cache line, used to keep the two positions apart
+  static constexpr size_t cacheline_ = 64UL;
+
+  /// Storage for the elements
+  std::vector<T> buffer_;
+
+  /// Mask to wrap the positions
+  size_t mask_;
+
+  /// Next position to read, written by the consumer
+  alignas(cacheline_) std::atomic<size_t> head_{ 0UL };
+
+  /// Next position to write, written by the producer
+  alignas(cacheline_) std::atomic<size_t> tail_{ 0UL };
+}; // class SPSCQueue
+
+template<typename T>
+SPSCQueue<T>::SPSCQueue(size_t capacity)
+{
+  auto c = 1UL;
+  while (c < capacity) {
+    c <<= 1UL;
+  }
+  buffer_.resize(c);
+  mask_ = c - 1UL;
+}
+
+template<typename T>
+inline auto
+SPSCQueue<T>::TryPush(T&& value) -> bool
+{
+  auto tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) == buffer_.size()) {
+    return false;
+  }
+  buffer_[tail & mask_] = std::move(value);
+  tail_.store(tail + 1UL, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+inline auto
+SPSCQueue<T>::TryPop(T& value) -> bool
+{
+  auto head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  value = std::move(buffer_[head & mask_]);
+  head_.store(head + 1UL, std::memory_order_release);
+  return true;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
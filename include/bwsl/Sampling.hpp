@@ -0,0 +1,22 @@
+//===-- Sampling.hpp -------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Samplers of weighted discrete distributions
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+#include <bwsl/sampling/AliasTable.hpp>
+#include <bwsl/sampling/FenwickTree.hpp>
+#include <bwsl/sampling/KarySumTree.hpp>
+#include <bwsl/sampling/SumTree.hpp>
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
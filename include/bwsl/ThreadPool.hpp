@@ -0,0 +1,285 @@
+//===-- ThreadPool.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ThreadPool Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/ParallelUtils.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Pool of threads with work stealing.
+///
+/// Every worker owns a queue of tasks: it runs the last task of its own
+/// queue first, which keeps the data of the tasks it just spawned in its
+/// cache, and when the queue is empty it steals the first task of another
+/// queue. Tasks submitted from a worker go to its own queue, the others are
+/// dealt in turn to all the queues. Uneven tasks, like walkers whose sweeps
+/// take different times, keep every thread busy until the end.
+///
+/// The first exception thrown by a task is rethrown by Wait.
+///
+class ThreadPool
+{
+public:
+  /// Type of the tasks
+  using task_type = std::function<void()>;
+
+  /// Start @p nthreads workers
+  explicit ThreadPool(size_t nthreads = default_num_threads());
+
+  /// Copy constructor
+  ThreadPool(ThreadPool const& that) = delete;
+
+  /// Move constructor
+  ThreadPool(ThreadPool&& that) = delete;
+
+  /// Finish the tasks and stop the workers
+  ~ThreadPool();
+
+  /// Copy assignment operator
+  auto operator=(ThreadPool const& that) -> ThreadPool& = delete;
+
+  /// Move assignment operator
+  auto operator=(ThreadPool&& that) -> ThreadPool& = delete;
+
+  /// Queue a task
+  auto Submit(task_type task) -> void;
+
+  /// Wait until every task is done, rethrow the first exception thrown by
+  /// a task. Must not be called from a task
+  auto Wait() -> void;
+
+  /// Call @p fn(i) for every i in [@p first, @p last), one task for each
+  /// index, and wait for them
+  template<class Fn>
+  auto ParallelFor(size_t first, size_t last, Fn fn) -> void;
+
+  /// Number of workers
+  [[nodiscard]] auto GetNumThreads() const -> size_t
+  {
+    return workers_.size();
+  };
+
+protected:
+  /// Loop of the worker @p id
+  auto Work(size_t id) -> void;
+
+  /// Take a task for the worker @p id, from its queue or another one
+  auto Take(size_t id, task_type& task) -> bool;
+
+  /// Run a task and record its exception
+  auto Run(task_type& task) -> void;
+
+  /// Index of the worker running on this thread, or the number of workers
+  /// if the thread is not one of them
+  [[nodiscard]] auto WorkerIndex() const -> size_t
+  {
+    return current_pool_ == this ? current_index_ : workers_.size();
+  };
+
+private:
+  /// Queue of a worker
+  struct alignas(64) Queue
+  {
+    /// Protects the tasks
+    std::mutex mutex{};
+
+    /// The tasks, the owner pops from the back and thieves from the front
+    std::deque<task_type> tasks{};
+  };
+
+  /// Queues of the workers
+  std::vector<std::unique_ptr<Queue>> queues_{};
+
+  /// The workers
+  std::vector<std::thread> workers_{};
+
+  /// Protects the waits
+  std::mutex mutex_{};
+
+  /// Signals new tasks or the end of the pool
+  std::condition_variable wake_{};
+
+  /// Signals that every task is done
+  std::condition_variable done_{};
+
+  /// Tasks queued and not yet taken
+  std::atomic<size_t> queued_{ 0UL };
+
+  /// Tasks submitted and not yet done
+  size_t pending_{ 0UL };
+
+  /// Next queue of a task submitted from outside
+  size_t next_{ 0UL };
+
+  /// Check if the workers must stop
+  bool stop_{ false };
+
+  /// First exception thrown by a task
+  std::exception_ptr error_{};
+
+  /// Pool of the worker running on this thread
+  static inline thread_local ThreadPool const* current_pool_ = nullptr;
+
+  /// Index of the worker running on this thread
+  static inline thread_local size_t current_index_ = 0UL;
+}; // class ThreadPool
+
+inline ThreadPool::ThreadPool(size_t nthreads)
+{
+  nthreads = std::max(nthreads, 1UL);
+  for (auto i = 0UL; i < nthreads; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (auto i = 0UL; i < nthreads; i++) {
+    workers_.emplace_back([this, i]() { Work(i); });
+  }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    done_.wait(lock, [this]() { return pending_ == 0UL; });
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& w : workers_) {
+    w.join();
+  }
+}
+
+inline auto
+ThreadPool::Submit(task_type task) -> void
+{
+  auto id = WorkerIndex();
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    pending_++;
+    queued_++;
+    if (id == queues_.size()) {
+      id = next_;
+      next_ = (next_ + 1UL) % queues_.size();
+    }
+  }
+
+  {
+    auto& q = *queues_[id];
+    auto lock = std::lock_guard<std::mutex>(q.mutex);
+    q.tasks.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+inline auto
+ThreadPool::Take(size_t id, task_type& task) -> bool
+{
+  auto const n = queues_.size();
+  for (auto k = 0UL; k < n; k++) {
+    auto& q = *queues_[(id + k) % n];
+    auto lock = std::lock_guard<std::mutex>(q.mutex);
+    if (q.tasks.empty()) {
+      continue;
+    }
+    if (k == 0UL) {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    } else {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+    queued_--;
+    return true;
+  }
+  return false;
+}
+
+inline auto
+ThreadPool::Run(task_type& task) -> void
+{
+  try {
+    task();
+  } catch (...) {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+  }
+  task = nullptr;
+
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  if (--pending_ == 0UL) {
+    done_.notify_all();
+  }
+}
+
+inline auto
+ThreadPool::Work(size_t id) -> void
+{
+  current_pool_ = this;
+  current_index_ = id;
+  auto task = task_type{};
+  while (true) {
+    if (Take(id, task)) {
+      Run(task);
+      continue;
+    }
+
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    wake_.wait(lock, [this]() { return stop_ || queued_ > 0UL; });
+    if (stop_ && queued_ == 0UL) {
+      return;
+    }
+  }
+}
+
+inline auto
+ThreadPool::Wait() -> void
+{
+  auto lock = std::unique_lock<std::mutex>(mutex_);
+  done_.wait(lock, [this]() { return pending_ == 0UL; });
+  if (error_) {
+    auto error = std::exchange(error_, nullptr);
+    std::rethrow_exception(error);
+  }
+}
+
+template<class Fn>
+inline auto
+ThreadPool::ParallelFor(size_t first, size_t last, Fn fn) -> void
+{
+  for (auto i = first; i < last; i++) {
+    Submit([&fn, i]() { fn(i); });
+  }
+  Wait();
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,265 @@
+//===-- UniformBuffer.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the UniformBuffer Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/RNGUtils.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Source of uniform random numbers in [0, 1) drawn in blocks.
+///
+/// The buffer owns a generator with a full range of 32 or 64 bits, fills a
+/// block of raw words at once (with the Fill method of the generator if it
+/// has one, see Philox4x32) and converts the whole block to floating point
+/// in a loop which vectorizes. Drawing a number is then a load and an
+/// increment, with no distribution to construct.
+///
+/// Doubles take the upper 53 bits of 64 random bits, floats the upper 24
+/// bits of 32 or 64 random bits. Two 32 bits words, high first, make one
+/// double.
+///
+template<class Engine, typename Real = double>
+class UniformBuffer
+{
+  static_assert(std::is_floating_point<Real>::value,
+                "UniformBuffer needs a floating point type");
+  static_assert(Engine::min() == 0U &&
+                  (Engine::max() == 0xFFFFFFFFUL ||
+                   Engine::max() == 0xFFFFFFFFFFFFFFFFUL),
+                "UniformBuffer needs a generator with 32 or 64 random bits");
+
+public:
+  /// Type of the generated numbers
+  using result_type = Real;
+
+  /// Type of the generator
+  using engine_type = Engine;
+
+  /// Default size of a block
+  static constexpr size_t default_size = 1024UL;
+
+  /// Default constructor
+  UniformBuffer() = default;
+
+  /// Draw from @p engine, @p size numbers at a time, @p size must be positive
+  explicit UniformBuffer(Engine engine, size_t size = default_size);
+
+  /// Copy constructor
+  UniformBuffer(UniformBuffer const& that) = default;
+
+  /// Move constructor
+  UniformBuffer(UniformBuffer&& that) = default;
+
+  /// Default destructor
+  ~UniformBuffer() = default;
+
+  /// Copy assignment operator
+  auto operator=(UniformBuffer const& that) -> UniformBuffer& = default;
+
+  /// Move assignment operator
+  auto operator=(UniformBuffer&& that) -> UniformBuffer& = default;
+
+  /// Next number in [0, 1)
+  auto operator()() -> Real
+  {
+    if (pos_ == values_.size()) {
+      Refill();
+    }
+    return values_[pos_++];
+  };
+
+  /// Next number in [@p a, @p b)
+  auto Uniform(Real a, Real b) -> Real { return a + (b - a) * operator()(); };
+
+  /// True with probability @p prob
+  auto Accept(Real prob) -> bool { return operator()() < prob; };
+
+  /// Fill [@p first, @p first + @p n) with the next numbers
+  auto Fill(Real* first, size_t n) -> void;
+
+  /// Drop the numbers left in the buffer
+  auto Discard() -> void { pos_ = values_.size(); };
+
+  /// Number of values in the buffer not yet used
+  [[nodiscard]] auto GetAvailable() const -> size_t
+  {
+    return values_.size() - pos_;
+  };
+
+  /// Size of a block
+  [[nodiscard]] auto GetSize() const -> size_t { return size_; };
+
+  /// The generator, its state is ahead of the numbers handed out
+  [[nodiscard]] auto GetEngine() const -> Engine const& { return engine_; };
+
+protected:
+  /// Draw a new block
+  auto Refill() -> void;
+
+private:
+  /// Random bits per word of the generator
+  static constexpr unsigned bits = Engine::max() == 0xFFFFFFFFUL ? 32U : 64U;
+
+  /// Words of the generator for each number
+  static constexpr size_t words =
+    (bits == 32U && sizeof(Real) > 4UL) ? 2UL : 1UL;
+
+  /// The generator
+  Engine engine_{};
+
+  /// Size of a block
+  size_t size_{ default_size };
+
+  /// Raw words of the current block
+  std::vector<typename Engine::result_type> raw_{};
+
+  /// Numbers of the current block
+  std::vector<Real> values_{};
+
+  /// Position of the next number
+  size_t pos_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class UniformBuffer
+
+/// Check if a type is a UniformBuffer
+template<typename T>
+struct is_uniform_buffer : std::false_type
+{};
+
+/// Check if a type is a UniformBuffer
+template<class Engine, typename Real>
+struct is_uniform_buffer<UniformBuffer<Engine, Real>> : std::true_type
+{};
+
+/// Check if a generator can fill an array of raw words
+template<class Engine, typename = void>
+struct has_bulk_fill : std::false_type
+{};
+
+/// Check if a generator can fill an array of raw words
+template<class Engine>
+struct has_bulk_fill<Engine,
+                     std::void_t<decltype(std::declval<Engine&>().Fill(
+                       std::declval<typename Engine::result_type*>(),
+                       size_t{}))>> : std::true_type
+{};
+
+template<class Engine, typename Real>
+inline UniformBuffer<Engine, Real>::UniformBuffer(Engine engine, size_t size)
+  : engine_(std::move(engine))
+  , size_(size)
+{
+  if (size_ == 0UL) {
+    throw std::invalid_argument("UniformBuffer needs a positive size");
+  }
+}
+
+template<class Engine, typename Real>
+inline auto
+UniformBuffer<Engine, Real>::Refill() -> void
+{
+  raw_.resize(size_ * words);
+  if constexpr (has_bulk_fill<Engine>::value) {
+    engine_.Fill(raw_.data(), raw_.size());
+  } else {
+    for (auto& w : raw_) {
+      w = engine_();
+    }
+  }
+
+  values_.resize(size_);
+  auto const* raw = raw_.data();
+  auto* out = values_.data();
+  if constexpr (sizeof(Real) > 4UL) {
+    constexpr auto scale = Real{ 1 } / Real(std::uint64_t{ 1 } << 53U);
+    for (auto i = 0UL; i < size_; i++) {
+      auto x = std::uint64_t{};
+      if constexpr (words == 2UL) {
+        x = (std::uint64_t{ raw[2UL * i] } << 32U) |
+            static_cast<std::uint32_t>(raw[2UL * i + 1UL]);
+      } else {
+        x = static_cast<std::uint64_t>(raw[i]);
+      }
+      out[i] = static_cast<Real>(x >> 11U) * scale;
+    }
+  } else {
+    constexpr auto scale = Real{ 1 } / Real(std::uint32_t{ 1 } << 24U);
+    for (auto i = 0UL; i < size_; i++) {
+      auto x = static_cast<std::uint64_t>(raw[i]);
+      out[i] = static_cast<Real>(x >> (bits - 24U)) * scale;
+    }
+  }
+  pos_ = 0UL;
+}
+
+template<class Engine, typename Real>
+inline auto
+UniformBuffer<Engine, Real>::Fill(Real* first, size_t n) -> void
+{
+  while (n > 0UL) {
+    if (pos_ == values_.size()) {
+      Refill();
+    }
+    auto m = std::min(n, values_.size() - pos_);
+    std::copy_n(values_.data() + pos_, m, first);
+    pos_ += m;
+    first += m;
+    n -= m;
+  }
+}
+
+template<class Engine, typename Real>
+template<class Archive>
+inline auto
+UniformBuffer<Engine, Real>::serialize(Archive& ar,
+                                       const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & engine_;
+  ar & size_;
+  ar & values_;
+  ar & pos_;
+  // clang-format on
+
+  if (size_ == 0UL) {
+    throw std::invalid_argument("UniformBuffer needs a positive size");
+  }
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
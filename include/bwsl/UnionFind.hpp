@@ -0,0 +1,153 @@
+//===-- UnionFind.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the UnionFind Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+///
+/// Disjoint sets of the integers [0, n), with union by size and path
+/// compression (Tarjan, "Efficiency of a good but not linear set union
+/// algorithm", 1975).
+///
+/// Find, Unite and Reset of a range only touch the elements of the sets
+/// they reach, so ranges whose elements were only united among themselves
+/// can be worked on by different threads at the same time.
+///
+class UnionFind
+{
+public:
+  /// Default constructor
+  UnionFind() = default;
+
+  /// The sets {0}, {1}, ..., {@p n - 1}
+  explicit UnionFind(size_t n);
+
+  /// Copy constructor
+  UnionFind(UnionFind const& that) = default;
+
+  /// Move constructor
+  UnionFind(UnionFind&& that) = default;
+
+  /// Default destructor
+  ~UnionFind() = default;
+
+  /// Copy assignment operator
+  auto operator=(UnionFind const& that) -> UnionFind& = default;
+
+  /// Move assignment operator
+  auto operator=(UnionFind&& that) -> UnionFind& = default;
+
+  /// Make every element of [@p first, @p last) a set of its own
+  auto Reset(size_t first, size_t last) -> void;
+
+  /// Make every element a set of its own
+  auto Reset() -> void { Reset(0UL, parent_.size()); };
+
+  /// Representative of the set of @p i, compressing the path to it
+  auto Find(size_t i) -> size_t;
+
+  /// Representative of the set of @p i, without changing anything
+  [[nodiscard]] auto FindRoot(size_t i) const -> size_t;
+
+  /// Merge the sets of @p a and @p b, returns false if they were the same
+  auto Unite(size_t a, size_t b) -> bool;
+
+  /// Check if @p i represents its set
+  [[nodiscard]] auto IsRoot(size_t i) const -> bool
+  {
+    return parent_[i] == i;
+  };
+
+  /// Number of elements of the set represented by @p root
+  [[nodiscard]] auto GetSize(size_t root) const -> size_t
+  {
+    assert(IsRoot(root));
+    return size_[root];
+  };
+
+  /// Number of elements
+  [[nodiscard]] auto Size() const -> size_t { return parent_.size(); };
+
+private:
+  /// Parent of each element, itself for the representatives
+  std::vector<size_t> parent_{};
+
+  /// Size of the sets, valid for the representatives
+  std::vector<size_t> size_{};
+}; // class UnionFind
+
+inline UnionFind::UnionFind(size_t n)
+  : parent_(n)
+  , size_(n)
+{
+  Reset();
+}
+
+inline auto
+UnionFind::Reset(size_t first, size_t last) -> void
+{
+  assert(first <= last && last <= parent_.size());
+  for (auto i = first; i < last; i++) {
+    parent_[i] = i;
+    size_[i] = 1UL;
+  }
+}
+
+inline auto
+UnionFind::Find(size_t i) -> size_t
+{
+  auto root = FindRoot(i);
+  while (parent_[i] != root) {
+    i = std::exchange(parent_[i], root);
+  }
+  return root;
+}
+
+inline auto
+UnionFind::FindRoot(size_t i) const -> size_t
+{
+  while (parent_[i] != i) {
+    i = parent_[i];
+  }
+  return i;
+}
+
+inline auto
+UnionFind::Unite(size_t a, size_t b) -> bool
+{
+  a = Find(a);
+  b = Find(b);
+  if (a == b) {
+    return false;
+  }
+
+  // the smaller set hangs from the larger one, the trees stay shallow
+  if (size_[a] < size_[b]) {
+    std::swap(a, b);
+  }
+  parent_[b] = a;
+  size_[a] += size_[b];
+  return true;
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,400 @@
+//===-- ValueHistAccumulator.hpp -------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ValueHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/Binning.hpp>
+
+// boost
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+namespace exception {
+
+/// The binning of an adaptive histogram cannot be widened, its number of
+/// bins is odd
+class BinningCannotWiden : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The binning of the histogram cannot be widened";
+  }
+};
+
+} // namespace exception
+
+///
+/// Histogram of values which owns its binning.
+///
+/// The mapping from values to bins is given by a binning policy, see
+/// Binning.hpp. Values outside the range are counted as underflow or
+/// overflow, unless the histogram is adaptive: in this case the range is
+/// doubled, merging pairs of bins, until the value fits. Values which can
+/// never fit, like NaN, or which need a range the binning cannot reach, are
+/// counted as out of range. An adaptive histogram needs an even number of
+/// bins.
+///
+/// As for HistAccumulator the results are normalized by the total number of
+/// measurements, including the ones out of range.
+///
+template<class Binning = LinearBinning>
+class ValueHistAccumulator
+{
+public:
+  /// Default constructor
+  ValueHistAccumulator() = default;
+
+  /// Construct an histogram with the given binning
+  ValueHistAccumulator(Binning binning, bool adaptive = false);
+
+  /// Copy constructor
+  ValueHistAccumulator(ValueHistAccumulator const& that) = default;
+
+  /// Move constructor
+  ValueHistAccumulator(ValueHistAccumulator&& that) = default;
+
+  /// Default destructor
+  ~ValueHistAccumulator() = default;
+
+  /// Copy assignment operator
+  auto operator=(ValueHistAccumulator const& that)
+    -> ValueHistAccumulator& = default;
+
+  /// Move assignment operator
+  auto operator=(ValueHistAccumulator&& that)
+    -> ValueHistAccumulator& = default;
+
+  /// Reset the histogram
+  auto Reset() -> void;
+
+  /// Add a value
+  auto AddValue(double x) -> void;
+
+  /// Add a value with a weight
+  auto AddValue(double x, double w) -> void;
+
+  /// Add all the values in [@p first, @p last)
+  template<typename InputIt>
+  auto AddValues(InputIt first, InputIt last) -> void;
+
+  /// Get a single component result
+  [[nodiscard]] auto GetResult(size_t idx) const -> double;
+
+  /// Get the result of all the components
+  [[nodiscard]] auto GetResults() const -> std::vector<double>;
+
+  /// Get the results of all the components but divide by the one
+  /// given.
+  [[nodiscard]] auto GetResults(size_t idx) const -> std::vector<double>;
+
+  /// Get the number of measurements in total
+  [[nodiscard]] auto GetCount() const -> size_t { return count_; };
+
+  /// Get the count of a single bin
+  [[nodiscard]] auto GetCount(size_t idx) const -> size_t
+  {
+    return bins_[idx];
+  };
+
+  /// Number of measurements below the range
+  [[nodiscard]] auto GetUnderflow() const -> size_t { return underflow_; };
+
+  /// Number of measurements above the range
+  [[nodiscard]] auto GetOverflow() const -> size_t { return overflow_; };
+
+  /// Get the number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return bins_.size(); };
+
+  /// Edges of the bins
+  [[nodiscard]] auto GetEdges() const -> std::vector<double>
+  {
+    return binning_.GetEdges();
+  };
+
+  /// The binning
+  [[nodiscard]] auto GetBinning() const -> Binning const& { return binning_; };
+
+  /// Check if the range grows to fit the values
+  [[nodiscard]] auto IsAdaptive() const -> bool { return adaptive_; };
+
+protected:
+  /// Bin of a value, widening the range if needed, or -1 if out of range
+  auto Locate(double x) -> long;
+
+  /// Double the range and merge the bins accordingly, false if the binning
+  /// cannot be widened
+  auto Widen(bool up) -> bool;
+
+  /// Increment the count of a bin or of the under/overflow
+  auto Count(long idx) -> void;
+
+private:
+  /// The binning
+  Binning binning_{};
+
+  /// Whether the range grows to fit the values
+  bool adaptive_{ false };
+
+  /// Number of measurements in each bin
+  std::vector<std::uint64_t> bins_{};
+
+  /// Weighted sums, empty until the first weighted measurement
+  std::vector<accumulators::NeumaierAccumulator> sums_{};
+
+  /// Number of measurements below the range
+  unsigned long underflow_{ 0UL };
+
+  /// Number of measurements above the range
+  unsigned long overflow_{ 0UL };
+
+  /// Number of measurements
+  unsigned long count_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class ValueHistAccumulator
+
+template<class Binning>
+inline ValueHistAccumulator<Binning>::ValueHistAccumulator(Binning binning,
+                                                           bool adaptive)
+  : binning_(std::move(binning))
+  , adaptive_(adaptive)
+  , bins_(binning_.GetNbins(), 0UL)
+{
+  if (adaptive_ && bins_.size() % 2UL != 0UL) {
+    throw exception::BinningCannotWiden();
+  }
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::Reset() -> void
+{
+  std::fill(bins_.begin(), bins_.end(), 0UL);
+  sums_.clear();
+  underflow_ = 0UL;
+  overflow_ = 0UL;
+  count_ = 0UL;
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::Widen(bool up) -> bool
+{
+  if (!binning_.Widen(up)) {
+    return false;
+  }
+
+  // every new bin is the union of two adjacent old ones
+  auto const n = bins_.size();
+  auto const half = n / 2UL;
+  auto const shift = up ? 0UL : half;
+
+  auto bins = std::vector<std::uint64_t>(n, 0UL);
+  for (auto i = 0UL; i < n; i++) {
+    bins[shift + i / 2UL] += bins_[i];
+  }
+  bins_ = std::move(bins);
+
+  if (!sums_.empty()) {
+    auto sums = std::vector<accumulators::NeumaierAccumulator>(n);
+    for (auto i = 0UL; i < n; i++) {
+      if (sums_[i].Count() != 0UL) {
+        sums[shift + i / 2UL].Add(sums_[i].Sum());
+      }
+    }
+    sums_ = std::move(sums);
+  }
+  return true;
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::Locate(double x) -> long
+{
+  auto idx = binning_.Index(x);
+  if (!adaptive_ || !binning_.Fits(x)) {
+    return idx;
+  }
+
+  auto const n = static_cast<long>(bins_.size());
+  while (idx < 0L || idx >= n) {
+    if (!Widen(idx >= n)) {
+      // out of reach of the binning, counted as under/overflow
+      return idx;
+    }
+    idx = binning_.Index(x);
+  }
+  return idx;
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::Count(long idx) -> void
+{
+  count_++;
+  if (idx < 0L) {
+    underflow_++;
+  } else if (idx >= static_cast<long>(bins_.size())) {
+    overflow_++;
+  } else {
+    bins_[static_cast<size_t>(idx)]++;
+  }
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::AddValue(double x) -> void
+{
+  auto idx = Locate(x);
+  Count(idx);
+  if (!sums_.empty() && idx >= 0L && idx < static_cast<long>(bins_.size())) {
+    sums_[static_cast<size_t>(idx)].Add(1.0);
+  }
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::AddValue(double x, double w) -> void
+{
+  if (sums_.empty()) {
+    // switch to compensated storage seeded with the counts
+    sums_.resize(bins_.size());
+    for (auto i = 0UL; i < bins_.size(); i++) {
+      if (bins_[i] != 0UL) {
+        sums_[i].Add(static_cast<double>(bins_[i]));
+      }
+    }
+  }
+
+  auto idx = Locate(x);
+  Count(idx);
+  if (idx >= 0L && idx < static_cast<long>(bins_.size())) {
+    sums_[static_cast<size_t>(idx)].Add(w);
+  }
+}
+
+template<class Binning>
+template<typename InputIt>
+inline auto
+ValueHistAccumulator<Binning>::AddValues(InputIt first, InputIt last) -> void
+{
+  if (adaptive_ || !sums_.empty()) {
+    while (first != last) {
+      AddValue(static_cast<double>(*first++));
+    }
+    return;
+  }
+
+  // map a whole chunk first so that the loop over the binning vectorizes
+  constexpr auto chunk = 64UL;
+  auto idx = std::array<long, chunk>{};
+  auto const n = static_cast<long>(bins_.size());
+
+  while (first != last) {
+    auto m = 0UL;
+    while (m < chunk && first != last) {
+      idx[m++] = binning_.Index(static_cast<double>(*first++));
+    }
+    for (auto i = 0UL; i < m; i++) {
+      auto k = idx[i];
+      if (k >= 0L && k < n) {
+        bins_[static_cast<size_t>(k)]++;
+      } else if (k < 0L) {
+        underflow_++;
+      } else {
+        overflow_++;
+      }
+    }
+    count_ += m;
+  }
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::GetResult(size_t idx) const -> double
+{
+  if (bins_[idx] == 0UL) {
+    return 0.0;
+  }
+
+  auto sum = sums_.empty() ? static_cast<double>(bins_[idx]) : sums_[idx].Sum();
+
+  return sum / static_cast<double>(count_);
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::GetResults() const -> std::vector<double>
+{
+  auto r = std::vector<double>(bins_.size(), 0.0);
+
+  for (auto i = 0UL; i < bins_.size(); i++) {
+    r[i] = GetResult(i);
+  }
+
+  return r;
+}
+
+template<class Binning>
+inline auto
+ValueHistAccumulator<Binning>::GetResults(size_t idx) const
+  -> std::vector<double>
+{
+  auto r = GetResults();
+  auto norm = r[idx];
+  for (auto& v : r) {
+    v /= norm;
+  }
+  return r;
+}
+
+template<class Binning>
+template<class Archive>
+inline auto
+ValueHistAccumulator<Binning>::serialize(Archive& ar,
+                                         const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & binning_;
+  ar & adaptive_;
+  ar & bins_;
+  ar & sums_;
+  ar & underflow_;
+  ar & overflow_;
+  ar & count_;
+  // clang-format on
+}
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -23,13 +23,14 @@
 
 // std
 #include <limits>
+#include <type_traits>
 
 namespace bwsl::accumulators {
 
 ///
 /// Accumulator following the Kahan summation algorithm
 ///
-class KahanAccumulator
+class KahanAccumulator final
 {
 public:
   /// Default constructor
@@ -42,7 +43,7 @@ public:
   KahanAccumulator(KahanAccumulator&& that) = default;
 
   /// Default destructor
-  virtual ~KahanAccumulator() = default;
+  ~KahanAccumulator() = default;
 
   /// Copy assignment operator
   auto operator=(KahanAccumulator const& that) -> KahanAccumulator& = default;
@@ -53,6 +54,13 @@ public:
   /// Add a number to the sum
   auto Add(double x) -> void;
 
+  /// Add the @p n numbers from @p x, on a few independent lanes which the
+  /// compiler can vectorize
+  auto AddBatch(double const* x, size_t n) -> void;
+
+  /// Add the values accumulated by another accumulator
+  auto Merge(KahanAccumulator const& that) -> void;
+
   /// Return the final result
   [[nodiscard]] auto Sum() const -> double { return sum_; };
 
@@ -62,6 +70,9 @@ public:
   /// Get the number of values added
   [[nodiscard]] auto Count() const -> unsigned long { return count_; };
 
+  /// Get the running correction of the sum
+  [[nodiscard]] auto Correction() const -> double { return c_; };
+
   /// Reset the accumulator
   auto Reset() -> void;
 
@@ -98,6 +109,61 @@ KahanAccumulator::Add(double x) -> void
   count_++;
 }
 
+inline auto
+KahanAccumulator::AddBatch(double const* x, size_t n) -> void
+{
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_ > std::numeric_limits<unsigned long>::max() - n) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  constexpr auto lanes = 4UL;
+  double sum[lanes] = {};
+  double c[lanes] = {};
+  auto i = 0UL;
+  for (; i + lanes <= n; i += lanes) {
+    for (auto l = 0UL; l < lanes; l++) {
+      auto y = x[i + l] - c[l];
+      auto t = sum[l] + y;
+      c[l] = (t - sum[l]) - y;
+      sum[l] = t;
+    }
+  }
+  for (; i < n; i++) {
+    auto y = x[i] - c[0];
+    auto t = sum[0] + y;
+    c[0] = (t - sum[0]) - y;
+    sum[0] = t;
+  }
+
+  // as many merges
+  for (auto l = 0UL; l < lanes; l++) {
+    auto y = sum[l] - (c_ + c[l]);
+    auto t = sum_ + y;
+    c_ = (t - sum_) - y;
+    sum_ = t;
+  }
+  count_ += n;
+}
+
+inline auto
+KahanAccumulator::Merge(KahanAccumulator const& that) -> void
+{
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_ > std::numeric_limits<unsigned long>::max() - that.count_) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  // both sums are short of their corrections
+  auto y = that.sum_ - (c_ + that.c_);
+  auto t = sum_ + y;
+  c_ = (t - sum_) - y;
+  sum_ = t;
+  count_ += that.count_;
+}
+
 inline auto
 KahanAccumulator::Reset() -> void
 {
@@ -117,6 +183,10 @@ KahanAccumulator::serialize(Archive& ar, const unsigned int /* version */)
   // clang-format on
 }
 
+static_assert(sizeof(KahanAccumulator) ==
+              2UL * sizeof(double) + sizeof(unsigned long));
+static_assert(std::is_trivially_copyable<KahanAccumulator>::value);
+
 } // namespace bwsl::accumulators
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,200 @@
+//===-- KahanAccumulatorArray.hpp ------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the KahanAccumulatorArray Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/accumulators/AccumulatorsExceptions.hpp>
+#include <bwsl/accumulators/KahanAccumulator.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace bwsl::accumulators {
+
+///
+/// Fixed number of Kahan accumulators stored as a structure of arrays.
+/// Each component behaves like a KahanAccumulator but the sums, the
+/// corrections and the counts live in three contiguous vectors so that
+/// iterating over all the components touches only the memory it needs.
+///
+class KahanAccumulatorArray final
+{
+public:
+  /// Default constructor
+  KahanAccumulatorArray() = default;
+
+  /// Construct an array of @p n accumulators
+  KahanAccumulatorArray(size_t n);
+
+  /// Copy constructor
+  KahanAccumulatorArray(KahanAccumulatorArray const& that) = default;
+
+  /// Move constructor
+  KahanAccumulatorArray(KahanAccumulatorArray&& that) = default;
+
+  /// Default destructor
+  ~KahanAccumulatorArray() = default;
+
+  /// Copy assignment operator
+  auto operator=(KahanAccumulatorArray const& that)
+    -> KahanAccumulatorArray& = default;
+
+  /// Move assignment operator
+  auto operator=(KahanAccumulatorArray&& that)
+    -> KahanAccumulatorArray& = default;
+
+  /// Change the number of accumulators, new ones start empty
+  auto Resize(size_t n) -> void;
+
+  /// Insert an empty accumulator before position @p pos
+  auto Insert(size_t pos) -> void;
+
+  /// Number of accumulators
+  [[nodiscard]] auto Size() const -> size_t { return sum_.size(); };
+
+  /// Add a number to the sum of the @p i -th accumulator
+  auto Add(size_t i, double x) -> void;
+
+  /// Sum of the @p i -th accumulator
+  [[nodiscard]] auto Sum(size_t i) const -> double { return sum_[i]; };
+
+  /// Average of the @p i -th accumulator
+  [[nodiscard]] auto Mean(size_t i) const -> double
+  {
+    return sum_[i] / count_[i];
+  };
+
+  /// Number of values added to the @p i -th accumulator
+  [[nodiscard]] auto Count(size_t i) const -> unsigned long
+  {
+    return count_[i];
+  };
+
+  /// Replace the @p i -th accumulator with a copy of @p acc
+  auto Assign(size_t i, KahanAccumulator const& acc) -> void;
+
+  /// Reset the @p i -th accumulator
+  auto Reset(size_t i) -> void;
+
+  /// Reset all the accumulators
+  auto Reset() -> void;
+
+protected:
+private:
+  /// Accumulators for the sums
+  std::vector<double> sum_{};
+
+  /// Corrections of the sums
+  std::vector<double> c_{};
+
+  /// Number of values added
+  std::vector<unsigned long> count_{};
+
+  friend class boost::serialization::access;
+
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class KahanAccumulatorArray
+
+inline KahanAccumulatorArray::KahanAccumulatorArray(size_t n)
+  : sum_(n, 0.0)
+  , c_(n, 0.0)
+  , count_(n, 0UL)
+{
+}
+
+inline auto
+KahanAccumulatorArray::Resize(size_t n) -> void
+{
+  sum_.resize(n, 0.0);
+  c_.resize(n, 0.0);
+  count_.resize(n, 0UL);
+}
+
+inline auto
+KahanAccumulatorArray::Insert(size_t pos) -> void
+{
+  assert(pos <= Size());
+  sum_.insert(sum_.begin() + pos, 0.0);
+  c_.insert(c_.begin() + pos, 0.0);
+  count_.insert(count_.begin() + pos, 0UL);
+}
+
+inline auto
+KahanAccumulatorArray::Add(size_t i, double x) -> void
+{
+  assert(i < Size());
+
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_[i] == std::numeric_limits<unsigned long>::max()) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  auto y = x - c_[i];
+  auto t = sum_[i] + y;
+  c_[i] = (t - sum_[i]) - y;
+  sum_[i] = t;
+  count_[i]++;
+}
+
+inline auto
+KahanAccumulatorArray::Assign(size_t i, KahanAccumulator const& acc) -> void
+{
+  assert(i < Size());
+  sum_[i] = acc.Sum();
+  c_[i] = acc.Correction();
+  count_[i] = acc.Count();
+}
+
+inline auto
+KahanAccumulatorArray::Reset(size_t i) -> void
+{
+  sum_[i] = 0.0;
+  c_[i] = 0.0;
+  count_[i] = 0UL;
+}
+
+inline auto
+KahanAccumulatorArray::Reset() -> void
+{
+  std::fill(sum_.begin(), sum_.end(), 0.0);
+  std::fill(c_.begin(), c_.end(), 0.0);
+  std::fill(count_.begin(), count_.end(), 0UL);
+}
+
+template<class Archive>
+void
+KahanAccumulatorArray::serialize(Archive& ar, const unsigned int /* version */)
+{
+  // clang-format off
+  ar & sum_;
+  ar & c_;
+  ar & count_;
+  // clang-format on
+}
+
+} // namespace bwsl::accumulators
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
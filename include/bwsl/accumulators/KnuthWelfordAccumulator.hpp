@@ -25,13 +25,14 @@
 #include <cmath>
 #include <exception>
 #include <limits>
+#include <type_traits>
 
 namespace bwsl::accumulators {
 
 ///
 /// Accumulator using KnuthWelford algorithm
 ///
-class KnuthWelfordAccumulator
+class KnuthWelfordAccumulator final
 {
 public:
   /// Default constructor
@@ -44,7 +45,7 @@ public:
   KnuthWelfordAccumulator(KnuthWelfordAccumulator&& that) = default;
 
   /// Default destructor
-  virtual ~KnuthWelfordAccumulator() = default;
+  ~KnuthWelfordAccumulator() = default;
 
   /// Copy assignment operator
   auto operator=(KnuthWelfordAccumulator const& that)
@@ -57,6 +58,9 @@ public:
   /// Add a measurement with unit weight
   auto Add(double m) -> void;
 
+  /// Add the measurements of another accumulator (Chan et al.)
+  auto Merge(KnuthWelfordAccumulator const& that) -> void;
+
   /// Sum of the accumulated values
   [[nodiscard]] auto Sum() const -> double { return mean_ * Count(); };
 
@@ -118,6 +122,27 @@ KnuthWelfordAccumulator::Add(double x) -> void
   m2_ += delta * delta2;
 }
 
+inline auto
+KnuthWelfordAccumulator::Merge(KnuthWelfordAccumulator const& that) -> void
+{
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_ > std::numeric_limits<unsigned long>::max() - that.count_) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  if (that.count_ == 0UL) {
+    return;
+  }
+
+  auto const n = static_cast<double>(count_ + that.count_);
+  auto const delta = that.mean_ - mean_;
+  auto const w = static_cast<double>(that.count_) / n;
+  mean_ += delta * w;
+  m2_ += that.m2_ + delta * delta * static_cast<double>(count_) * w;
+  count_ += that.count_;
+}
+
 inline auto
 KnuthWelfordAccumulator::Variance(bool corrected) const -> double
 {
@@ -172,6 +197,10 @@ KnuthWelfordAccumulator::serialize(Archive& ar,
   // clang-format on
 }
 
+static_assert(sizeof(KnuthWelfordAccumulator) ==
+              2UL * sizeof(double) + sizeof(unsigned long));
+static_assert(std::is_trivially_copyable<KnuthWelfordAccumulator>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -25,13 +25,14 @@
 #include <cmath>
 #include <exception>
 #include <limits>
+#include <type_traits>
 
 namespace bwsl {
 
 ///
 /// Accumulator using KnuthWelford algorithm
 ///
-class NaiveInteger
+class NaiveInteger final
 {
 public:
   /// Default constructor
@@ -44,7 +45,7 @@ public:
   NaiveInteger(NaiveInteger&& that) = default;
 
   /// Default destructor
-  virtual ~NaiveInteger() = default;
+  ~NaiveInteger() = default;
 
   /// Copy assignment operator
   auto operator=(NaiveInteger const& that) -> NaiveInteger& = default;
@@ -167,6 +168,10 @@ NaiveInteger::serialize(Archive& ar, const unsigned int /* version */)
   // clang-format on
 }
 
+static_assert(sizeof(NaiveInteger) ==
+              2UL * sizeof(long) + sizeof(unsigned long));
+static_assert(std::is_trivially_copyable<NaiveInteger>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -23,13 +23,14 @@
 
 // std
 #include <limits>
+#include <type_traits>
 
 namespace bwsl::accumulators {
 
 ///
 /// Accumulator following the Neumaier summation algorithm
 ///
-class NeumaierAccumulator
+class NeumaierAccumulator final
 {
 public:
   /// Default constructor
@@ -42,7 +43,7 @@ public:
   NeumaierAccumulator(NeumaierAccumulator&& that) = default;
 
   /// Default destructor
-  virtual ~NeumaierAccumulator() = default;
+  ~NeumaierAccumulator() = default;
 
   /// Copy assignment operator
   auto operator=(NeumaierAccumulator const& that)
@@ -54,6 +55,9 @@ public:
   /// Add a number to the sum
   auto Add(double x) -> void;
 
+  /// Add the values accumulated by another accumulator
+  auto Merge(NeumaierAccumulator const& that) -> void;
+
   /// Sum of the accumulated values
   [[nodiscard]] auto Sum() const -> double { return sum_ + c_; };
 
@@ -103,6 +107,27 @@ NeumaierAccumulator::Add(double x) -> void
   count_++;
 }
 
+inline auto
+NeumaierAccumulator::Merge(NeumaierAccumulator const& that) -> void
+{
+#ifdef BWSL_ACCUMULATORS_CHECKS
+  if (count_ > std::numeric_limits<unsigned long>::max() - that.count_) {
+    throw exception::AccumulatorOverflow();
+  }
+#endif // BWSL_ACCUMULATORS_CHECKS
+
+  auto x = that.sum_;
+  auto t = sum_ + x;
+  if (std::abs(sum_) >= std::abs(x)) {
+    c_ += (sum_ - t) + x;
+  } else {
+    c_ += (x - t) + sum_;
+  }
+  sum_ = t;
+  c_ += that.c_;
+  count_ += that.count_;
+}
+
 inline auto
 NeumaierAccumulator::Reset() -> void
 {
@@ -122,6 +147,10 @@ NeumaierAccumulator::serialize(Archive& ar, const unsigned int /* version */)
   // clang-format on
 }
 
+static_assert(sizeof(NeumaierAccumulator) ==
+              2UL * sizeof(double) + sizeof(unsigned long));
+static_assert(std::is_trivially_copyable<NeumaierAccumulator>::value);
+
 } // namespace bwsl::accumulators
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
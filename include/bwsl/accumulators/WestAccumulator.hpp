@@ -25,6 +25,7 @@
 #include <cmath>
 #include <exception>
 #include <limits>
+#include <type_traits>
 
 namespace bwsl::accumulators {
 
@@ -32,7 +33,7 @@ namespace bwsl::accumulators {
 /// Accumulator using West algorithm.
 /// It computed weighted mean and variance.
 ///
-class WestAccumulator
+class WestAccumulator final
 {
 public:
   /// Default constructor
@@ -45,7 +46,7 @@ public:
   WestAccumulator(WestAccumulator&& that) = default;
 
   /// Default destructor
-  virtual ~WestAccumulator() = default;
+  ~WestAccumulator() = default;
 
   /// Copy assignment operator
   auto operator=(WestAccumulator const& that) -> WestAccumulator& = default;
@@ -178,6 +179,10 @@ WestAccumulator::serialize(Archive& ar, const unsigned int /* version */)
   // clang-format on
 }
 
+static_assert(sizeof(WestAccumulator) ==
+              4UL * sizeof(double) + sizeof(unsigned long));
+static_assert(std::is_trivially_copyable<WestAccumulator>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
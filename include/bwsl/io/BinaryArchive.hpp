@@ -0,0 +1,513 @@
+//===-- BinaryArchive.hpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Lightweight binary archives for checkpoints
+///
+/// The archives understand the same serialize methods written for Boost, so
+/// every class of the library can be saved with them, but they write values
+/// as raw bytes in the byte order of the machine:
+///
+///     header:  "BWSLARC1"  u8 byteorder  u8 version  u16 zero
+///     values:  arithmetic types as raw bytes
+///              containers as u64 size followed by the elements, contiguous
+///              arithmetic elements in a single block
+///              Mersenne Twisters as u8 layout of the standard library,
+///              their n state words, in 32 or 64 bits depending on the word
+///              size of the engine, and u64 position, or as the string
+///              written by operator<< when the layout is unknown
+///
+/// Class versions are not stored, serialize methods always receive the
+/// current version of the class: a binary archive is meant to be read by
+/// the same build that wrote it. The version of the format changes with the
+/// layout of any class, so older archives are refused instead of misread.
+/// Pointers and polymorphic types are not supported.
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/RNGUtils.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+namespace exception {
+
+/// A binary archive cannot be read or written
+class BinaryArchiveError : public std::exception
+{
+public:
+  BinaryArchiveError(std::string const& reason)
+    : message_(fmt::format("Binary archive: {}", reason))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class BinaryArchiveError
+
+} // namespace exception
+
+namespace io {
+
+namespace archive {
+
+/// Magic string at the beginning of an archive
+constexpr char magic[] = "BWSLARC1";
+
+/// Version of the format
+constexpr std::uint8_t version = 3U;
+
+/// Tag for little endian archives
+constexpr std::uint8_t little_endian = 1U;
+
+/// Tag for big endian archives
+constexpr std::uint8_t big_endian = 2U;
+
+/// Byte order of the machine
+inline auto
+host_byteorder() -> std::uint8_t
+{
+  auto one = std::uint16_t{ 1U };
+  auto first = std::uint8_t{};
+  std::memcpy(&first, &one, 1UL);
+  return first == 1U ? little_endian : big_endian;
+}
+
+/// Reverse the bytes of @p n values of type T
+template<typename T>
+inline auto
+byteswap(T* data, size_t n) -> void
+{
+  auto* p = reinterpret_cast<unsigned char*>(data);
+  for (auto i = 0UL; i < n; i++, p += sizeof(T)) {
+    for (auto j = 0UL; j < sizeof(T) / 2UL; j++) {
+      std::swap(p[j], p[sizeof(T) - 1UL - j]);
+    }
+  }
+}
+
+/// Check if a type is a std::vector
+template<typename T>
+struct is_vector : std::false_type
+{};
+
+/// Check if a type is a std::vector
+template<typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type
+{};
+
+/// Check if a type is a std::array
+template<typename T>
+struct is_array : std::false_type
+{};
+
+/// Check if a type is a std::array
+template<typename T, size_t N>
+struct is_array<std::array<T, N>> : std::true_type
+{};
+
+/// Check if a type is a std::pair
+template<typename T>
+struct is_pair : std::false_type
+{};
+
+/// Check if a type is a std::pair
+template<typename T, typename U>
+struct is_pair<std::pair<T, U>> : std::true_type
+{};
+
+/// Check if a type is a std::map or a std::unordered_map
+template<typename T>
+struct is_map : std::false_type
+{};
+
+/// Check if a type is a std::map or a std::unordered_map
+template<typename K, typename V, typename C, typename A>
+struct is_map<std::map<K, V, C, A>> : std::true_type
+{};
+
+/// Check if a type is a std::map or a std::unordered_map
+template<typename K, typename V, typename H, typename E, typename A>
+struct is_map<std::unordered_map<K, V, H, E, A>> : std::true_type
+{};
+
+/// Values which are written as their raw bytes
+template<typename T>
+constexpr bool is_raw =
+  std::is_arithmetic<T>::value || std::is_enum<T>::value;
+
+} // namespace archive
+
+///
+/// Binary output archive
+///
+class BinaryOArchive
+{
+public:
+  /// Boost archive traits
+  using is_saving = std::true_type;
+
+  /// Boost archive traits
+  using is_loading = std::false_type;
+
+  /// Write the header to @p out
+  BinaryOArchive(std::ostream& out);
+
+  /// Save a value
+  template<typename T>
+  auto operator<<(T const& x) -> BinaryOArchive&
+  {
+    Save(x);
+    return *this;
+  }
+
+  /// Save a value
+  template<typename T>
+  auto operator&(T const& x) -> BinaryOArchive&
+  {
+    Save(x);
+    return *this;
+  }
+
+  /// Number of bytes written so far
+  [[nodiscard]] auto GetSize() const -> size_t { return size_; };
+
+protected:
+  /// Write raw bytes
+  auto Write(void const* data, size_t size) -> void;
+
+  /// Save any supported value
+  template<typename T>
+  auto Save(T const& x) -> void;
+
+private:
+  /// The output stream
+  std::ostream& out_;
+
+  /// Number of bytes written
+  size_t size_{ 0UL };
+}; // class BinaryOArchive
+
+///
+/// Binary input archive
+///
+class BinaryIArchive
+{
+public:
+  /// Boost archive traits
+  using is_saving = std::false_type;
+
+  /// Boost archive traits
+  using is_loading = std::true_type;
+
+  /// Read and check the header from @p in
+  BinaryIArchive(std::istream& in);
+
+  /// Load a value
+  template<typename T>
+  auto operator>>(T& x) -> BinaryIArchive&
+  {
+    Load(x);
+    return *this;
+  }
+
+  /// Load a value
+  template<typename T>
+  auto operator&(T& x) -> BinaryIArchive&
+  {
+    Load(x);
+    return *this;
+  }
+
+  /// Check if the archive was written with a different byte order
+  [[nodiscard]] auto IsSwapped() const -> bool { return swap_; };
+
+protected:
+  /// Read raw bytes
+  auto Read(void* data, size_t size) -> void;
+
+  /// Read @p n raw values of type T, fixing the byte order
+  template<typename T>
+  auto ReadValues(T* data, size_t n) -> void;
+
+  /// Read the size of a container whose elements take at least @p bytes
+  auto ReadSize(size_t bytes = 0UL) -> size_t;
+
+  /// Number of bytes left in the archive, the largest size if unknown
+  auto GetRemaining() -> size_t;
+
+  /// Load any supported value
+  template<typename T>
+  auto Load(T& x) -> void;
+
+private:
+  /// The input stream
+  std::istream& in_;
+
+  /// Whether the archive was written with a different byte order
+  bool swap_{ false };
+
+  /// End of the stream, negative if the stream cannot be seeked
+  std::streamoff end_{ -1 };
+}; // class BinaryIArchive
+
+inline BinaryOArchive::BinaryOArchive(std::ostream& out)
+  : out_(out)
+{
+  auto header = std::array<char, 12>{};
+  std::memcpy(header.data(), archive::magic, 8UL);
+  header[8] = static_cast<char>(archive::host_byteorder());
+  header[9] = static_cast<char>(archive::version);
+  Write(header.data(), header.size());
+}
+
+inline auto
+BinaryOArchive::Write(void const* data, size_t size) -> void
+{
+  out_.write(static_cast<char const*>(data),
+             static_cast<std::streamsize>(size));
+  if (!out_) {
+    throw exception::BinaryArchiveError("write failed");
+  }
+  size_ += size;
+}
+
+template<typename T>
+inline auto
+BinaryOArchive::Save(T const& x) -> void
+{
+  static_assert(!std::is_pointer<T>::value, "Pointers are not supported");
+
+  if constexpr (archive::is_raw<T>) {
+    Write(&x, sizeof(T));
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    Save(static_cast<std::uint64_t>(x.size()));
+    Write(x.data(), x.size());
+  } else if constexpr (archive::is_vector<T>::value) {
+    using value_t = typename T::value_type;
+    Save(static_cast<std::uint64_t>(x.size()));
+    if constexpr (archive::is_raw<value_t> &&
+                  !std::is_same<value_t, bool>::value) {
+      Write(x.data(), x.size() * sizeof(value_t));
+    } else {
+      for (auto const& v : x) {
+        Save(static_cast<value_t const&>(v));
+      }
+    }
+  } else if constexpr (archive::is_array<T>::value) {
+    for (auto const& v : x) {
+      Save(v);
+    }
+  } else if constexpr (archive::is_pair<T>::value) {
+    Save(x.first);
+    Save(x.second);
+  } else if constexpr (archive::is_map<T>::value) {
+    Save(static_cast<std::uint64_t>(x.size()));
+    for (auto const& [k, v] : x) {
+      Save(k);
+      Save(v);
+    }
+  } else if constexpr (is_mersenne_twister<T>::value) {
+    if constexpr (!has_raw_state<T>::value) {
+      Save(static_cast<std::uint8_t>(MersenneTwisterLayout::Unknown));
+      Save(get_text(x));
+    } else {
+      using word_t = mersenne_twister_word_t<T::word_size>;
+      auto state = get_state(x);
+      auto words = std::array<word_t, T::state_size>{};
+      std::copy(std::begin(state.words), std::end(state.words), words.begin());
+      Save(static_cast<std::uint8_t>(mersenne_twister_layout));
+      Write(words.data(), sizeof(words));
+      Save(static_cast<std::uint64_t>(state.pos));
+    }
+  } else {
+    // the serialize methods are the same for saving and loading
+    boost::serialization::serialize_adl(
+      *this, const_cast<T&>(x), boost::serialization::version<T>::value);
+  }
+}
+
+inline BinaryIArchive::BinaryIArchive(std::istream& in)
+  : in_(in)
+{
+  auto header = std::array<char, 12>{};
+  Read(header.data(), header.size());
+  if (std::memcmp(header.data(), archive::magic, 8UL) != 0) {
+    throw exception::BinaryArchiveError("not a binary archive");
+  }
+
+  auto byteorder = static_cast<std::uint8_t>(header[8]);
+  auto version = static_cast<std::uint8_t>(header[9]);
+  if (byteorder != archive::little_endian &&
+      byteorder != archive::big_endian) {
+    throw exception::BinaryArchiveError("unknown byte order");
+  }
+  if (version != archive::version) {
+    throw exception::BinaryArchiveError(
+      fmt::format("unsupported version {}", version));
+  }
+  swap_ = byteorder != archive::host_byteorder();
+
+  auto here = in_.tellg();
+  if (here != std::streampos(-1)) {
+    in_.seekg(0, std::ios::end);
+    end_ = in_ ? static_cast<std::streamoff>(in_.tellg()) : -1;
+    in_.clear();
+    in_.seekg(here);
+  }
+}
+
+inline auto
+BinaryIArchive::Read(void* data, size_t size) -> void
+{
+  in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+  if (!in_) {
+    throw exception::BinaryArchiveError("unexpected end of the archive");
+  }
+}
+
+template<typename T>
+inline auto
+BinaryIArchive::ReadValues(T* data, size_t n) -> void
+{
+  Read(data, n * sizeof(T));
+  if (swap_) {
+    archive::byteswap(data, n);
+  }
+}
+
+inline auto
+BinaryIArchive::ReadSize(size_t bytes) -> size_t
+{
+  auto n = std::uint64_t{};
+  ReadValues(&n, 1UL);
+  // a corrupted size must not turn into a huge allocation
+  if (bytes > 0UL && n > GetRemaining() / bytes) {
+    throw exception::BinaryArchiveError(
+      fmt::format("size {} past the end of the archive", n));
+  }
+  return static_cast<size_t>(n);
+}
+
+inline auto
+BinaryIArchive::GetRemaining() -> size_t
+{
+  auto here = in_.tellg();
+  if (end_ < 0 || here == std::streampos(-1)) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return static_cast<size_t>(end_ - static_cast<std::streamoff>(here));
+}
+
+template<typename T>
+inline auto
+BinaryIArchive::Load(T& x) -> void
+{
+  static_assert(!std::is_pointer<T>::value, "Pointers are not supported");
+
+  if constexpr (archive::is_raw<T>) {
+    ReadValues(&x, 1UL);
+  } else if constexpr (std::is_same<T, std::string>::value) {
+    x.resize(ReadSize(1UL));
+    Read(x.data(), x.size());
+  } else if constexpr (archive::is_vector<T>::value) {
+    using value_t = typename T::value_type;
+    if constexpr (archive::is_raw<value_t> &&
+                  !std::is_same<value_t, bool>::value) {
+      auto n = ReadSize(sizeof(value_t));
+      x.resize(n);
+      ReadValues(x.data(), n);
+    } else {
+      auto n = ReadSize();
+      x.clear();
+      x.reserve(std::min(n, GetRemaining()));
+      for (auto i = 0UL; i < n; i++) {
+        auto v = value_t{};
+        Load(v);
+        x.push_back(std::move(v));
+      }
+    }
+  } else if constexpr (archive::is_array<T>::value) {
+    for (auto& v : x) {
+      Load(v);
+    }
+  } else if constexpr (archive::is_pair<T>::value) {
+    Load(x.first);
+    Load(x.second);
+  } else if constexpr (archive::is_map<T>::value) {
+    auto n = ReadSize();
+    x.clear();
+    for (auto i = 0UL; i < n; i++) {
+      auto k = typename T::key_type{};
+      auto v = typename T::mapped_type{};
+      Load(k);
+      Load(v);
+      x.emplace(std::move(k), std::move(v));
+    }
+  } else if constexpr (is_mersenne_twister<T>::value) {
+    auto layout = std::uint8_t{};
+    Load(layout);
+    if (layout == static_cast<std::uint8_t>(MersenneTwisterLayout::Unknown)) {
+      auto text = std::string{};
+      Load(text);
+      set_text(x, text);
+    } else if constexpr (!has_raw_state<T>::value) {
+      throw exception::BinaryArchiveError(
+        "Mersenne Twister saved by another standard library");
+    } else {
+      using word_t = mersenne_twister_word_t<T::word_size>;
+      auto words = std::array<word_t, T::state_size>{};
+      ReadValues(words.data(), words.size());
+      auto state = decltype(get_state(x)){};
+      std::copy(words.begin(), words.end(), std::begin(state.words));
+      state.pos = ReadSize();
+      set_state(x, state, static_cast<MersenneTwisterLayout>(layout));
+    }
+  } else {
+    boost::serialization::serialize_adl(
+      *this, x, boost::serialization::version<T>::value);
+  }
+}
+
+} // namespace io
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,383 @@
+//===-- CheckpointManager.hpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Coordinated checkpoints of the whole state of a simulation
+///
+/// A checkpoint is a single binary archive:
+///
+///     header:     as BinaryOArchive
+///     u64         number of components
+///     components: string name, string payload (a BinaryOArchive of the
+///                 component, with its own header)
+///     u64         checksum of all the previous bytes
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/io/BinaryArchive.hpp>
+#include <bwsl/io/Checksum.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bwsl {
+
+namespace exception {
+
+/// A checkpoint cannot be written or restored
+class CheckpointError : public std::exception
+{
+public:
+  CheckpointError(std::string const& fname, std::string const& reason)
+    : message_(fmt::format("Checkpoint {}: {}", fname, reason))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class CheckpointError
+
+} // namespace exception
+
+namespace io {
+
+///
+/// Saves and restores together all the components of a simulation.
+///
+/// Components are registered by reference with a unique name, and each one
+/// is saved with its serialize method in a BinaryOArchive. A checkpoint is
+/// written to a temporary file next to the target, synced to the disk and
+/// renamed over the previous one, then the directory is synced so that the
+/// rename survives too. A crash at any time leaves either the old or the
+/// new checkpoint, never a torn one; the trailing checksum catches the
+/// corruptions the rename cannot.
+///
+/// SaveAsync takes the snapshot, serializing the components in memory, in
+/// the calling thread and leaves the writing to a background thread: the
+/// simulation can change the components as soon as it returns, and only
+/// waits for the copy in memory, not for the disk.
+///
+/// Components saved in large objects built once, like the neighbors of a
+/// Lattice, are restored as they are and never recomputed.
+///
+class CheckpointManager
+{
+public:
+  /// Manage the checkpoints in the file @p fname
+  explicit CheckpointManager(std::string fname);
+
+  /// Copy constructor
+  CheckpointManager(CheckpointManager const&) = delete;
+
+  /// Move constructor
+  CheckpointManager(CheckpointManager&&) = delete;
+
+  /// Copy assignment operator
+  auto operator=(CheckpointManager const&) -> CheckpointManager& = delete;
+
+  /// Move assignment operator
+  auto operator=(CheckpointManager&&) -> CheckpointManager& = delete;
+
+  /// Wait for the last checkpoint to be written
+  ~CheckpointManager();
+
+  /// Save and restore @p component under the name @p name
+  template<class T>
+  auto Register(std::string name, T& component) -> void;
+
+  /// Write a checkpoint and wait for it
+  auto Save() -> void;
+
+  /// Take a snapshot of the components and write it in the background
+  auto SaveAsync() -> void;
+
+  /// Wait for the checkpoint being written, rethrow its error if any
+  auto Wait() -> void;
+
+  /// Restore all the components, returns false if there is no checkpoint
+  auto Load() -> bool;
+
+  /// Check if a checkpoint exists
+  [[nodiscard]] auto Exists() const -> bool
+  {
+    return std::filesystem::exists(fname_);
+  };
+
+  /// Name of the file
+  [[nodiscard]] auto GetFileName() const -> std::string const&
+  {
+    return fname_;
+  };
+
+  /// Number of registered components
+  [[nodiscard]] auto GetSize() const -> size_t { return components_.size(); };
+
+protected:
+  /// Serialize all the components
+  [[nodiscard]] auto Snapshot() const -> std::string;
+
+  /// Write a snapshot to the file, atomically
+  auto Write(std::string const& data) const -> void;
+
+  /// Throw a CheckpointError
+  [[noreturn]] auto Fail(std::string const& reason) const -> void
+  {
+    throw exception::CheckpointError(fname_, reason);
+  };
+
+private:
+  /// A registered component
+  struct Component
+  {
+    /// Name of the component
+    std::string name{};
+
+    /// Save the component
+    std::function<void(BinaryOArchive&)> save{};
+
+    /// Restore the component
+    std::function<void(BinaryIArchive&)> load{};
+  };
+
+  /// Name of the file
+  std::string fname_;
+
+  /// The components
+  std::vector<Component> components_{};
+
+  /// Background writer
+  std::thread writer_{};
+
+  /// Error of the background writer
+  std::exception_ptr error_{};
+}; // class CheckpointManager
+
+inline CheckpointManager::CheckpointManager(std::string fname)
+  : fname_(std::move(fname))
+{
+}
+
+inline CheckpointManager::~CheckpointManager()
+{
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+template<class T>
+inline auto
+CheckpointManager::Register(std::string name, T& component) -> void
+{
+  auto same = [&name](Component const& c) { return c.name == name; };
+  if (std::any_of(components_.begin(), components_.end(), same)) {
+    Fail(fmt::format("{} registered twice", name));
+  }
+
+  auto c = Component{};
+  c.name = std::move(name);
+  c.save = [&component](BinaryOArchive& oa) { oa << component; };
+  c.load = [&component](BinaryIArchive& ia) { ia >> component; };
+  components_.push_back(std::move(c));
+}
+
+inline auto
+CheckpointManager::Snapshot() const -> std::string
+{
+  auto out = std::ostringstream{};
+  {
+    auto oa = BinaryOArchive(out);
+    oa << static_cast<std::uint64_t>(components_.size());
+    for (auto const& c : components_) {
+      auto payload = std::ostringstream{};
+      auto poa = BinaryOArchive(payload);
+      c.save(poa);
+      oa << c.name;
+      oa << payload.str();
+    }
+  }
+
+  auto data = std::move(out).str();
+  auto sum = checksum(data.data(), data.size());
+  data.append(reinterpret_cast<char const*>(&sum), sizeof(sum));
+  return data;
+}
+
+inline auto
+CheckpointManager::Write(std::string const& data) const -> void
+{
+  auto tmp = fname_ + ".tmp";
+  {
+    auto out = std::ofstream(tmp, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (!out) {
+      Fail(fmt::format("cannot write {}", tmp));
+    }
+  }
+
+#if __has_include(<unistd.h>)
+  // the data must reach the disk before the rename does
+  auto fd = ::open(tmp.c_str(), O_RDONLY);
+  if (fd < 0 || ::fsync(fd) != 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    Fail(fmt::format("cannot sync {}", tmp));
+  }
+  ::close(fd);
+#endif
+
+  auto ec = std::error_code{};
+  std::filesystem::rename(tmp, fname_, ec);
+  if (ec) {
+    Fail(fmt::format("cannot rename {}: {}", tmp, ec.message()));
+  }
+
+#if __has_include(<unistd.h>)
+  // the rename itself is durable only once the directory reaches the disk
+  auto dir = std::filesystem::absolute(fname_).parent_path();
+  auto dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dfd < 0 || ::fsync(dfd) != 0) {
+    if (dfd >= 0) {
+      ::close(dfd);
+    }
+    Fail(fmt::format("cannot sync {}", dir.string()));
+  }
+  ::close(dfd);
+#endif
+}
+
+inline auto
+CheckpointManager::Save() -> void
+{
+  Wait();
+  Write(Snapshot());
+}
+
+inline auto
+CheckpointManager::SaveAsync() -> void
+{
+  Wait();
+  writer_ = std::thread([this, data = Snapshot()]() {
+    try {
+      Write(data);
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+  });
+}
+
+inline auto
+CheckpointManager::Wait() -> void
+{
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  if (error_) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+inline auto
+CheckpointManager::Load() -> bool
+{
+  Wait();
+  if (!Exists()) {
+    return false;
+  }
+
+  auto data = std::string{};
+  {
+    auto in = std::ifstream(fname_, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+  }
+
+  auto sum = std::uint64_t{};
+  if (data.size() < sizeof(sum)) {
+    Fail("truncated file");
+  }
+  auto size = data.size() - sizeof(sum);
+  std::memcpy(&sum, data.data() + size, sizeof(sum));
+  data.resize(size);
+
+  try {
+    auto in = std::istringstream(data);
+    auto ia = BinaryIArchive(in);
+    if (ia.IsSwapped()) {
+      archive::byteswap(&sum, 1UL);
+    }
+    if (sum != checksum(data.data(), data.size())) {
+      Fail("wrong checksum");
+    }
+
+    // components are matched by name, extra ones in the file are ignored
+    auto n = std::uint64_t{};
+    ia >> n;
+    auto restored = std::vector<bool>(components_.size(), false);
+    for (auto i = 0UL; i < n; i++) {
+      auto name = std::string{};
+      auto payload = std::string{};
+      ia >> name;
+      ia >> payload;
+
+      for (auto k = 0UL; k < components_.size(); k++) {
+        if (components_[k].name == name) {
+          auto pin = std::istringstream(std::move(payload));
+          auto pia = BinaryIArchive(pin);
+          components_[k].load(pia);
+          restored[k] = true;
+          break;
+        }
+      }
+    }
+
+    for (auto k = 0UL; k < components_.size(); k++) {
+      if (!restored[k]) {
+        Fail(fmt::format("{} is missing", components_[k].name));
+      }
+    }
+  } catch (exception::BinaryArchiveError const& e) {
+    Fail(e.what());
+  }
+  return true;
+}
+
+} // namespace io
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
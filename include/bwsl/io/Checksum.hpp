@@ -0,0 +1,91 @@
+//===-- Checksum.hpp -------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Checksums used to validate binary files
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bwsl::io {
+
+///
+/// FNV-1a offset basis, starting value of a checksum
+///
+constexpr std::uint64_t checksum_seed = 0xcbf29ce484222325ULL;
+
+///
+/// Feed @p size bytes to a running checksum.
+/// This is a variant of the 64 bit FNV-1a hash consuming eight bytes per
+/// step. Data can be fed in pieces as long as all the pieces but the last
+/// have a size multiple of eight. Words are always read as little endian so
+/// that the result does not depend on the machine.
+///
+inline auto
+checksum_update(std::uint64_t h, void const* data, size_t size)
+  -> std::uint64_t
+{
+  constexpr auto prime = 0x100000001b3ULL;
+  auto const* p = static_cast<unsigned char const*>(data);
+
+  auto one = std::uint16_t{ 1U };
+  auto little = std::uint8_t{};
+  std::memcpy(&little, &one, 1UL);
+
+  while (size >= sizeof(std::uint64_t)) {
+    auto w = std::uint64_t{};
+    if (little == 1U) {
+      std::memcpy(&w, p, sizeof(w));
+    } else {
+      for (auto i = 0U; i < sizeof(w); i++) {
+        w |= static_cast<std::uint64_t>(p[i]) << (8U * i);
+      }
+    }
+    h = (h ^ w) * prime;
+    p += sizeof(w);
+    size -= sizeof(w);
+  }
+  while (size > 0UL) {
+    h = (h ^ *p++) * prime;
+    size--;
+  }
+  return h;
+}
+
+///
+/// Finalize a running checksum so that all its bits depend on all the data
+///
+inline auto
+checksum_final(std::uint64_t h) -> std::uint64_t
+{
+  h ^= h >> 33U;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33U;
+  return h;
+}
+
+///
+/// Checksum of a block of memory.
+/// It is meant to detect torn or corrupted writes, not malicious changes.
+///
+inline auto
+checksum(void const* data, size_t size) -> std::uint64_t
+{
+  return checksum_final(checksum_update(checksum_seed, data, size));
+}
+
+} // namespace bwsl::io
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
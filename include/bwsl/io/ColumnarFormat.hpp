@@ -0,0 +1,250 @@
+//===-- ColumnarFormat.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Common definitions for the binary columnar file format
+///
+/// A columnar file starts with an header followed by any number of blocks.
+/// All the integers are stored in the byte order of the machine which
+/// created the file, which is recorded in the header.
+///
+///     header:  "BWSLCOL1"  u8 byteorder  u8 version  u16 zero  u32 ncols
+///              ncols * (u8 type  u32 namelength  name)
+///              u64 checksum of all the previous bytes
+///     block:   u32 "BLCK"  u32 nrows
+///              ncols * (nrows values of the column)
+///              u64 checksum of all the previous bytes of the block
+///
+/// Blocks are written with a single call and only complete blocks with a
+/// valid checksum are considered part of the file, so that a crash while
+/// appending loses at most the block being written.
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bwsl {
+
+namespace exception {
+
+/// A columnar file is malformed or does not match the expected layout
+class ColumnarFormatError : public std::exception
+{
+public:
+  ColumnarFormatError(std::string const& fname, std::string const& reason)
+    : message_(fmt::format("{}: {}", fname, reason))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class ColumnarFormatError
+
+} // namespace exception
+
+namespace io {
+
+///
+/// Types of the values stored in a column
+///
+enum class ColumnType : std::uint8_t
+{
+  Int32 = 1,
+  Int64 = 2,
+  UInt32 = 3,
+  UInt64 = 4,
+  Float32 = 5,
+  Float64 = 6,
+};
+
+///
+/// Formats available to save tables
+///
+enum class TableFormat
+{
+  /// Comma separated text
+  Csv,
+  /// Binary columnar format
+  Columnar,
+};
+
+///
+/// Description of a column
+///
+struct Column
+{
+  /// Name of the column
+  std::string name;
+
+  /// Type of the values
+  ColumnType type;
+};
+
+/// Two columns are equal if they have the same name and type
+inline auto
+operator==(Column const& a, Column const& b) -> bool
+{
+  return a.name == b.name && a.type == b.type;
+}
+
+/// Two columns are different if they differ in name or type
+inline auto
+operator!=(Column const& a, Column const& b) -> bool
+{
+  return !(a == b);
+}
+
+namespace columnar {
+
+/// Magic string at the beginning of the file
+constexpr char file_magic[] = "BWSLCOL1";
+
+/// Magic number at the beginning of each block
+constexpr std::uint32_t block_magic = 0x4B434C42U;
+
+/// Version of the format
+constexpr std::uint8_t version = 1U;
+
+/// Tag for little endian files
+constexpr std::uint8_t little_endian = 1U;
+
+/// Tag for big endian files
+constexpr std::uint8_t big_endian = 2U;
+
+/// Byte order of the machine
+inline auto
+host_byteorder() -> std::uint8_t
+{
+  auto one = std::uint16_t{ 1U };
+  auto first = std::uint8_t{};
+  std::memcpy(&first, &one, 1UL);
+  return first == 1U ? little_endian : big_endian;
+}
+
+/// Size in bytes of the values of a given type, zero if the type is unknown
+inline auto
+width(ColumnType type) -> size_t
+{
+  switch (type) {
+    case ColumnType::Int32:
+    case ColumnType::UInt32:
+    case ColumnType::Float32:
+      return 4UL;
+    case ColumnType::Int64:
+    case ColumnType::UInt64:
+    case ColumnType::Float64:
+      return 8UL;
+  }
+  return 0UL;
+}
+
+/// Column type corresponding to a C++ type
+template<typename T>
+constexpr auto
+type_of() -> ColumnType
+{
+  static_assert(std::is_arithmetic<T>::value, "Arithmetic type required");
+  if constexpr (std::is_floating_point<T>::value) {
+    return sizeof(T) <= 4 ? ColumnType::Float32 : ColumnType::Float64;
+  } else if constexpr (std::is_signed<T>::value) {
+    return sizeof(T) <= 4 ? ColumnType::Int32 : ColumnType::Int64;
+  } else {
+    return sizeof(T) <= 4 ? ColumnType::UInt32 : ColumnType::UInt64;
+  }
+}
+
+/// Store @p value at @p dst converting it to the given column type
+template<typename T>
+inline auto
+store(ColumnType type, T value, char* dst) -> void
+{
+  auto put = [dst](auto v) { std::memcpy(dst, &v, sizeof(v)); };
+  switch (type) {
+    case ColumnType::Int32:
+      put(static_cast<std::int32_t>(value));
+      break;
+    case ColumnType::Int64:
+      put(static_cast<std::int64_t>(value));
+      break;
+    case ColumnType::UInt32:
+      put(static_cast<std::uint32_t>(value));
+      break;
+    case ColumnType::UInt64:
+      put(static_cast<std::uint64_t>(value));
+      break;
+    case ColumnType::Float32:
+      put(static_cast<float>(value));
+      break;
+    case ColumnType::Float64:
+      put(static_cast<double>(value));
+      break;
+  }
+}
+
+/// Load the value at @p src of the given column type converting it to T
+template<typename T>
+inline auto
+load(ColumnType type, char const* src) -> T
+{
+  auto get = [src](auto v) {
+    std::memcpy(&v, src, sizeof(v));
+    return static_cast<T>(v);
+  };
+  switch (type) {
+    case ColumnType::Int32:
+      return get(std::int32_t{});
+    case ColumnType::Int64:
+      return get(std::int64_t{});
+    case ColumnType::UInt32:
+      return get(std::uint32_t{});
+    case ColumnType::UInt64:
+      return get(std::uint64_t{});
+    case ColumnType::Float32:
+      return get(float{});
+    case ColumnType::Float64:
+      return get(double{});
+  }
+  return T{};
+}
+
+/// Reverse the bytes of @p n values of @p w bytes each
+inline auto
+byteswap(char* data, size_t n, size_t w) -> void
+{
+  for (auto i = 0UL; i < n; i++) {
+    auto* v = data + i * w;
+    for (auto j = 0UL; j < w / 2UL; j++) {
+      std::swap(v[j], v[w - 1UL - j]);
+    }
+  }
+}
+
+} // namespace columnar
+
+} // namespace io
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,354 @@
+//===-- ColumnarReader.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ColumnarReader Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/io/Checksum.hpp>
+#include <bwsl/io/ColumnarFormat.hpp>
+
+// fmt
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bwsl::io {
+
+///
+/// Read a binary columnar file.
+///
+/// The whole file is loaded and validated at construction. Blocks after the
+/// first incomplete or corrupted one are ignored, since they can only be the
+/// result of an interrupted write.
+///
+class ColumnarReader
+{
+public:
+  /// Load the file @p fname
+  ColumnarReader(std::string fname);
+
+  /// Description of the columns
+  [[nodiscard]] auto GetColumns() const -> std::vector<Column> const&
+  {
+    return columns_;
+  };
+
+  /// Number of columns
+  [[nodiscard]] auto GetNumColumns() const -> size_t
+  {
+    return columns_.size();
+  };
+
+  /// Number of rows in the valid blocks
+  [[nodiscard]] auto GetNumRows() const -> size_t { return nrows_; };
+
+  /// Number of valid blocks
+  [[nodiscard]] auto GetNumBlocks() const -> size_t { return blocks_.size(); };
+
+  /// Size in bytes of the header and of the valid blocks
+  [[nodiscard]] auto GetValidSize() const -> size_t { return valid_size_; };
+
+  /// Check if the file has trailing bytes which are not a valid block
+  [[nodiscard]] auto IsTruncated() const -> bool
+  {
+    return valid_size_ != data_.size();
+  };
+
+  /// Check if the file was written with a different byte order
+  [[nodiscard]] auto IsSwapped() const -> bool { return swap_; };
+
+  /// Position of the column with the given name
+  [[nodiscard]] auto GetColumnIndex(std::string const& name) const -> size_t;
+
+  /// All the values of a column converted to T
+  template<typename T>
+  [[nodiscard]] auto GetColumn(size_t col) const -> std::vector<T>;
+
+  /// All the values of a column converted to T
+  template<typename T>
+  [[nodiscard]] auto GetColumn(std::string const& name) const
+    -> std::vector<T>
+  {
+    return GetColumn<T>(GetColumnIndex(name));
+  }
+
+  /// Write the content of the file as CSV
+  auto WriteCSV(std::ostream& out) const -> void;
+
+protected:
+  /// Read an integer at @p pos and advance, false if past the end
+  template<typename T>
+  auto Read(size_t& pos, size_t end, T& value) const -> bool;
+
+  /// Parse the header, returns its size
+  auto ParseHeader() -> size_t;
+
+  /// Parse the block at @p pos, returns false if it is not valid
+  auto ParseBlock(size_t& pos) -> bool;
+
+private:
+  /// Position and size of a block
+  struct Block
+  {
+    /// Offset of the first value of the block
+    size_t offset;
+
+    /// Number of rows
+    size_t nrows;
+  };
+
+  /// Name of the file
+  std::string fname_;
+
+  /// Content of the file
+  std::vector<char> data_{};
+
+  /// Description of the columns
+  std::vector<Column> columns_{};
+
+  /// The valid blocks
+  std::vector<Block> blocks_{};
+
+  /// Number of rows
+  size_t nrows_{ 0UL };
+
+  /// Size in bytes of the header and of the valid blocks
+  size_t valid_size_{ 0UL };
+
+  /// Whether the file was written with a different byte order
+  bool swap_{ false };
+}; // class ColumnarReader
+
+inline ColumnarReader::ColumnarReader(std::string fname)
+  : fname_(std::move(fname))
+{
+  auto in = std::ifstream(fname_.c_str(), std::ios::binary);
+  if (!in) {
+    throw exception::ColumnarFormatError(fname_, "cannot open the file");
+  }
+  data_.assign(std::istreambuf_iterator<char>(in),
+               std::istreambuf_iterator<char>());
+
+  auto pos = ParseHeader();
+  valid_size_ = pos;
+  while (pos < data_.size() && ParseBlock(pos)) {
+    valid_size_ = pos;
+  }
+}
+
+template<typename T>
+inline auto
+ColumnarReader::Read(size_t& pos, size_t end, T& value) const -> bool
+{
+  if (pos > end || end - pos < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data_.data() + pos, sizeof(T));
+  if (swap_) {
+    columnar::byteswap(reinterpret_cast<char*>(&value), 1UL, sizeof(T));
+  }
+  pos += sizeof(T);
+  return true;
+}
+
+inline auto
+ColumnarReader::ParseHeader() -> size_t
+{
+  auto const end = data_.size();
+  auto const nmagic = sizeof(columnar::file_magic) - 1UL;
+
+  if (end < nmagic + 8UL ||
+      std::memcmp(data_.data(), columnar::file_magic, nmagic) != 0) {
+    throw exception::ColumnarFormatError(fname_, "not a columnar file");
+  }
+
+  auto byteorder = static_cast<std::uint8_t>(data_[nmagic]);
+  auto version = static_cast<std::uint8_t>(data_[nmagic + 1UL]);
+  if (byteorder != columnar::little_endian &&
+      byteorder != columnar::big_endian) {
+    throw exception::ColumnarFormatError(fname_, "unknown byte order");
+  }
+  if (version != columnar::version) {
+    throw exception::ColumnarFormatError(
+      fname_, fmt::format("unsupported version {}", version));
+  }
+  swap_ = byteorder != columnar::host_byteorder();
+
+  auto pos = nmagic + 4UL;
+  auto ncols = std::uint32_t{};
+  auto ok = Read(pos, end, ncols);
+  for (auto i = 0UL; ok && i < ncols; i++) {
+    auto type = std::uint8_t{};
+    auto len = std::uint32_t{};
+    ok = Read(pos, end, type) && Read(pos, end, len) && end - pos >= len;
+    if (ok) {
+      auto c = Column{ std::string(data_.data() + pos, len),
+                       static_cast<ColumnType>(type) };
+      ok = columnar::width(c.type) != 0UL;
+      columns_.push_back(std::move(c));
+      pos += len;
+    }
+  }
+
+  auto const size = pos;
+  auto sum = std::uint64_t{};
+  if (!ok || !Read(pos, end, sum) || sum != checksum(data_.data(), size)) {
+    throw exception::ColumnarFormatError(fname_, "corrupted header");
+  }
+
+  return pos;
+}
+
+inline auto
+ColumnarReader::ParseBlock(size_t& pos) -> bool
+{
+  auto const end = data_.size();
+  auto const start = pos;
+  auto p = pos;
+
+  auto magic = std::uint32_t{};
+  auto nrows = std::uint32_t{};
+  if (!Read(p, end, magic) || magic != columnar::block_magic ||
+      !Read(p, end, nrows)) {
+    return false;
+  }
+
+  auto const offset = p;
+  for (auto const& c : columns_) {
+    auto bytes = columnar::width(c.type) * nrows;
+    if (end - p < bytes) {
+      return false;
+    }
+    p += bytes;
+  }
+
+  auto const size = p - start;
+  auto sum = std::uint64_t{};
+  if (!Read(p, end, sum) || sum != checksum(data_.data() + start, size)) {
+    return false;
+  }
+
+  if (swap_) {
+    auto q = offset;
+    for (auto const& c : columns_) {
+      auto w = columnar::width(c.type);
+      columnar::byteswap(data_.data() + q, nrows, w);
+      q += w * nrows;
+    }
+  }
+
+  blocks_.push_back(Block{ offset, nrows });
+  nrows_ += nrows;
+  pos = p;
+  return true;
+}
+
+inline auto
+ColumnarReader::GetColumnIndex(std::string const& name) const -> size_t
+{
+  for (auto i = 0UL; i < columns_.size(); i++) {
+    if (columns_[i].name == name) {
+      return i;
+    }
+  }
+  throw exception::ColumnarFormatError(fname_,
+                                       fmt::format("no column named {}", name));
+}
+
+template<typename T>
+inline auto
+ColumnarReader::GetColumn(size_t col) const -> std::vector<T>
+{
+  auto r = std::vector<T>{};
+  r.reserve(nrows_);
+
+  auto const type = columns_.at(col).type;
+  auto const w = columnar::width(type);
+
+  for (auto const& b : blocks_) {
+    auto p = b.offset;
+    for (auto i = 0UL; i < col; i++) {
+      p += columnar::width(columns_[i].type) * b.nrows;
+    }
+    for (auto i = 0UL; i < b.nrows; i++) {
+      r.push_back(columnar::load<T>(type, data_.data() + p + i * w));
+    }
+  }
+
+  return r;
+}
+
+inline auto
+ColumnarReader::WriteCSV(std::ostream& out) const -> void
+{
+  auto const ncols = columns_.size();
+
+  for (auto i = 0UL; i < ncols; i++) {
+    if (i != 0UL) {
+      fmt::print(out, ",");
+    }
+    fmt::print(out, "{}", columns_[i].name);
+  }
+  fmt::print(out, "\n");
+
+  auto cell = [&out](ColumnType type, char const* src) {
+    switch (type) {
+      case ColumnType::Int32:
+      case ColumnType::Int64:
+        fmt::print(out, "{}", columnar::load<std::int64_t>(type, src));
+        break;
+      case ColumnType::UInt32:
+      case ColumnType::UInt64:
+        fmt::print(out, "{}", columnar::load<std::uint64_t>(type, src));
+        break;
+      case ColumnType::Float32:
+        fmt::print(out, "{}", columnar::load<float>(type, src));
+        break;
+      case ColumnType::Float64:
+        fmt::print(out, "{}", columnar::load<double>(type, src));
+        break;
+    }
+  };
+
+  auto offsets = std::vector<size_t>(ncols);
+  for (auto const& b : blocks_) {
+    auto p = b.offset;
+    for (auto c = 0UL; c < ncols; c++) {
+      offsets[c] = p;
+      p += columnar::width(columns_[c].type) * b.nrows;
+    }
+    for (auto i = 0UL; i < b.nrows; i++) {
+      for (auto c = 0UL; c < ncols; c++) {
+        if (c != 0UL) {
+          fmt::print(out, ",");
+        }
+        auto w = columnar::width(columns_[c].type);
+        cell(columns_[c].type, data_.data() + offsets[c] + i * w);
+      }
+      fmt::print(out, "\n");
+    }
+  }
+}
+
+} // namespace bwsl::io
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
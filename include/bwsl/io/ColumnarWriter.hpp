@@ -0,0 +1,325 @@
+//===-- ColumnarWriter.hpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ColumnarWriter Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/io/Checksum.hpp>
+#include <bwsl/io/ColumnarFormat.hpp>
+#include <bwsl/io/ColumnarReader.hpp>
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bwsl::io {
+
+///
+/// Write tables in the binary columnar format.
+///
+/// Rows are collected in memory and written as a block every @p block_rows
+/// rows, when Flush is called and at destruction. The values are converted
+/// to the type of their column when they are pushed.
+///
+class ColumnarWriter
+{
+public:
+  /// Create @p fname, or append to it if @p append is true and it exists
+  ColumnarWriter(std::string fname,
+                 std::vector<Column> columns,
+                 bool append = false,
+                 size_t block_rows = 4096UL);
+
+  /// Copy constructor
+  ColumnarWriter(ColumnarWriter const&) = delete;
+
+  /// Move constructor
+  ColumnarWriter(ColumnarWriter&&) = default;
+
+  /// Copy assignment operator
+  auto operator=(ColumnarWriter const&) -> ColumnarWriter& = delete;
+
+  /// Move assignment operator
+  auto operator=(ColumnarWriter&&) -> ColumnarWriter& = default;
+
+  /// Write the pending rows
+  ~ColumnarWriter();
+
+  /// Set the next value of the current row
+  template<typename T>
+  auto Push(T value) -> void;
+
+  /// Terminate the current row
+  auto EndRow() -> void;
+
+  /// Append a full row
+  template<typename... Ts>
+  auto AppendRow(Ts... values) -> void;
+
+  /// Append a full row taking the values from a range
+  template<typename InputIt>
+  auto AppendRow(InputIt first, InputIt last) -> void;
+
+  /// Write the pending rows as a block
+  auto Flush() -> void;
+
+  /// Description of the columns
+  [[nodiscard]] auto GetColumns() const -> std::vector<Column> const&
+  {
+    return columns_;
+  };
+
+  /// Number of rows appended, including the ones already in the file
+  [[nodiscard]] auto GetNumRows() const -> size_t { return total_ + nrows_; };
+
+  /// Name of the file
+  [[nodiscard]] auto GetFileName() const -> std::string const&
+  {
+    return fname_;
+  };
+
+protected:
+  /// Write the header of a new file
+  auto WriteHeader() -> void;
+
+  /// Check an existing file and drop its invalid tail
+  auto Resume() -> void;
+
+private:
+  /// Name of the file
+  std::string fname_;
+
+  /// Description of the columns
+  std::vector<Column> columns_;
+
+  /// Maximum number of rows in a block
+  size_t block_rows_;
+
+  /// Size of the values of each column
+  std::vector<size_t> widths_{};
+
+  /// Offset of each column in the block buffer
+  std::vector<size_t> offsets_{};
+
+  /// Block being filled
+  std::vector<char> block_{};
+
+  /// Rows in the block being filled
+  size_t nrows_{ 0UL };
+
+  /// Next column of the current row
+  size_t cell_{ 0UL };
+
+  /// Rows already written
+  size_t total_{ 0UL };
+
+  /// The output file
+  std::ofstream out_{};
+}; // class ColumnarWriter
+
+inline ColumnarWriter::ColumnarWriter(std::string fname,
+                                      std::vector<Column> columns,
+                                      bool append,
+                                      size_t block_rows)
+  : fname_(std::move(fname))
+  , columns_(std::move(columns))
+  , block_rows_(block_rows)
+{
+  assert(block_rows_ > 0UL);
+
+  auto offset = 2UL * sizeof(std::uint32_t);
+  for (auto const& c : columns_) {
+    auto w = columnar::width(c.type);
+    if (w == 0UL) {
+      throw exception::ColumnarFormatError(fname_, "unknown column type");
+    }
+    widths_.push_back(w);
+    offsets_.push_back(offset);
+    offset += w * block_rows_;
+  }
+  block_.resize(offset + sizeof(std::uint64_t));
+
+  if (append && std::filesystem::exists(fname_) &&
+      std::filesystem::file_size(fname_) > 0UL) {
+    Resume();
+  } else {
+    WriteHeader();
+  }
+}
+
+inline ColumnarWriter::~ColumnarWriter()
+{
+  if (out_.is_open()) {
+    Flush();
+  }
+}
+
+inline auto
+ColumnarWriter::WriteHeader() -> void
+{
+  out_.open(fname_.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    throw exception::ColumnarFormatError(fname_, "cannot open the file");
+  }
+
+  auto header = std::vector<char>{};
+  auto put = [&header](auto const* p, size_t n) {
+    auto const* c = reinterpret_cast<char const*>(p);
+    header.insert(header.end(), c, c + n);
+  };
+
+  auto const nmagic = sizeof(columnar::file_magic) - 1UL;
+  auto const ncols = static_cast<std::uint32_t>(columns_.size());
+  std::uint8_t const tags[4] = {
+    columnar::host_byteorder(), columnar::version, 0U, 0U
+  };
+
+  put(columnar::file_magic, nmagic);
+  put(tags, sizeof(tags));
+  put(&ncols, sizeof(ncols));
+  for (auto const& c : columns_) {
+    auto type = static_cast<std::uint8_t>(c.type);
+    auto len = static_cast<std::uint32_t>(c.name.size());
+    put(&type, sizeof(type));
+    put(&len, sizeof(len));
+    put(c.name.data(), c.name.size());
+  }
+  auto sum = checksum(header.data(), header.size());
+  put(&sum, sizeof(sum));
+
+  out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+  out_.flush();
+}
+
+inline auto
+ColumnarWriter::Resume() -> void
+{
+  auto reader = ColumnarReader(fname_);
+
+  if (reader.GetColumns() != columns_) {
+    throw exception::ColumnarFormatError(fname_, "columns do not match");
+  }
+  if (reader.IsSwapped()) {
+    throw exception::ColumnarFormatError(
+      fname_, "cannot append to a file with a different byte order");
+  }
+  if (reader.IsTruncated()) {
+    std::filesystem::resize_file(fname_, reader.GetValidSize());
+  }
+  total_ = reader.GetNumRows();
+
+  out_.open(fname_.c_str(), std::ios::binary | std::ios::app);
+  if (!out_) {
+    throw exception::ColumnarFormatError(fname_, "cannot open the file");
+  }
+}
+
+template<typename T>
+inline auto
+ColumnarWriter::Push(T value) -> void
+{
+  if (cell_ == columns_.size()) {
+    throw exception::ColumnarFormatError(fname_, "too many values in a row");
+  }
+  auto* dst = block_.data() + offsets_[cell_] + nrows_ * widths_[cell_];
+  columnar::store(columns_[cell_].type, value, dst);
+  cell_++;
+}
+
+inline auto
+ColumnarWriter::EndRow() -> void
+{
+  if (cell_ != columns_.size()) {
+    throw exception::ColumnarFormatError(fname_, "incomplete row");
+  }
+  cell_ = 0UL;
+  nrows_++;
+  if (nrows_ == block_rows_) {
+    Flush();
+  }
+}
+
+template<typename... Ts>
+inline auto
+ColumnarWriter::AppendRow(Ts... values) -> void
+{
+  (Push(values), ...);
+  EndRow();
+}
+
+template<typename InputIt>
+inline auto
+ColumnarWriter::AppendRow(InputIt first, InputIt last) -> void
+{
+  while (first != last) {
+    Push(*first++);
+  }
+  EndRow();
+}
+
+inline auto
+ColumnarWriter::Flush() -> void
+{
+  if (nrows_ == 0UL) {
+    out_.flush();
+    return;
+  }
+
+  // keep the cells of a partially pushed row, the compaction overwrites them
+  auto partial = std::vector<char>{};
+  for (auto c = 0UL; c < cell_; c++) {
+    auto const* src = block_.data() + offsets_[c] + nrows_ * widths_[c];
+    partial.insert(partial.end(), src, src + widths_[c]);
+  }
+
+  // move the columns of a partial block next to each other
+  auto end = offsets_.empty() ? 2UL * sizeof(std::uint32_t) : offsets_[0];
+  for (auto c = 0UL; c < columns_.size(); c++) {
+    auto bytes = widths_[c] * nrows_;
+    if (end != offsets_[c]) {
+      std::memmove(block_.data() + end, block_.data() + offsets_[c], bytes);
+    }
+    end += bytes;
+  }
+
+  auto const magic = columnar::block_magic;
+  auto const nrows = static_cast<std::uint32_t>(nrows_);
+  std::memcpy(block_.data(), &magic, sizeof(magic));
+  std::memcpy(block_.data() + sizeof(magic), &nrows, sizeof(nrows));
+  auto sum = checksum(block_.data(), end);
+  std::memcpy(block_.data() + end, &sum, sizeof(sum));
+
+  out_.write(block_.data(), static_cast<std::streamsize>(end + sizeof(sum)));
+  out_.flush();
+
+  total_ += nrows_;
+  nrows_ = 0UL;
+
+  // the partial row becomes the first row of the next block
+  auto const* src = partial.data();
+  for (auto c = 0UL; c < cell_; c++) {
+    std::memcpy(block_.data() + offsets_[c], src, widths_[c]);
+    src += widths_[c];
+  }
+}
+
+} // namespace bwsl::io
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
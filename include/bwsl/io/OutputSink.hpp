@@ -0,0 +1,292 @@
+//===-- OutputSink.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the OutputSink Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/SPSCQueue.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace bwsl {
+
+namespace exception {
+
+/// The output file of a sink could not be opened
+class OutputSinkOpen : public std::exception
+{
+public:
+  OutputSinkOpen(std::string const& fname)
+    : message_(fmt::format("Cannot open {} for writing", fname))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class OutputSinkOpen
+
+} // namespace exception
+
+namespace io {
+
+///
+/// How an OutputSink hands its buffers to the file
+///
+enum class SinkMode
+{
+  /// Full buffers are written by the thread which filled them
+  Synchronous,
+  /// Full buffers are written by a background thread
+  Asynchronous,
+};
+
+///
+/// Buffered writer which keeps its file open for all its lifetime.
+///
+/// Formatted text is collected in memory and handed to the file only when
+/// the buffer grows over a threshold. In asynchronous mode the full buffers
+/// travel through a lock-free queue to a background thread which does the
+/// actual writing, so that the producer never waits on the filesystem. If
+/// the queue is full the producer simply keeps buffering.
+///
+/// Only one thread at a time can produce into a sink.
+///
+class OutputSink
+{
+public:
+  /// Open @p fname, truncating it unless @p append is true
+  OutputSink(std::string fname,
+             bool append = false,
+             SinkMode mode = SinkMode::Synchronous,
+             size_t threshold = 1UL << 16UL);
+
+  /// Copy constructor
+  OutputSink(OutputSink const&) = delete;
+
+  /// Move constructor
+  OutputSink(OutputSink&&) = delete;
+
+  /// Copy assignment operator
+  auto operator=(OutputSink const&) -> OutputSink& = delete;
+
+  /// Move assignment operator
+  auto operator=(OutputSink&&) -> OutputSink& = delete;
+
+  /// Flush all the pending output and close the file
+  ~OutputSink();
+
+  /// Append raw text
+  auto Write(std::string_view text) -> void;
+
+  /// Append formatted text
+  template<typename... Args>
+  auto Print(fmt::format_string<Args...> format, Args&&... args) -> void;
+
+  /// Write all the pending output to the file and wait for it to be done
+  auto Flush() -> void;
+
+  /// Name of the file
+  [[nodiscard]] auto GetFileName() const -> std::string const&
+  {
+    return fname_;
+  };
+
+  /// Writing mode
+  [[nodiscard]] auto GetMode() const -> SinkMode { return mode_; };
+
+protected:
+  /// Hand the buffer to the file if it is full enough
+  auto SubmitIfFull() -> void;
+
+  /// Hand the current buffer to the file, if @p wait is false it can fail
+  auto Submit(bool wait) -> bool;
+
+  /// Body of the background writer
+  auto Run() -> void;
+
+private:
+  /// Name of the file
+  std::string fname_;
+
+  /// Writing mode
+  SinkMode mode_;
+
+  /// Size of the buffer which triggers a write
+  size_t threshold_;
+
+  /// The output file
+  std::ofstream out_;
+
+  /// Text not yet handed to the file
+  std::string buffer_{};
+
+  /// Buffers waiting for the background writer
+  SPSCQueue<std::string> queue_{ 64UL };
+
+  /// Number of buffers pushed to the queue
+  unsigned long submitted_{ 0UL };
+
+  /// Number of buffers written and flushed by the background writer
+  std::atomic<unsigned long> written_{ 0UL };
+
+  /// Request for the background writer to stop
+  std::atomic<bool> stop_{ false };
+
+  /// The background writer
+  std::thread writer_{};
+}; // class OutputSink
+
+inline OutputSink::OutputSink(std::string fname,
+                              bool append,
+                              SinkMode mode,
+                              size_t threshold)
+  : fname_(std::move(fname))
+  , mode_(mode)
+  , threshold_(threshold)
+  , out_(fname_.c_str(), append ? std::ios::app : std::ios::trunc)
+{
+  if (!out_) {
+    throw exception::OutputSinkOpen(fname_);
+  }
+
+  buffer_.reserve(threshold_);
+
+  if (mode_ == SinkMode::Asynchronous) {
+    writer_ = std::thread(&OutputSink::Run, this);
+  }
+}
+
+inline OutputSink::~OutputSink()
+{
+  Flush();
+  if (writer_.joinable()) {
+    stop_.store(true, std::memory_order_release);
+    writer_.join();
+  }
+}
+
+inline auto
+OutputSink::Write(std::string_view text) -> void
+{
+  buffer_.append(text);
+  SubmitIfFull();
+}
+
+template<typename... Args>
+inline auto
+OutputSink::Print(fmt::format_string<Args...> format, Args&&... args) -> void
+{
+  fmt::format_to(
+    std::back_inserter(buffer_), format, std::forward<Args>(args)...);
+  SubmitIfFull();
+}
+
+inline auto
+OutputSink::SubmitIfFull() -> void
+{
+  if (buffer_.size() >= threshold_) {
+    Submit(false);
+  }
+}
+
+inline auto
+OutputSink::Submit(bool wait) -> bool
+{
+  if (buffer_.empty()) {
+    return true;
+  }
+
+  if (mode_ == SinkMode::Synchronous) {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    return true;
+  }
+
+  while (!queue_.TryPush(std::move(buffer_))) {
+    if (!wait) {
+      // the moved-from string is left untouched by a failed push
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  submitted_++;
+  buffer_ = std::string{};
+  buffer_.reserve(threshold_);
+  return true;
+}
+
+inline auto
+OutputSink::Flush() -> void
+{
+  Submit(true);
+
+  if (mode_ == SinkMode::Synchronous) {
+    out_.flush();
+    return;
+  }
+
+  while (written_.load(std::memory_order_acquire) != submitted_) {
+    std::this_thread::yield();
+  }
+}
+
+inline auto
+OutputSink::Run() -> void
+{
+  auto chunk = std::string{};
+  auto written = 0UL;
+  auto idle = std::chrono::microseconds(50);
+
+  while (true) {
+    if (queue_.TryPop(chunk)) {
+      out_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+      written++;
+      continue;
+    }
+
+    // the queue is drained: make the data visible before acknowledging it
+    if (written != written_.load(std::memory_order_relaxed)) {
+      out_.flush();
+      written_.store(written, std::memory_order_release);
+    }
+
+    if (stop_.load(std::memory_order_acquire) && queue_.Empty()) {
+      return;
+    }
+
+    std::this_thread::sleep_for(idle);
+  }
+}
+
+} // namespace io
+
+} // namespace bwsl
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
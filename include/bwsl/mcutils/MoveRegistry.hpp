@@ -0,0 +1,427 @@
+//===-- MoveRegistry.hpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MoveRegistry Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+#include <bwsl/sampling/AliasTable.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+namespace exception {
+
+/// No move with the given name
+class UnknownMove : public std::exception
+{
+public:
+  UnknownMove(std::string const& name)
+    : message_(fmt::format("{} move: no such move", name))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class UnknownMove
+
+/// The moves of a registry do not match the ones saved in an archive
+class MoveRegistryMismatch : public std::exception
+{
+public:
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The registered moves do not match the saved ones";
+  }
+}; // class MoveRegistryMismatch
+
+/// The weights and step sizes of a frozen registry cannot change
+class FrozenMoveRegistry : public std::exception
+{
+public:
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The weights and step sizes of a frozen registry are fixed";
+  }
+}; // class FrozenMoveRegistry
+
+} // namespace bwsl::montecarlo::exception
+
+///
+/// The moves of a Markov Chain Monte Carlo, with their statistics.
+///
+/// Moves are registered once and then referred to by a dense integer id,
+/// the order of registration. Every step draws a move from the proposal
+/// weights with a sampling::AliasTable, in constant time, runs it and
+/// records its result in the FastMoveStats of the move: the registry
+/// always proposes before accepting or rejecting, so the checks of
+/// MoveStats are not needed.
+///
+/// A move receives its step size (the width of a displacement, the angle
+/// of a rotation...) followed by @p Args. During the thermalization the
+/// step size of the moves with a target acceptance is adapted after every
+/// window of proposals, multiplying it by exp(ratio - target), until
+/// Freeze is called: from then on the step sizes and weights are fixed, as
+/// needed for detailed balance, and the statistics restart.
+///
+template<class... Args>
+class MoveRegistry
+{
+public:
+  /// Type of the moves
+  using move_type = std::function<MoveResult(double, Args...)>;
+
+  /// Default number of proposals of a move between two adaptations
+  static constexpr unsigned long default_window = 1000UL;
+
+  /// Default constructor
+  MoveRegistry() = default;
+
+  /// Copy constructor
+  MoveRegistry(MoveRegistry const& that) = default;
+
+  /// Move constructor
+  MoveRegistry(MoveRegistry&& that) = default;
+
+  /// Default destructor
+  ~MoveRegistry() = default;
+
+  /// Copy assignment operator
+  auto operator=(MoveRegistry const& that) -> MoveRegistry& = default;
+
+  /// Move assignment operator
+  auto operator=(MoveRegistry&& that) -> MoveRegistry& = default;
+
+  /// Register a move proposed with weight @p weight, returns its id
+  auto Register(std::string name, move_type move, double weight = 1.0)
+    -> size_t;
+
+  /// Change the proposal weight of a move, before Freeze
+  auto SetWeight(size_t id, double weight) -> void;
+
+  /// Set the step size of a move and, if @p target is positive, adapt it
+  /// during the thermalization to get the acceptance ratio @p target,
+  /// keeping it in [@p min, @p max], before Freeze
+  auto SetStep(size_t id,
+               double step,
+               double target = 0.0,
+               double min = 0.0,
+               double max = std::numeric_limits<double>::max()) -> void;
+
+  /// Number of proposals of a move between two adaptations
+  auto SetWindow(unsigned long window) -> void { window_ = window; };
+
+  /// Stop adapting and reset the statistics, for the production run
+  auto Freeze() -> void;
+
+  /// Draw the id of the next move to propose
+  template<typename G>
+  [[nodiscard]] auto Select(G& rng) const -> size_t
+  {
+    return table_.Sample(rng);
+  }
+
+  /// Record the result of a proposal of the move @p id
+  auto Record(size_t id, MoveResult const& res) -> void;
+
+  /// Draw a move, run it with @p args and record its result, returns the
+  /// id of the move
+  template<typename G>
+  auto Step(G& rng, Args... args) -> size_t;
+
+  /// Id of a move from its name
+  [[nodiscard]] auto GetId(std::string const& name) const -> size_t;
+
+  /// Name of a move
+  [[nodiscard]] auto GetName(size_t id) const -> std::string const&
+  {
+    return moves_[id].name;
+  };
+
+  /// Statistics of a move
+  [[nodiscard]] auto GetStats(size_t id) const -> FastMoveStats const&
+  {
+    return moves_[id].stats;
+  };
+
+  /// Step size of a move
+  [[nodiscard]] auto GetStep(size_t id) const -> double
+  {
+    return moves_[id].step;
+  };
+
+  /// Proposal weight of a move
+  [[nodiscard]] auto GetWeight(size_t id) const -> double
+  {
+    return moves_[id].weight;
+  };
+
+  /// Check if the step sizes are fixed
+  [[nodiscard]] auto IsFrozen() const -> bool { return frozen_; };
+
+  /// Number of moves
+  [[nodiscard]] auto GetSize() const -> size_t { return moves_.size(); };
+
+protected:
+  /// Rebuild the table of the proposal weights
+  auto Rebuild() -> void;
+
+  /// Adapt the step size of a move to its last window
+  auto Adapt(size_t id) -> void;
+
+private:
+  /// A registered move
+  struct Entry
+  {
+    /// Name of the move
+    std::string name{};
+
+    /// The move
+    move_type move{};
+
+    /// Proposal weight
+    double weight{ 1.0 };
+
+    /// Step size
+    double step{ 1.0 };
+
+    /// Target acceptance ratio, not adapted if zero
+    double target{ 0.0 };
+
+    /// Smallest step size
+    double min{ 0.0 };
+
+    /// Largest step size
+    double max{ std::numeric_limits<double>::max() };
+
+    /// Proposals in the current window
+    unsigned long proposed{ 0UL };
+
+    /// Acceptances in the current window
+    unsigned long accepted{ 0UL };
+
+    /// Statistics of the move
+    FastMoveStats stats{};
+  };
+
+  /// The moves, by id
+  std::vector<Entry> moves_{};
+
+  /// Table of the proposal weights
+  sampling::AliasTable table_{};
+
+  /// Number of proposals of a move between two adaptations
+  unsigned long window_{ default_window };
+
+  /// Check if the step sizes are fixed
+  bool frozen_{ false };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class, the moves must already be
+  /// registered in the same order
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class MoveRegistry
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::Register(std::string name,
+                                move_type move,
+                                double weight) -> size_t
+{
+  auto entry = Entry{};
+  entry.stats = FastMoveStats(name);
+  entry.name = std::move(name);
+  entry.move = std::move(move);
+  entry.weight = weight;
+  moves_.push_back(std::move(entry));
+  Rebuild();
+  return moves_.size() - 1UL;
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::SetWeight(size_t id, double weight) -> void
+{
+  assert(id < moves_.size());
+  if (frozen_) {
+    throw exception::FrozenMoveRegistry();
+  }
+  moves_[id].weight = weight;
+  Rebuild();
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::SetStep(size_t id,
+                               double step,
+                               double target,
+                               double min,
+                               double max) -> void
+{
+  assert(id < moves_.size());
+  if (frozen_) {
+    throw exception::FrozenMoveRegistry();
+  }
+  auto& m = moves_[id];
+  m.step = step;
+  m.target = target;
+  m.min = min;
+  m.max = max;
+  m.proposed = 0UL;
+  m.accepted = 0UL;
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::Freeze() -> void
+{
+  frozen_ = true;
+  for (auto& m : moves_) {
+    m.stats.Reset();
+    m.proposed = 0UL;
+    m.accepted = 0UL;
+  }
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::Rebuild() -> void
+{
+  auto weights = std::vector<double>(moves_.size());
+  std::transform(moves_.begin(),
+                 moves_.end(),
+                 weights.begin(),
+                 [](Entry const& m) { return m.weight; });
+  table_ = sampling::AliasTable(weights);
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::Record(size_t id, MoveResult const& res) -> void
+{
+  auto& m = moves_[id];
+  m.stats.Add(res);
+  if (!frozen_ && m.target > 0.0) {
+    m.proposed++;
+    m.accepted += res.IsAccepted() ? 1UL : 0UL;
+    if (m.proposed >= window_) {
+      Adapt(id);
+    }
+  }
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::Adapt(size_t id) -> void
+{
+  // larger steps are accepted less often
+  auto& m = moves_[id];
+  auto ratio = static_cast<double>(m.accepted) / m.proposed;
+  m.step = std::clamp(m.step * std::exp(ratio - m.target), m.min, m.max);
+  m.proposed = 0UL;
+  m.accepted = 0UL;
+}
+
+template<class... Args>
+template<typename G>
+inline auto
+MoveRegistry<Args...>::Step(G& rng, Args... args) -> size_t
+{
+  auto id = Select(rng);
+  auto& m = moves_[id];
+  Record(id, m.move(m.step, std::forward<Args>(args)...));
+  return id;
+}
+
+template<class... Args>
+inline auto
+MoveRegistry<Args...>::GetId(std::string const& name) const -> size_t
+{
+  auto it = std::find_if(moves_.begin(), moves_.end(), [&](Entry const& m) {
+    return m.name == name;
+  });
+  if (it == moves_.end()) {
+    throw exception::UnknownMove(name);
+  }
+  return static_cast<size_t>(it - moves_.begin());
+}
+
+template<class... Args>
+template<class Archive>
+inline auto
+MoveRegistry<Args...>::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  auto n = moves_.size();
+  // clang-format off
+  ar & n;
+  ar & window_;
+  ar & frozen_;
+  // clang-format on
+  if (n != moves_.size()) {
+    throw exception::MoveRegistryMismatch();
+  }
+
+  for (auto& m : moves_) {
+    auto name = m.name;
+    // clang-format off
+    ar & name;
+    ar & m.weight;
+    ar & m.step;
+    ar & m.target;
+    ar & m.min;
+    ar & m.max;
+    ar & m.proposed;
+    ar & m.accepted;
+    ar & m.stats;
+    // clang-format on
+    if (name != m.name) {
+      throw exception::MoveRegistryMismatch();
+    }
+  }
+
+  if (typename Archive::is_loading()) {
+    Rebuild();
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -17,55 +17,60 @@
 
 #include <bwsl/mcutils/MoveStatus.hpp>
 
+// std
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
 namespace bwsl::montecarlo {
 
 ///
 /// Useful wrapper for result type of Markov Chain Monte Carlo moves
 ///
+/// The result takes 8 bytes and is trivially copyable, so that batches of
+/// results are cheap to store and to process (see BasicMoveStats::AddBatch):
+/// the status lives in the two lowest bits of the mantissa of the
+/// probability, which must be finite and loses at most two units in the
+/// last place. A default constructed result is impossible.
+///
 class MoveResult
 {
 public:
   /// Default constructor
   MoveResult() = default;
 
-  /// Copy constructor
-  MoveResult(const MoveResult&) = default;
-
-  /// Copy assignment operator
-  MoveResult& operator=(const MoveResult&) = default;
-
-  /// Move constructor
-  MoveResult(MoveResult&&) = default;
-
-  /// Move assignment operator
-  MoveResult& operator=(MoveResult&&) = default;
-
   /// Constructor
   MoveResult(MoveStatus status, double prob)
-    : status_(status)
-    , prob_(prob)
-  {}
-
-  /// Default destructor
-  virtual ~MoveResult() = default;
+  {
+    std::memcpy(&bits_, &prob, sizeof(bits_));
+    bits_ = (bits_ & ~mask) | Encode(status);
+  }
 
   /// Check whether the move has been accepted
-  auto IsAccepted() const -> bool { return status_ == MoveStatus::Accepted; };
+  auto IsAccepted() const -> bool { return (bits_ & mask) == accepted; };
 
   /// Check whether the move has been rejected
-  auto IsRejected() const -> bool { return status_ == MoveStatus::Rejected; };
+  auto IsRejected() const -> bool { return (bits_ & mask) == rejected; };
 
   /// Check whether the move has been accepted
-  auto IsImpossible() const -> bool
-  {
-    return status_ == MoveStatus::Impossible;
-  };
+  auto IsImpossible() const -> bool { return (bits_ & mask) == impossible; };
 
   /// Return the probability of the move
-  [[nodiscard]] auto Probability() const -> double { return prob_; };
+  [[nodiscard]] auto Probability() const -> double
+  {
+    auto bits = bits_ & ~mask;
+    auto prob = 0.0;
+    std::memcpy(&prob, &bits, sizeof(prob));
+    return prob;
+  };
 
   /// Get the status
-  [[nodiscard]] auto GetStatus() const -> MoveStatus { return status_; };
+  [[nodiscard]] auto GetStatus() const -> MoveStatus
+  {
+    return IsAccepted()   ? MoveStatus::Accepted
+           : IsRejected() ? MoveStatus::Rejected
+                          : MoveStatus::Impossible;
+  };
 
   /// @name Builders
   /// @{
@@ -84,14 +89,33 @@ public:
   /// @}
 
 protected:
+  /// Code of a status
+  [[nodiscard]] static constexpr auto Encode(MoveStatus status)
+    -> std::uint64_t
+  {
+    return status == MoveStatus::Accepted   ? accepted
+           : status == MoveStatus::Rejected ? rejected
+                                            : impossible;
+  };
+
 private:
-  /// Returned status of the move
-  MoveStatus status_{ MoveStatus::Impossible };
+  /// Bits holding the status
+  static constexpr std::uint64_t mask = 3U;
 
-  /// Returned probability of the move
-  double prob_{ 0.0 };
+  /// @name Codes of the statuses
+  /// @{
+  static constexpr std::uint64_t impossible = 0U;
+  static constexpr std::uint64_t accepted = 1U;
+  static constexpr std::uint64_t rejected = 2U;
+  /// @}
+
+  /// Probability of the move with the status in the lowest bits
+  std::uint64_t bits_{ 0U };
 }; // class MoveResult
 
+static_assert(sizeof(MoveResult) == 8UL);
+static_assert(std::is_trivially_copyable<MoveResult>::value);
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
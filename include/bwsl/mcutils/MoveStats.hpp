@@ -18,6 +18,7 @@
 #include <bwsl/Accumulators.hpp>
 #include <bwsl/mcutils/MoveResult.hpp>
 #include <bwsl/mcutils/MoveStatus.hpp>
+#include <bwsl/mcutils/MoveTimer.hpp>
 
 // fmt
 #include <fmt/format.h>
@@ -28,9 +29,13 @@
 #include <boost/serialization/version.hpp>
 
 // std
+#include <algorithm>
 #include <exception>
 #include <ostream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace bwsl::montecarlo {
 
@@ -87,48 +92,118 @@ private:
 ///
 /// Keeps statistics of a Markov Chain Monte Carlo move.
 ///
-class MoveStats
+/// With @p Checked the sequence of proposals, acceptances and rejections is
+/// validated and the probabilities are summed with Kahan compensation. The
+/// unchecked version, FastMoveStats, is meant for the inner loop of
+/// production runs: every call is a couple of increments and a plain sum,
+/// with no branches and nothing thrown.
+///
+/// The @p Timer policy measures the cost of the proposals made through Run,
+/// or between Propose and the call which ends the proposal, see
+/// SampledMoveTimer. The default NoMoveTimer is empty and does nothing.
+///
+template<bool Checked = true, class Timer = NoMoveTimer>
+class BasicMoveStats final : private Timer
 {
 public:
   /// Default constructor
-  MoveStats() = default;
+  BasicMoveStats() = default;
 
   /// Copy constructor
-  MoveStats(const MoveStats&) = default;
+  BasicMoveStats(const BasicMoveStats&) = default;
 
   /// Copy assignment operator
-  MoveStats& operator=(const MoveStats&) = default;
+  BasicMoveStats& operator=(const BasicMoveStats&) = default;
 
   /// Move constructor
-  MoveStats(MoveStats&&) = default;
+  BasicMoveStats(BasicMoveStats&&) = default;
 
   /// Move assignment operator
-  MoveStats& operator=(MoveStats&&) = default;
+  BasicMoveStats& operator=(BasicMoveStats&&) = default;
 
   /// Construct a statistics for a named move
-  MoveStats(std::string name);
+  BasicMoveStats(std::string name);
 
   /// Default destructor
-  virtual ~MoveStats() = default;
+  ~BasicMoveStats() = default;
 
   /// Propose a move
-  auto Propose() -> void { UpdateIfNotProposed(proposed_); };
+  auto Propose() -> void
+  {
+    UpdateIfNotProposed(proposed_);
+    Timer::Start();
+  };
 
   /// The proposed move has been accepted
-  auto Accept(double prob) -> void { UpdateIfProposed(accepted_, prob); };
+  auto Accept(double prob) -> void
+  {
+    UpdateIfProposed(accepted_, prob);
+    Timer::Stop(MoveStatus::Accepted);
+  };
 
   /// The proposed move has been rejected
-  auto Reject(double prob) -> void { UpdateIfProposed(rejected_, prob); };
+  auto Reject(double prob) -> void
+  {
+    UpdateIfProposed(rejected_, prob);
+    Timer::Stop(MoveStatus::Rejected);
+  };
 
   /// The proposed move is impossible to carry out.
-  auto Impossible() -> void { UpdateIfProposed(impossible_, 0.0); };
+  auto Impossible() -> void
+  {
+    UpdateIfProposed(impossible_, 0.0);
+    Timer::Stop(MoveStatus::Impossible);
+  };
 
-  /// Add to the statistics
+  /// Add to the statistics, the move is not timed
   auto Add(MoveResult const& res) -> void;
 
+  /// Add the @p n results from @p results to the statistics, as many calls
+  /// to Add would do but with vectorized loops
+  auto AddBatch(MoveResult const* results, size_t n) -> void;
+
+  /// Add the results to the statistics
+  auto AddBatch(std::vector<MoveResult> const& results) -> void
+  {
+    AddBatch(results.data(), results.size());
+  };
+
+  /// Propose the move @p move, a callable returning a MoveResult, timing
+  /// it, and add its result to the statistics
+  template<class Fn>
+  auto Run(Fn&& move) -> MoveResult;
+
+  /// Add the statistics collected by another instance, for example by
+  /// another thread
+  auto Merge(BasicMoveStats const& that) -> void;
+
   /// Get the name of the move
   [[nodiscard]] auto GetName() const -> std::string { return name_; };
 
+  /// Number of proposals
+  [[nodiscard]] auto GetProposed() const -> unsigned long
+  {
+    return proposed_;
+  };
+
+  /// Number of accepted proposals
+  [[nodiscard]] auto GetAccepted() const -> unsigned long
+  {
+    return accepted_;
+  };
+
+  /// Number of rejected proposals
+  [[nodiscard]] auto GetRejected() const -> unsigned long
+  {
+    return rejected_;
+  };
+
+  /// Number of impossible proposals
+  [[nodiscard]] auto GetImpossible() const -> unsigned long
+  {
+    return impossible_;
+  };
+
   /// Compute the acceptance from the collected statistics
   [[nodiscard]] auto GetAcceptedRatio() const -> double
   {
@@ -148,14 +223,14 @@ public:
   };
 
   /// Compute the average acceptance
-  [[nodiscard]] auto GetAverageProbability() const -> double
-  {
-    return prob_.Mean();
-  };
+  [[nodiscard]] auto GetAverageProbability() const -> double;
 
   /// Reset all the counters
   auto Reset() -> void;
 
+  /// The timer
+  [[nodiscard]] auto GetTimer() const -> Timer const& { return *this; };
+
 protected:
   template<typename T>
   auto UpdateIfProposed(T& var, double prob) -> void;
@@ -164,10 +239,15 @@ protected:
   auto UpdateIfNotProposed(T& varm) -> void;
 
 private:
+  /// Compensated sum when checked, plain sum otherwise
+  using prob_type =
+    std::conditional_t<Checked, accumulators::KahanAccumulator, double>;
+
   /// Name for identify the move
   std::string name_{ "Unknown" };
 
-  /// Checks to se if a move has been proposed but not accepted or rejected yet
+  /// Checks to se if a move has been proposed but not accepted or rejected
+  /// yet, unused when not checked
   bool proposedflag_{ false };
 
   /// Number of times the move has been proposed
@@ -183,23 +263,48 @@ private:
   unsigned long impossible_{ 0UL };
 
   /// Probability
-  accumulators::KahanAccumulator prob_{};
+  prob_type prob_{};
 
   /// Serialization
   friend class boost::serialization::access;
 
   /// Ostream operator
-  friend auto operator<<(std::ostream& os, const MoveStats& dt)
-    -> std::ostream&;
+  friend auto operator<<(std::ostream& os, const BasicMoveStats& dt)
+    -> std::ostream&
+  {
+    fmt::print(os,
+               "{}(accepted = {:.3e}, rejected = {:.3e}, impossible = {:.3e}, "
+               "probability = {:.3e}",
+               dt.name_,
+               dt.GetAcceptedRatio(),
+               dt.GetRejectedRatio(),
+               dt.GetImpossibleRatio(),
+               dt.GetAverageProbability());
+    dt.GetTimer().Print(os);
+    os << ")";
+    return os;
+  }
 
   //// Serialization method for the class
   template<class Archive>
   auto serialize(Archive& ar, const unsigned int version) -> void;
-}; // class MoveStats
+}; // class BasicMoveStats
 
+/// Statistics of a move, checking the sequence of calls
+using MoveStats = BasicMoveStats<true>;
+
+/// Statistics of a move, without checks, for production runs
+using FastMoveStats = BasicMoveStats<false>;
+
+/// Statistics of a move, without checks, timing one proposal every 64
+using TimedMoveStats = BasicMoveStats<false, SampledMoveTimer<>>;
+
+template<bool Checked, class Timer>
 template<class Archive>
 inline auto
-MoveStats::serialize(Archive& ar, const unsigned int /* version */) -> void
+BasicMoveStats<Checked, Timer>::serialize(Archive& ar,
+                                          const unsigned int /* version */)
+  -> void
 {
   // clang-format off
   ar & prob_;
@@ -209,52 +314,148 @@ MoveStats::serialize(Archive& ar, const unsigned int /* version */) -> void
   ar & impossible_;
   ar & proposedflag_;
   // clang-format on
+
+  // without a timer the archives stay as they were before the timers
+  if constexpr (!std::is_same<Timer, NoMoveTimer>::value) {
+    ar& static_cast<Timer&>(*this);
+  }
 }
 
-inline MoveStats::MoveStats(std::string name)
+template<bool Checked, class Timer>
+inline BasicMoveStats<Checked, Timer>::BasicMoveStats(std::string name)
   : name_(std::move(name))
 {}
 
+template<bool Checked, class Timer>
 template<typename T>
 inline auto
-MoveStats::UpdateIfProposed(T& var, double prob) -> void
+BasicMoveStats<Checked, Timer>::UpdateIfProposed(T& var, double prob) -> void
 {
-  if (!proposedflag_) {
-    throw exception::MoveInvalidSequence(name_);
+  if constexpr (Checked) {
+    if (!proposedflag_) {
+      throw exception::MoveInvalidSequence(name_);
+    }
+    proposedflag_ = false;
+    prob_.Add(prob);
+  } else {
+    prob_ += prob;
   }
 
   var += 1UL;
-  proposedflag_ = false;
-  prob_.Add(prob);
 }
 
+template<bool Checked, class Timer>
 template<typename T>
 inline auto
-MoveStats::UpdateIfNotProposed(T& var) -> void
+BasicMoveStats<Checked, Timer>::UpdateIfNotProposed(T& var) -> void
 {
-  if (proposedflag_) {
-    throw exception::MoveInvalidSequence(name_);
+  if constexpr (Checked) {
+    if (proposedflag_) {
+      throw exception::MoveInvalidSequence(name_);
+    }
+    proposedflag_ = true;
   }
 
   var += 1UL;
-  proposedflag_ = true;
 }
 
+template<bool Checked, class Timer>
+inline auto
+BasicMoveStats<Checked, Timer>::GetAverageProbability() const -> double
+{
+  if constexpr (Checked) {
+    return prob_.Mean();
+  } else {
+    return prob_ / static_cast<double>(accepted_ + rejected_ + impossible_);
+  }
+}
+
+template<bool Checked, class Timer>
 inline auto
-MoveStats::Reset() -> void
+BasicMoveStats<Checked, Timer>::Reset() -> void
 {
   proposed_ = 0UL;
   accepted_ = 0UL;
   rejected_ = 0UL;
   impossible_ = 0UL;
   proposedflag_ = false;
-  prob_.Reset();
+  prob_ = prob_type{};
+  Timer::Reset();
 }
 
+template<bool Checked, class Timer>
 inline auto
-MoveStats::Add(MoveResult const& res) -> void
+BasicMoveStats<Checked, Timer>::Add(MoveResult const& res) -> void
+{
+  UpdateIfNotProposed(proposed_);
+
+  switch (res.GetStatus()) {
+    case MoveStatus::Accepted:
+      UpdateIfProposed(accepted_, res.Probability());
+      break;
+    case MoveStatus::Rejected:
+      UpdateIfProposed(rejected_, res.Probability());
+      break;
+    case MoveStatus::Impossible:
+      UpdateIfProposed(impossible_, 0.0);
+      break;
+  }
+}
+
+template<bool Checked, class Timer>
+inline auto
+BasicMoveStats<Checked, Timer>::AddBatch(MoveResult const* results, size_t n)
+  -> void
+{
+  if constexpr (Checked) {
+    if (proposedflag_) {
+      throw exception::MoveInvalidSequence(name_);
+    }
+  }
+
+  // blocks of probabilities for the compensated sum
+  constexpr auto block = 256UL;
+  double probs[block];
+  for (auto first = 0UL; first < n; first += block) {
+    auto const m = std::min(block, n - first);
+    auto const* res = results + first;
+    auto accepted = 0UL;
+    auto rejected = 0UL;
+    for (auto i = 0UL; i < m; i++) {
+      accepted += res[i].IsAccepted() ? 1UL : 0UL;
+      rejected += res[i].IsRejected() ? 1UL : 0UL;
+      probs[i] = res[i].IsImpossible() ? 0.0 : res[i].Probability();
+    }
+    accepted_ += accepted;
+    rejected_ += rejected;
+    impossible_ += m - accepted - rejected;
+
+    if constexpr (Checked) {
+      prob_.AddBatch(probs, m);
+    } else {
+      double sum[4] = {};
+      auto i = 0UL;
+      for (; i + 4UL <= m; i += 4UL) {
+        for (auto l = 0UL; l < 4UL; l++) {
+          sum[l] += probs[i + l];
+        }
+      }
+      for (; i < m; i++) {
+        sum[0] += probs[i];
+      }
+      prob_ += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+  }
+  proposed_ += n;
+}
+
+template<bool Checked, class Timer>
+template<class Fn>
+inline auto
+BasicMoveStats<Checked, Timer>::Run(Fn&& move) -> MoveResult
 {
   Propose();
+  auto res = std::forward<Fn>(move)();
 
   switch (res.GetStatus()) {
     case MoveStatus::Accepted:
@@ -267,21 +468,29 @@ MoveStats::Add(MoveResult const& res) -> void
       Impossible();
       break;
   }
+  return res;
 }
 
+template<bool Checked, class Timer>
 inline auto
-operator<<(std::ostream& os, const MoveStats& dt) -> std::ostream&
+BasicMoveStats<Checked, Timer>::Merge(BasicMoveStats const& that) -> void
 {
-  fmt::print(os,
-             "{}(accepted = {:.3e}, rejected = {:.3e}, impossible = {:.3e}, "
-             "probability = {:.3e})",
-             dt.name_,
-             dt.GetAcceptedRatio(),
-             dt.GetRejectedRatio(),
-             dt.GetImpossibleRatio(),
-             dt.GetAverageProbability());
-  return os;
+  if constexpr (Checked) {
+    if (proposedflag_ || that.proposedflag_) {
+      throw exception::MoveInvalidSequence(name_);
+    }
+    prob_.Merge(that.prob_);
+  } else {
+    prob_ += that.prob_;
+  }
+
+  proposed_ += that.proposed_;
+  accepted_ += that.accepted_;
+  rejected_ += that.rejected_;
+  impossible_ += that.impossible_;
+  Timer::Merge(that.GetTimer());
 }
+
 } // namespace bwsl
 
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,277 @@
+//===-- MoveTimer.hpp ------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Timing policies for the statistics of the moves
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/accumulators/NeumaierAccumulator.hpp>
+#include <bwsl/mcutils/MoveStatus.hpp>
+
+// fmt
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+// boost
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace bwsl::montecarlo {
+
+///
+/// Timing policy of BasicMoveStats which does not time anything.
+///
+/// The class is empty and every method does nothing, so the statistics do
+/// not grow and the calls vanish.
+///
+class NoMoveTimer
+{
+public:
+  /// A proposal starts
+  auto Start() -> void {};
+
+  /// The proposal ended with @p status
+  auto Stop(MoveStatus /* status */) -> void {};
+
+  /// Add the times of another timer
+  auto Merge(NoMoveTimer const& /* that */) -> void {};
+
+  /// Reset the times
+  auto Reset() -> void {};
+
+  /// Print the times
+  auto Print(std::ostream& /* os */) const -> void {};
+
+private:
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& /* ar */, const unsigned int /* version */)
+  {}
+}; // class NoMoveTimer
+
+///
+/// Timing policy of BasicMoveStats which times one proposal every @p N.
+///
+/// The time of a proposal is measured with std::chrono::steady_clock, which
+/// costs some tens of nanoseconds, only once every @p N proposals, so that
+/// the overhead on the others is an increment and a test. The times are
+/// summed separately for accepted, rejected and impossible proposals and
+/// counted in a histogram with bins of increasing powers of two
+/// nanoseconds.
+///
+template<unsigned long N = 64UL>
+class SampledMoveTimer
+{
+  static_assert(N > 0UL && (N & (N - 1UL)) == 0UL,
+                "The sampling period must be a power of two");
+
+public:
+  /// Number of bins of the histogram, the last one collects the longest
+  /// proposals
+  static constexpr size_t nbins = 40UL;
+
+  /// A proposal starts
+  auto Start() -> void
+  {
+    if ((count_++ & (N - 1UL)) == 0UL) {
+      active_ = true;
+      start_ = clock::now();
+    }
+  };
+
+  /// The proposal ended with @p status
+  auto Stop(MoveStatus status) -> void;
+
+  /// Add the times of another timer
+  auto Merge(SampledMoveTimer const& that) -> void;
+
+  /// Reset the times
+  auto Reset() -> void;
+
+  /// Print the times
+  auto Print(std::ostream& os) const -> void;
+
+  /// Number of timed proposals
+  [[nodiscard]] auto GetSamples() const -> unsigned long;
+
+  /// Mean time of a proposal, in nanoseconds
+  [[nodiscard]] auto GetMeanTime() const -> double;
+
+  /// Mean time of a proposal with the given outcome, in nanoseconds
+  [[nodiscard]] auto GetMeanTime(MoveStatus status) const -> double
+  {
+    auto const& t = times_[Index(status)];
+    return t.Count() == 0UL ? 0.0 : t.Mean();
+  };
+
+  /// Histogram of the times, the bin i counts the proposals which took
+  /// [2^i, 2^(i + 1)) nanoseconds
+  [[nodiscard]] auto GetHistogram() const
+    -> std::array<unsigned long, nbins> const&
+  {
+    return hist_;
+  };
+
+protected:
+  /// Index of an outcome
+  [[nodiscard]] static constexpr auto Index(MoveStatus status) -> size_t
+  {
+    return status == MoveStatus::Accepted   ? 0UL
+           : status == MoveStatus::Rejected ? 1UL
+                                            : 2UL;
+  };
+
+private:
+  /// The clock
+  using clock = std::chrono::steady_clock;
+
+  /// Number of proposals started
+  unsigned long count_{ 0UL };
+
+  /// Check if the current proposal is timed
+  bool active_{ false };
+
+  /// Start of the current proposal
+  clock::time_point start_{};
+
+  /// Times of the accepted, rejected and impossible proposals
+  std::array<accumulators::NeumaierAccumulator, 3> times_{};
+
+  /// Histogram of the times
+  std::array<unsigned long, nbins> hist_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class SampledMoveTimer
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::Stop(MoveStatus status) -> void
+{
+  if (!active_) {
+    return;
+  }
+  active_ = false;
+
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+              clock::now() - start_)
+              .count();
+  times_[Index(status)].Add(static_cast<double>(ns));
+
+  auto bin = 0UL;
+  for (auto t = static_cast<std::uint64_t>(ns); t > 1U && bin + 1UL < nbins;
+       t >>= 1U) {
+    bin++;
+  }
+  hist_[bin]++;
+}
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::Merge(SampledMoveTimer const& that) -> void
+{
+  count_ += that.count_;
+  for (auto i = 0UL; i < times_.size(); i++) {
+    times_[i].Merge(that.times_[i]);
+  }
+  for (auto i = 0UL; i < nbins; i++) {
+    hist_[i] += that.hist_[i];
+  }
+}
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::Reset() -> void
+{
+  count_ = 0UL;
+  active_ = false;
+  for (auto& t : times_) {
+    t.Reset();
+  }
+  hist_.fill(0UL);
+}
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::GetSamples() const -> unsigned long
+{
+  auto n = 0UL;
+  for (auto const& t : times_) {
+    n += t.Count();
+  }
+  return n;
+}
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::GetMeanTime() const -> double
+{
+  auto sum = accumulators::NeumaierAccumulator{};
+  for (auto const& t : times_) {
+    sum.Merge(t);
+  }
+  return sum.Count() == 0UL ? 0.0 : sum.Mean();
+}
+
+template<unsigned long N>
+inline auto
+SampledMoveTimer<N>::Print(std::ostream& os) const -> void
+{
+  fmt::print(os,
+             ", time = {:.1f} ns (accepted = {:.1f} ns, rejected = {:.1f} ns, "
+             "impossible = {:.1f} ns), histogram = {{",
+             GetMeanTime(),
+             GetMeanTime(MoveStatus::Accepted),
+             GetMeanTime(MoveStatus::Rejected),
+             GetMeanTime(MoveStatus::Impossible));
+  auto first = true;
+  for (auto i = 0UL; i < nbins; i++) {
+    if (hist_[i] != 0UL) {
+      fmt::print(os, "{}{} ns: {}", first ? "" : ", ", 1UL << i, hist_[i]);
+      first = false;
+    }
+  }
+  os << "}";
+}
+
+template<unsigned long N>
+template<class Archive>
+inline auto
+SampledMoveTimer<N>::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & count_;
+  ar & times_;
+  ar & hist_;
+  // clang-format on
+  active_ = false;
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
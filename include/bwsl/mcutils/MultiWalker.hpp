@@ -0,0 +1,220 @@
+//===-- MultiWalker.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the MultiWalker Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/Philox.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UniformBuffer.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+///
+/// Driver for many independent walkers (replicas, Markov chains) of a
+/// Monte Carlo simulation.
+///
+/// Every walker owns its state, the stream of a random generator numbered
+/// as the walker (see Philox4x32::Split, a UniformBuffer around it works as
+/// well) and a private @p Accumulator. A block runs the same number of steps
+/// on every walker, one task per walker on a ThreadPool, then the private
+/// accumulators are merged in the order of the walkers into the result of
+/// the block and emptied.
+///
+/// A walker only touches its own slot, padded to a cache line, and the
+/// merge order is fixed, so the results are the same bit for bit whatever
+/// the number of threads, provided the step does not share state between
+/// walkers. The @p Accumulator needs a Merge method, like
+/// accumulators::NeumaierAccumulator or BasicMoveStats.
+///
+template<class Walker, class Accumulator, class Engine = Philox4x32>
+class MultiWalker
+{
+public:
+  /// Default constructor
+  MultiWalker() = default;
+
+  /// Drive @p walkers, the walker i drawing from the stream i of the seed
+  /// @p seed
+  MultiWalker(std::vector<Walker> walkers, std::uint64_t seed);
+
+  /// Copy constructor
+  MultiWalker(MultiWalker const& that) = default;
+
+  /// Move constructor
+  MultiWalker(MultiWalker&& that) = default;
+
+  /// Default destructor
+  ~MultiWalker() = default;
+
+  /// Copy assignment operator
+  auto operator=(MultiWalker const& that) -> MultiWalker& = default;
+
+  /// Move assignment operator
+  auto operator=(MultiWalker&& that) -> MultiWalker& = default;
+
+  /// Run a block of @p nsteps calls to @p step(walker, rng, accumulator)
+  /// for every walker on @p pool, returns the merged accumulator
+  template<class StepFn>
+  auto RunBlock(ThreadPool& pool, size_t nsteps, StepFn step)
+    -> Accumulator const&;
+
+  /// Results of the blocks run so far
+  [[nodiscard]] auto GetBlocks() const -> std::vector<Accumulator> const&
+  {
+    return blocks_;
+  };
+
+  /// A walker
+  [[nodiscard]] auto GetWalker(size_t i) const -> Walker const&
+  {
+    return slots_[i].walker;
+  };
+
+  /// The generator of a walker
+  [[nodiscard]] auto GetEngine(size_t i) const -> Engine const&
+  {
+    return slots_[i].engine;
+  };
+
+  /// Number of walkers
+  [[nodiscard]] auto GetNumWalkers() const -> size_t { return slots_.size(); };
+
+  /// The seed
+  [[nodiscard]] auto GetSeed() const -> std::uint64_t { return seed_; };
+
+protected:
+  /// The generator of the stream @p stream
+  [[nodiscard]] static auto MakeEngine(std::uint64_t seed,
+                                       std::uint64_t stream) -> Engine;
+
+private:
+  /// State of a walker, alone in its cache lines
+  struct alignas(64) Slot
+  {
+    /// The walker
+    Walker walker{};
+
+    /// Its generator
+    Engine engine{};
+
+    /// Its private accumulator
+    Accumulator acc{};
+
+    /// Serialization method for the struct
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      // clang-format off
+      ar & walker;
+      ar & engine;
+      ar & acc;
+      // clang-format on
+    }
+  };
+
+  /// The seed
+  std::uint64_t seed_{ 0UL };
+
+  /// The walkers
+  std::vector<Slot> slots_{};
+
+  /// Results of the blocks
+  std::vector<Accumulator> blocks_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class MultiWalker
+
+template<class Walker, class Accumulator, class Engine>
+inline MultiWalker<Walker, Accumulator, Engine>::MultiWalker(
+  std::vector<Walker> walkers,
+  std::uint64_t seed)
+  : seed_(seed)
+  , slots_(walkers.size())
+{
+  for (auto i = 0UL; i < slots_.size(); i++) {
+    slots_[i].walker = std::move(walkers[i]);
+    slots_[i].engine = MakeEngine(seed, i);
+  }
+}
+
+template<class Walker, class Accumulator, class Engine>
+inline auto
+MultiWalker<Walker, Accumulator, Engine>::MakeEngine(std::uint64_t seed,
+                                                     std::uint64_t stream)
+  -> Engine
+{
+  if constexpr (is_uniform_buffer<Engine>::value) {
+    return Engine(Philox4x32(seed).Split(stream));
+  } else {
+    return Engine(seed).Split(stream);
+  }
+}
+
+template<class Walker, class Accumulator, class Engine>
+template<class StepFn>
+inline auto
+MultiWalker<Walker, Accumulator, Engine>::RunBlock(ThreadPool& pool,
+                                                   size_t nsteps,
+                                                   StepFn step)
+  -> Accumulator const&
+{
+  pool.ParallelFor(0UL, slots_.size(), [&](size_t i) {
+    auto& s = slots_[i];
+    for (auto k = 0UL; k < nsteps; k++) {
+      step(s.walker, s.engine, s.acc);
+    }
+  });
+
+  auto block = Accumulator{};
+  for (auto& s : slots_) {
+    block.Merge(s.acc);
+    s.acc = Accumulator{};
+  }
+  blocks_.push_back(std::move(block));
+  return blocks_.back();
+}
+
+template<class Walker, class Accumulator, class Engine>
+template<class Archive>
+inline auto
+MultiWalker<Walker, Accumulator, Engine>::serialize(
+  Archive& ar,
+  const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & seed_;
+  ar & slots_;
+  ar & blocks_;
+  // clang-format on
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,462 @@
+//===-- ParallelTempering.hpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the ParallelTempering Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+namespace exception {
+
+/// The number of temperatures differs from the number of replicas
+class TemperatureMismatch : public std::exception
+{
+public:
+  TemperatureMismatch(size_t nreplicas, size_t ntemperatures)
+    : message_(fmt::format("{} replicas for {} temperatures",
+                           nreplicas,
+                           ntemperatures))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class TemperatureMismatch
+
+} // namespace bwsl::montecarlo::exception
+
+///
+/// Replica exchange Monte Carlo (parallel tempering).
+///
+/// Every replica runs at one of the temperatures, all of them at the same
+/// time, one task per replica on a ThreadPool. After the sweeps the
+/// replicas at neighboring temperatures try to exchange their temperatures,
+/// the pairs starting at even and odd temperatures in turn, and the swap is
+/// accepted with probability min(1, exp((b_t - b_{t+1}) (E - E'))).
+///
+/// A swap exchanges the temperature labels of the two replicas, never their
+/// configurations, so nothing is copied whatever the size of a replica.
+/// The swaps are proposed between two rounds of sweeps, when no task runs,
+/// and the pairs are disjoint, so the labels need no lock. The statistics
+/// of the swaps of every pair of neighboring temperatures are kept in a
+/// MoveStats, and Retune moves the temperatures to make the measured swap
+/// rates equal.
+///
+/// Every replica draws from its own stream of @p Engine and the swaps from
+/// another one, so the results are the same whatever the number of threads.
+///
+template<class Replica, class Engine = Philox4x32>
+class ParallelTempering
+{
+public:
+  /// Default constructor
+  ParallelTempering() = default;
+
+  /// Run @p replicas at the temperatures @p temperatures, sorted either way,
+  /// the replica i starting at the temperature i and drawing from the
+  /// stream i of the seed @p seed
+  ParallelTempering(std::vector<Replica> replicas,
+                    std::vector<double> const& temperatures,
+                    std::uint64_t seed);
+
+  /// Copy constructor
+  ParallelTempering(ParallelTempering const& that) = default;
+
+  /// Move constructor
+  ParallelTempering(ParallelTempering&& that) = default;
+
+  /// Default destructor
+  ~ParallelTempering() = default;
+
+  /// Copy assignment operator
+  auto operator=(ParallelTempering const& that)
+    -> ParallelTempering& = default;
+
+  /// Move assignment operator
+  auto operator=(ParallelTempering&& that) -> ParallelTempering& = default;
+
+  /// Run @p nsweeps calls to @p step(replica, beta, rng) for every replica
+  /// on @p pool, measure @p energy(replica) and propose the swaps
+  template<class StepFn, class EnergyFn>
+  auto Step(ThreadPool& pool, size_t nsweeps, StepFn step, EnergyFn energy)
+    -> void;
+
+  /// Move the temperatures, keeping the first and the last, so that the
+  /// swap rates measured since the last call become equal, then reset the
+  /// statistics of the swaps. Must be repeated until the rates converge and
+  /// stopped before the production run
+  auto Retune() -> void;
+
+  /// Temperature of the label @p t
+  [[nodiscard]] auto GetTemperature(size_t t) const -> double
+  {
+    return 1.0 / betas_[t];
+  };
+
+  /// The temperatures
+  [[nodiscard]] auto GetTemperatures() const -> std::vector<double>;
+
+  /// Inverse temperature of the replica @p r
+  [[nodiscard]] auto GetBeta(size_t r) const -> double
+  {
+    return betas_[labels_[r]];
+  };
+
+  /// Temperature label of the replica @p r
+  [[nodiscard]] auto GetLabel(size_t r) const -> size_t
+  {
+    return labels_[r];
+  };
+
+  /// Index of the replica at the temperature label @p t
+  [[nodiscard]] auto GetReplicaAt(size_t t) const -> size_t
+  {
+    return replicas_[t];
+  };
+
+  /// A replica
+  [[nodiscard]] auto GetReplica(size_t r) const -> Replica const&
+  {
+    return slots_[r].replica;
+  };
+
+  /// The replica at the temperature label @p t
+  [[nodiscard]] auto GetReplicaAtTemperature(size_t t) const -> Replica const&
+  {
+    return slots_[replicas_[t]].replica;
+  };
+
+  /// Energy of the replica @p r measured by the last step
+  [[nodiscard]] auto GetEnergy(size_t r) const -> double
+  {
+    return slots_[r].energy;
+  };
+
+  /// Statistics of the swaps between the labels @p t and @p t + 1
+  [[nodiscard]] auto GetSwapStats(size_t t) const -> MoveStats const&
+  {
+    return swaps_[t];
+  };
+
+  /// Number of trips of the replicas from the lowest to the highest
+  /// temperature and back
+  [[nodiscard]] auto GetRoundTrips() const -> unsigned long
+  {
+    return roundtrips_;
+  };
+
+  /// Number of replicas
+  [[nodiscard]] auto GetSize() const -> size_t { return slots_.size(); };
+
+protected:
+  /// The generator of the stream @p stream
+  [[nodiscard]] static auto MakeEngine(std::uint64_t seed,
+                                       std::uint64_t stream) -> Engine;
+
+  /// Statistics of the swaps between the labels @p t and @p t + 1, empty
+  [[nodiscard]] auto MakeSwapStats(size_t t) const -> MoveStats;
+
+  /// Propose the swaps of the pairs starting at labels of parity @p parity
+  auto Exchange(size_t parity) -> void;
+
+  /// Update the direction of the replica @p r after it reached the label
+  /// @p t, counting the round trips
+  auto Track(size_t r, size_t t) -> void;
+
+private:
+  /// State of a replica, alone in its cache lines
+  struct alignas(64) Slot
+  {
+    /// The replica
+    Replica replica{};
+
+    /// Its generator
+    Engine engine{};
+
+    /// Its last energy
+    double energy{ 0.0 };
+
+    /// Serialization method for the struct
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      // clang-format off
+      ar & replica;
+      ar & engine;
+      ar & energy;
+      // clang-format on
+    }
+  };
+
+  /// The seed
+  std::uint64_t seed_{ 0UL };
+
+  /// Inverse temperatures, by label
+  std::vector<double> betas_{};
+
+  /// The replicas
+  std::vector<Slot> slots_{};
+
+  /// Label of each replica
+  std::vector<size_t> labels_{};
+
+  /// Replica at each label
+  std::vector<size_t> replicas_{};
+
+  /// Last end of the temperatures reached by each replica: 1 the first, -1
+  /// the last, 0 none
+  std::vector<int> directions_{};
+
+  /// Completed round trips
+  unsigned long roundtrips_{ 0UL };
+
+  /// Statistics of the swaps of neighboring labels
+  std::vector<MoveStats> swaps_{};
+
+  /// Generator of the swaps
+  Engine rng_{};
+
+  /// Number of rounds of swaps proposed
+  unsigned long rounds_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class ParallelTempering
+
+template<class Replica, class Engine>
+inline ParallelTempering<Replica, Engine>::ParallelTempering(
+  std::vector<Replica> replicas,
+  std::vector<double> const& temperatures,
+  std::uint64_t seed)
+  : seed_(seed)
+  , betas_(temperatures.size())
+  , slots_(replicas.size())
+  , labels_(replicas.size())
+  , replicas_(replicas.size())
+  , directions_(replicas.size(), 0)
+  , rng_(MakeEngine(seed, replicas.size()))
+{
+  if (replicas.size() != temperatures.size()) {
+    throw exception::TemperatureMismatch(replicas.size(), temperatures.size());
+  }
+
+  for (auto i = 0UL; i < slots_.size(); i++) {
+    betas_[i] = 1.0 / temperatures[i];
+    slots_[i].replica = std::move(replicas[i]);
+    slots_[i].engine = MakeEngine(seed, i);
+    labels_[i] = i;
+    replicas_[i] = i;
+    Track(i, i);
+  }
+  for (auto t = 0UL; t + 1UL < slots_.size(); t++) {
+    swaps_.push_back(MakeSwapStats(t));
+  }
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::MakeEngine(std::uint64_t seed,
+                                               std::uint64_t stream) -> Engine
+{
+  if constexpr (is_uniform_buffer<Engine>::value) {
+    return Engine(Philox4x32(seed).Split(stream));
+  } else {
+    return Engine(seed).Split(stream);
+  }
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::MakeSwapStats(size_t t) const -> MoveStats
+{
+  return MoveStats(fmt::format("swap {} <-> {}", t, t + 1UL));
+}
+
+template<class Replica, class Engine>
+template<class StepFn, class EnergyFn>
+inline auto
+ParallelTempering<Replica, Engine>::Step(ThreadPool& pool,
+                                         size_t nsweeps,
+                                         StepFn step,
+                                         EnergyFn energy) -> void
+{
+  pool.ParallelFor(0UL, slots_.size(), [&](size_t r) {
+    auto& s = slots_[r];
+    auto const beta = betas_[labels_[r]];
+    for (auto k = 0UL; k < nsweeps; k++) {
+      step(s.replica, beta, s.engine);
+    }
+    s.energy = energy(static_cast<Replica const&>(s.replica));
+  });
+
+  Exchange(rounds_++ & 1UL);
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::Exchange(size_t parity) -> void
+{
+  for (auto t = parity; t + 1UL < slots_.size(); t += 2UL) {
+    auto const a = replicas_[t];
+    auto const b = replicas_[t + 1UL];
+    auto const delta =
+      (betas_[t] - betas_[t + 1UL]) * (slots_[a].energy - slots_[b].energy);
+    auto const prob = delta >= 0.0 ? 1.0 : std::exp(delta);
+
+    if (prob < 1.0 && draw_uniform(1.0, rng_) >= prob) {
+      swaps_[t].Add(MoveResult::Reject(prob));
+      continue;
+    }
+    swaps_[t].Add(MoveResult::Accept(prob));
+    std::swap(replicas_[t], replicas_[t + 1UL]);
+    labels_[a] = t + 1UL;
+    labels_[b] = t;
+    Track(a, t + 1UL);
+    Track(b, t);
+  }
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::Track(size_t r, size_t t) -> void
+{
+  if (t == 0UL) {
+    if (directions_[r] == -1) {
+      roundtrips_++;
+    }
+    directions_[r] = 1;
+  } else if (t + 1UL == slots_.size()) {
+    directions_[r] = -1;
+  }
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::Retune() -> void
+{
+  auto const n = betas_.size();
+  if (n < 3UL) {
+    return;
+  }
+
+  // the distance of two neighbors grows as their swap rate falls, the new
+  // temperatures split the total distance in equal parts, interpolating
+  // linearly in beta. The average probability is a less noisy estimate of
+  // the rate than the fraction of accepted swaps
+  auto cumul = std::vector<double>(n, 0.0);
+  for (auto t = 0UL; t + 1UL < n; t++) {
+    if (swaps_[t].GetProposed() == 0UL) {
+      return;
+    }
+    auto rate = std::clamp(swaps_[t].GetAverageProbability(), 1e-3, 1.0);
+    cumul[t + 1UL] = cumul[t] + std::max(-std::log(rate), 1e-3);
+  }
+
+  auto betas = betas_;
+  auto i = 0UL;
+  for (auto t = 1UL; t + 1UL < n; t++) {
+    auto target = cumul.back() * static_cast<double>(t) /
+                  static_cast<double>(n - 1UL);
+    while (cumul[i + 1UL] < target) {
+      i++;
+    }
+    auto frac = (target - cumul[i]) / (cumul[i + 1UL] - cumul[i]);
+    betas[t] = betas_[i] + frac * (betas_[i + 1UL] - betas_[i]);
+  }
+  betas_ = std::move(betas);
+
+  for (auto t = 0UL; t + 1UL < n; t++) {
+    swaps_[t] = MakeSwapStats(t);
+  }
+}
+
+template<class Replica, class Engine>
+inline auto
+ParallelTempering<Replica, Engine>::GetTemperatures() const
+  -> std::vector<double>
+{
+  auto temperatures = std::vector<double>(betas_.size());
+  std::transform(betas_.begin(),
+                 betas_.end(),
+                 temperatures.begin(),
+                 [](double beta) { return 1.0 / beta; });
+  return temperatures;
+}
+
+template<class Replica, class Engine>
+template<class Archive>
+inline auto
+ParallelTempering<Replica, Engine>::serialize(Archive& ar,
+                                              const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & seed_;
+  ar & betas_;
+  ar & slots_;
+  ar & labels_;
+  ar & replicas_;
+  ar & directions_;
+  ar & roundtrips_;
+  ar & rng_;
+  ar & rounds_;
+  // clang-format on
+
+  // the statistics do not store the names
+  if (typename Archive::is_loading()) {
+    swaps_.clear();
+    for (auto t = 0UL; t + 1UL < slots_.size(); t++) {
+      swaps_.push_back(MakeSwapStats(t));
+    }
+  }
+  for (auto& s : swaps_) {
+    ar& s;
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,165 @@
+//===-- PerThreadMoveStats.hpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the PerThreadMoveStats Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/mcutils/MoveStats.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+///
+/// Statistics of a move proposed by many threads.
+///
+/// Every thread updates its own statistics, in a slot aligned to a cache
+/// line so that the threads never write to the same line, and the slots are
+/// merged only when the totals are read.
+///
+template<class Stats = FastMoveStats>
+class PerThreadMoveStats
+{
+public:
+  /// Default constructor
+  PerThreadMoveStats() = default;
+
+  /// Statistics of the move @p name for @p nthreads threads
+  PerThreadMoveStats(std::string const& name, size_t nthreads);
+
+  /// Copy constructor
+  PerThreadMoveStats(PerThreadMoveStats const& that) = default;
+
+  /// Move constructor
+  PerThreadMoveStats(PerThreadMoveStats&& that) = default;
+
+  /// Default destructor
+  ~PerThreadMoveStats() = default;
+
+  /// Copy assignment operator
+  auto operator=(PerThreadMoveStats const& that)
+    -> PerThreadMoveStats& = default;
+
+  /// Move assignment operator
+  auto operator=(PerThreadMoveStats&& that) -> PerThreadMoveStats& = default;
+
+  /// Statistics of the thread @p thread, to be updated only by that thread
+  auto Get(size_t thread) -> Stats&
+  {
+    assert(thread < slots_.size());
+    return slots_[thread].stats;
+  };
+
+  /// Statistics of the thread @p thread
+  [[nodiscard]] auto Get(size_t thread) const -> Stats const&
+  {
+    assert(thread < slots_.size());
+    return slots_[thread].stats;
+  };
+
+  /// Statistics of all the threads together, not to be called while the
+  /// threads are updating them
+  [[nodiscard]] auto GetTotal() const -> Stats;
+
+  /// Number of threads
+  [[nodiscard]] auto GetNumThreads() const -> size_t { return slots_.size(); };
+
+  /// Reset the statistics of every thread
+  auto Reset() -> void;
+
+private:
+  /// Size of a cache line
+  static constexpr size_t cacheline_ = 64UL;
+
+  /// Statistics of a thread, alone in its cache lines
+  struct alignas(cacheline_) Slot
+  {
+    /// The statistics
+    Stats stats{};
+  };
+
+  /// Name of the move
+  std::string name_{ "Unknown" };
+
+  /// The slots of the threads
+  std::vector<Slot> slots_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class PerThreadMoveStats
+
+template<class Stats>
+inline PerThreadMoveStats<Stats>::PerThreadMoveStats(std::string const& name,
+                                                     size_t nthreads)
+  : name_(name)
+  , slots_(nthreads, Slot{ Stats(name) })
+{
+}
+
+template<class Stats>
+inline auto
+PerThreadMoveStats<Stats>::GetTotal() const -> Stats
+{
+  auto total = Stats(name_);
+  for (auto const& s : slots_) {
+    total.Merge(s.stats);
+  }
+  return total;
+}
+
+template<class Stats>
+inline auto
+PerThreadMoveStats<Stats>::Reset() -> void
+{
+  for (auto& s : slots_) {
+    s.stats.Reset();
+  }
+}
+
+template<class Stats>
+template<class Archive>
+inline auto
+PerThreadMoveStats<Stats>::serialize(Archive& ar,
+                                     const unsigned int /* version */) -> void
+{
+  auto n = slots_.size();
+  // clang-format off
+  ar & name_;
+  ar & n;
+  // clang-format on
+
+  // the statistics do not store the names
+  if (typename Archive::is_loading()) {
+    slots_.assign(n, Slot{ Stats(name_) });
+  }
+  for (auto& s : slots_) {
+    ar& s.stats;
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
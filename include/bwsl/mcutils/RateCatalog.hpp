@@ -0,0 +1,258 @@
+//===-- RateCatalog.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the RateCatalog Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/accumulators/NeumaierAccumulator.hpp>
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+#include <bwsl/sampling/FenwickTree.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+///
+/// An event drawn from a RateCatalog
+///
+struct KineticEvent
+{
+  /// Index of the event
+  size_t index{ 0UL };
+
+  /// Time elapsed before the event
+  double dt{ 0.0 };
+}; // struct KineticEvent
+
+///
+/// Rates of the events of a rejection free (kinetic) Monte Carlo.
+///
+/// The rates live in a tree of partial sums, by default a compensated
+/// sampling::FenwickTree, sampling::SumTree or sampling::KarySumTree work as
+/// well: changing a rate after an event and drawing the next event are both
+/// O(log n). Drawing an event also advances the simulated time by an
+/// exponential waiting time, accumulated with compensation.
+///
+/// Every event belongs to a channel, say diffusion or desorption, and each
+/// channel keeps a MoveStats with the outcome of its events.
+///
+template<class Tree = sampling::FenwickTree>
+class RateCatalog
+{
+public:
+  /// Default constructor
+  RateCatalog() = default;
+
+  /// A catalog of @p n events with zero rate, all in the first of the
+  /// given channels
+  explicit RateCatalog(size_t n,
+                       std::vector<std::string> const& channels = { "Event" });
+
+  /// Copy constructor
+  RateCatalog(RateCatalog const& that) = default;
+
+  /// Move constructor
+  RateCatalog(RateCatalog&& that) = default;
+
+  /// Default destructor
+  ~RateCatalog() = default;
+
+  /// Copy assignment operator
+  auto operator=(RateCatalog const& that) -> RateCatalog& = default;
+
+  /// Move assignment operator
+  auto operator=(RateCatalog&& that) -> RateCatalog& = default;
+
+  /// Change the rate of an event
+  auto SetRate(size_t idx, double rate) -> void { tree_.Set(idx, rate); };
+
+  /// Move an event to another channel
+  auto SetChannel(size_t idx, size_t channel) -> void;
+
+  /// Rate of an event
+  [[nodiscard]] auto GetRate(size_t idx) const -> double
+  {
+    return tree_.Get(idx);
+  };
+
+  /// Sum of the rates
+  [[nodiscard]] auto GetTotalRate() const -> double
+  {
+    return tree_.GetTotal();
+  };
+
+  /// Channel of an event
+  [[nodiscard]] auto GetChannel(size_t idx) const -> size_t
+  {
+    return channel_[idx];
+  };
+
+  /// Number of events
+  [[nodiscard]] auto GetSize() const -> size_t { return tree_.GetSize(); };
+
+  /// Number of channels
+  [[nodiscard]] auto GetNumChannels() const -> size_t
+  {
+    return stats_.size();
+  };
+
+  /// Draw the next event and advance the time, @p rng is a generator or a
+  /// UniformBuffer
+  template<typename G>
+  auto Select(G& rng) -> KineticEvent;
+
+  /// Add the outcome of an event to the statistics of its channel
+  auto Record(KineticEvent const& event, MoveResult const& res) -> void
+  {
+    stats_[channel_[event.index]].Add(res);
+  };
+
+  /// Draw the next event, carry it out with @p perform, which takes the
+  /// index of the event and returns a MoveResult, and record the outcome
+  template<typename G, typename Fn>
+  auto Step(G& rng, Fn&& perform) -> KineticEvent;
+
+  /// Simulated time
+  [[nodiscard]] auto GetTime() const -> double { return time_.Sum(); };
+
+  /// Statistics of a channel
+  [[nodiscard]] auto GetStats(size_t channel) const -> MoveStats const&
+  {
+    return stats_[channel];
+  };
+
+  /// Reset the statistics of all the channels
+  auto ResetStats() -> void;
+
+  /// The tree of the rates
+  [[nodiscard]] auto GetTree() const -> Tree const& { return tree_; };
+
+private:
+  /// Rates of the events
+  Tree tree_{};
+
+  /// Channel of each event
+  std::vector<size_t> channel_{};
+
+  /// Names of the channels
+  std::vector<std::string> names_{};
+
+  /// Statistics of each channel
+  std::vector<MoveStats> stats_{};
+
+  /// Simulated time
+  accumulators::NeumaierAccumulator time_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class RateCatalog
+
+template<class Tree>
+inline RateCatalog<Tree>::RateCatalog(size_t n,
+                                      std::vector<std::string> const& channels)
+  : tree_(n)
+  , channel_(n, 0UL)
+  , names_(channels)
+{
+  assert(!names_.empty());
+  for (auto const& name : names_) {
+    stats_.emplace_back(name);
+  }
+}
+
+template<class Tree>
+inline auto
+RateCatalog<Tree>::SetChannel(size_t idx, size_t channel) -> void
+{
+  assert(channel < stats_.size());
+  channel_[idx] = channel;
+}
+
+template<class Tree>
+template<typename G>
+inline auto
+RateCatalog<Tree>::Select(G& rng) -> KineticEvent
+{
+  auto const total = tree_.GetTotal();
+  auto event = KineticEvent{};
+  event.index = tree_.Sample(rng);
+  event.dt = -std::log1p(-draw_uniform(1.0, rng)) / total;
+  time_.Add(event.dt);
+  return event;
+}
+
+template<class Tree>
+template<typename G, typename Fn>
+inline auto
+RateCatalog<Tree>::Step(G& rng, Fn&& perform) -> KineticEvent
+{
+  auto event = Select(rng);
+  Record(event, std::forward<Fn>(perform)(event.index));
+  return event;
+}
+
+template<class Tree>
+inline auto
+RateCatalog<Tree>::ResetStats() -> void
+{
+  for (auto& s : stats_) {
+    s.Reset();
+  }
+}
+
+template<class Tree>
+template<class Archive>
+inline auto
+RateCatalog<Tree>::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & tree_;
+  ar & channel_;
+  ar & names_;
+  ar & time_;
+  // clang-format on
+
+  // the statistics do not store the names
+  if (typename Archive::is_loading()) {
+    stats_.clear();
+    for (auto const& name : names_) {
+      stats_.emplace_back(name);
+    }
+  }
+  for (auto& s : stats_) {
+    ar& s;
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
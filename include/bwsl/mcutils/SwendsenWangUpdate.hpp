@@ -0,0 +1,289 @@
+//===-- SwendsenWangUpdate.hpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the SwendsenWangUpdate Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UnionFind.hpp>
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+#include <bwsl/mcutils/WolffUpdate.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+///
+/// Multiple cluster update of Ising spins (Swendsen and Wang, Phys. Rev.
+/// Lett. 58, 86, 1987).
+///
+/// Every bond between equal spins is activated with the bond probability,
+/// see ising_bond_probability, the clusters of active bonds are labeled with
+/// a UnionFind and each one is flipped with probability one half.
+///
+/// The sites are split in blocks, slabs of the HyperCubicGrid along its
+/// first (slowest) dimension, which are contiguous ranges of sites. The
+/// bonds inside a block are drawn and united by one task per block on a
+/// ThreadPool, touching only the sets of its sites; the active bonds
+/// crossing two blocks are kept aside and united afterwards, then the
+/// clusters are flipped again block by block. Every block draws from its
+/// own Philox stream keyed by the generator of the step, so the result
+/// depends on the number of blocks but not on the number of threads.
+///
+/// The size of every cluster is counted in a HistAccumulator, and the flip
+/// of a cluster is recorded in a MoveStats as accepted or rejected with
+/// probability one half. The tables of the bonds are not serialized:
+/// construct the update from the lattice, then load its statistics.
+///
+class SwendsenWangUpdate
+{
+public:
+  /// Default constructor
+  SwendsenWangUpdate() = default;
+
+  /// Update the spins of @p lattice, split in @p nblocks slabs, with bond
+  /// probability @p padd
+  SwendsenWangUpdate(Lattice const& lattice,
+                     size_t nblocks = 1UL,
+                     double padd = 0.0);
+
+  /// Copy constructor
+  SwendsenWangUpdate(SwendsenWangUpdate const& that) = default;
+
+  /// Move constructor
+  SwendsenWangUpdate(SwendsenWangUpdate&& that) = default;
+
+  /// Default destructor
+  ~SwendsenWangUpdate() = default;
+
+  /// Copy assignment operator
+  auto operator=(SwendsenWangUpdate const& that)
+    -> SwendsenWangUpdate& = default;
+
+  /// Move assignment operator
+  auto operator=(SwendsenWangUpdate&& that) -> SwendsenWangUpdate& = default;
+
+  /// Change the bond probability, see ising_bond_probability
+  auto SetBondProbability(double padd) -> void { padd_ = padd; };
+
+  /// Label and flip the clusters of @p spins, the blocks running on
+  /// @p pool, returns the number of clusters
+  template<class Spin, class G>
+  auto Step(std::vector<Spin>& spins, G& rng, ThreadPool& pool) -> size_t;
+
+  /// Representative of the cluster of every site, after a step
+  [[nodiscard]] auto GetLabels() const -> std::vector<size_t> const&
+  {
+    return labels_;
+  };
+
+  /// Number of clusters of each size
+  [[nodiscard]] auto GetSizes() const -> HistAccumulator const&
+  {
+    return sizes_;
+  };
+
+  /// Statistics of the flips of the clusters
+  [[nodiscard]] auto GetStats() const -> MoveStats const& { return stats_; };
+
+  /// Bond probability
+  [[nodiscard]] auto GetBondProbability() const -> double { return padd_; };
+
+  /// Number of blocks
+  [[nodiscard]] auto GetNumBlocks() const -> size_t
+  {
+    return blocks_.size() - 1UL;
+  };
+
+  /// Reset the statistics
+  auto Reset() -> void;
+
+protected:
+  /// Draw the bonds of the block @p b, uniting the sites inside it
+  template<class Spin>
+  auto Bond(size_t b, std::vector<Spin> const& spins, std::uint64_t key)
+    -> void;
+
+private:
+  /// Bond probability
+  double padd_{ 0.0 };
+
+  /// Neighbors j > i of the site i, from first_[i] to first_[i + 1]
+  std::vector<size_t> neighbors_{};
+
+  /// Start of the neighbors of each site
+  std::vector<size_t> first_{ 0UL };
+
+  /// First site of each block, and the number of sites
+  std::vector<size_t> blocks_{ 0UL };
+
+  /// Active bonds between two blocks, by block of their first site
+  std::vector<std::vector<std::pair<size_t, size_t>>> crossing_{};
+
+  /// The clusters
+  UnionFind clusters_{};
+
+  /// Representative of the cluster of every site
+  std::vector<size_t> labels_{};
+
+  /// Check if each cluster, by representative, is flipped
+  std::vector<char> flips_{};
+
+  /// Number of clusters of each size
+  HistAccumulator sizes_{};
+
+  /// Statistics of the flips of the clusters
+  MoveStats stats_{ "swendsen-wang" };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class SwendsenWangUpdate
+
+inline SwendsenWangUpdate::SwendsenWangUpdate(Lattice const& lattice,
+                                              size_t nblocks,
+                                              double padd)
+  : padd_(padd)
+  , clusters_(lattice.GetNumSites())
+  , labels_(lattice.GetNumSites())
+  , flips_(lattice.GetNumSites())
+  , sizes_(lattice.GetNumSites() + 1UL)
+{
+  auto const n = lattice.GetNumSites();
+  first_.reserve(n + 1UL);
+  for (auto i = 0UL; i < n; i++) {
+    for (auto j : lattice.GetNeighbors(i)) {
+      if (j > i) {
+        neighbors_.push_back(j);
+      }
+    }
+    first_.push_back(neighbors_.size());
+  }
+
+  // slabs of whole planes of the first dimension
+  auto const planes = lattice.GetSize().front();
+  auto const stride = n / planes;
+  nblocks = std::clamp(nblocks, 1UL, planes);
+  for (auto b = 1UL; b <= nblocks; b++) {
+    blocks_.push_back(planes * b / nblocks * stride);
+  }
+  crossing_.resize(nblocks);
+}
+
+template<class Spin>
+inline auto
+SwendsenWangUpdate::Bond(size_t b,
+                         std::vector<Spin> const& spins,
+                         std::uint64_t key) -> void
+{
+  auto rng = Philox4x32(key, b);
+  auto const last = blocks_[b + 1UL];
+  auto& crossing = crossing_[b];
+  crossing.clear();
+  clusters_.Reset(blocks_[b], last);
+
+  for (auto i = blocks_[b]; i < last; i++) {
+    for (auto k = first_[i]; k < first_[i + 1UL]; k++) {
+      auto j = neighbors_[k];
+      if (spins[i] != spins[j] || draw_uniform(1.0, rng) >= padd_) {
+        continue;
+      }
+      if (j < last) {
+        clusters_.Unite(i, j);
+      } else {
+        crossing.emplace_back(i, j);
+      }
+    }
+  }
+}
+
+template<class Spin, class G>
+inline auto
+SwendsenWangUpdate::Step(std::vector<Spin>& spins, G& rng, ThreadPool& pool)
+  -> size_t
+{
+  auto const nblocks = GetNumBlocks();
+  auto key = static_cast<std::uint64_t>(rng());
+  key = (key << 32U) ^ static_cast<std::uint64_t>(rng());
+
+  pool.ParallelFor(0UL, nblocks, [&](size_t b) { Bond(b, spins, key); });
+  for (auto const& crossing : crossing_) {
+    for (auto [i, j] : crossing) {
+      clusters_.Unite(i, j);
+    }
+  }
+
+  // one draw for every cluster, in the order of their representatives
+  auto flipper = Philox4x32(key, nblocks);
+  auto nclusters = 0UL;
+  for (auto i = 0UL; i < flips_.size(); i++) {
+    if (clusters_.IsRoot(i)) {
+      auto flip = draw_uniform(1.0, flipper) < 0.5;
+      flips_[i] = flip ? 1 : 0;
+      sizes_.Add(clusters_.GetSize(i));
+      stats_.Add(flip ? MoveResult::Accept(0.5) : MoveResult::Reject(0.5));
+      nclusters++;
+    }
+  }
+
+  pool.ParallelFor(0UL, nblocks, [&](size_t b) {
+    for (auto i = blocks_[b]; i < blocks_[b + 1UL]; i++) {
+      auto root = clusters_.FindRoot(i);
+      labels_[i] = root;
+      if (flips_[root] != 0) {
+        spins[i] = -spins[i];
+      }
+    }
+  });
+  return nclusters;
+}
+
+inline auto
+SwendsenWangUpdate::Reset() -> void
+{
+  sizes_.Reset();
+  stats_.Reset();
+}
+
+template<class Archive>
+inline auto
+SwendsenWangUpdate::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & padd_;
+  ar & sizes_;
+  ar & stats_;
+  // clang-format on
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
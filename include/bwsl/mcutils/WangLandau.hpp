@@ -0,0 +1,380 @@
+//===-- WangLandau.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the WangLandau Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/accumulators/KahanAccumulatorArray.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+///
+/// Flat histogram estimate of the density of states, with the Wang-Landau
+/// and the 1/t algorithms.
+///
+/// The energies (or any other quantity) are binned by the caller, and the
+/// sampler covers the bins [first, last), all of which must be reachable.
+/// Every visit of a bin adds ln f to its log density of states, kept in a
+/// compensated accumulators::KahanAccumulatorArray so that the millions of
+/// tiny late increments are not lost, and counts the visit in a
+/// HistAccumulator.
+///
+/// When the histogram is flat, its lowest bin above @p flatness times the
+/// mean, ln f is halved and the histogram restarts. Once ln f falls below
+/// N / t, with N bins and t visits, it follows N / t from then on
+/// (Belardinelli and Pereyra, Phys. Rev. E 75, 046701, 2007), which does
+/// not saturate, until it reaches the final value.
+///
+/// The lowest count is tracked with the number of bins having each count
+/// from the lowest upwards, so a visit and the check of the flatness both
+/// take constant time instead of a scan of the histogram.
+///
+class WangLandau
+{
+public:
+  /// Default constructor
+  WangLandau() = default;
+
+  /// Sample the bins [@p first, @p last) until ln f falls below
+  /// @p lnf_final
+  WangLandau(size_t first,
+             size_t last,
+             double flatness = 0.8,
+             double lnf_final = 1e-6,
+             double lnf = 1.0);
+
+  /// Copy constructor
+  WangLandau(WangLandau const& that) = default;
+
+  /// Move constructor
+  WangLandau(WangLandau&& that) = default;
+
+  /// Default destructor
+  ~WangLandau() = default;
+
+  /// Copy assignment operator
+  auto operator=(WangLandau const& that) -> WangLandau& = default;
+
+  /// Move assignment operator
+  auto operator=(WangLandau&& that) -> WangLandau& = default;
+
+  /// Probability to move from the bin @p from to the bin @p to, zero out of
+  /// the range
+  [[nodiscard]] auto GetAcceptance(size_t from, size_t to) const -> double;
+
+  /// Accept or reject the move from the bin @p from to the bin @p to and
+  /// visit the resulting bin, returns true if the move is accepted
+  template<class G>
+  auto Step(size_t from, size_t to, G& rng) -> bool;
+
+  /// Visit the bin @p bin
+  auto Visit(size_t bin) -> void;
+
+  /// Check if the histogram since the last change of ln f is flat
+  [[nodiscard]] auto IsFlat() const -> bool
+  {
+    return visits_ > 0UL &&
+           static_cast<double>(GetMinCount()) *
+               static_cast<double>(GetNbins()) >=
+             flatness_ * static_cast<double>(visits_);
+  };
+
+  /// Check if ln f reached its final value
+  [[nodiscard]] auto IsDone() const -> bool { return lnf_ < lnf_final_; };
+
+  /// Check if ln f follows 1/t
+  [[nodiscard]] auto IsInverseTime() const -> bool { return inverse_t_; };
+
+  /// Check if @p bin is in the range
+  [[nodiscard]] auto Contains(size_t bin) const -> bool
+  {
+    return bin >= first_ && bin < last_;
+  };
+
+  /// Log density of states of a bin, up to a constant
+  [[nodiscard]] auto GetLogDensity(size_t bin) const -> double
+  {
+    assert(Contains(bin));
+    return lng_.Sum(bin - first_);
+  };
+
+  /// Log density of states of all the bins, zero in the first one
+  [[nodiscard]] auto GetLogDensity() const -> std::vector<double>;
+
+  /// Current modification factor ln f
+  [[nodiscard]] auto GetLogFactor() const -> double { return lnf_; };
+
+  /// Visits since the last change of ln f, by bin
+  [[nodiscard]] auto GetHistogram() const -> HistAccumulator const&
+  {
+    return hist_;
+  };
+
+  /// Lowest count of the histogram
+  [[nodiscard]] auto GetMinCount() const -> unsigned long;
+
+  /// Number of visits
+  [[nodiscard]] auto GetSteps() const -> unsigned long { return steps_; };
+
+  /// Number of halvings of ln f
+  [[nodiscard]] auto GetIterations() const -> unsigned long
+  {
+    return iterations_;
+  };
+
+  /// First bin
+  [[nodiscard]] auto GetFirst() const -> size_t { return first_; };
+
+  /// One past the last bin
+  [[nodiscard]] auto GetLast() const -> size_t { return last_; };
+
+  /// Number of bins
+  [[nodiscard]] auto GetNbins() const -> size_t { return last_ - first_; };
+
+protected:
+  /// Empty the histogram
+  auto ResetHistogram() -> void;
+
+  /// Rebuild the counts of the counts from the histogram
+  auto Recount() -> void;
+
+private:
+  /// First bin
+  size_t first_{ 0UL };
+
+  /// One past the last bin
+  size_t last_{ 0UL };
+
+  /// Flatness threshold
+  double flatness_{ 0.8 };
+
+  /// Modification factor
+  double lnf_{ 1.0 };
+
+  /// Final modification factor
+  double lnf_final_{ 1e-6 };
+
+  /// Check if ln f follows 1/t
+  bool inverse_t_{ false };
+
+  /// Total number of visits
+  unsigned long steps_{ 0UL };
+
+  /// Number of halvings of ln f
+  unsigned long iterations_{ 0UL };
+
+  /// Log density of states
+  accumulators::KahanAccumulatorArray lng_{};
+
+  /// Visits since the last change of ln f
+  HistAccumulator hist_{};
+
+  /// Visits since the last change of ln f, in total
+  unsigned long visits_{ 0UL };
+
+  /// Lowest count of the histogram, not tracked once ln f follows 1/t
+  unsigned long min_{ 0UL };
+
+  /// Number of bins with count min_, min_ + 1, ..., not serialized and
+  /// empty once ln f follows 1/t
+  std::deque<size_t> counts_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class WangLandau
+
+inline WangLandau::WangLandau(size_t first,
+                              size_t last,
+                              double flatness,
+                              double lnf_final,
+                              double lnf)
+  : first_(first)
+  , last_(last)
+  , flatness_(flatness)
+  , lnf_(lnf)
+  , lnf_final_(lnf_final)
+  , lng_(last - first)
+  , hist_(last - first)
+  , counts_(1UL, last - first)
+{
+  assert(first < last);
+}
+
+inline auto
+WangLandau::GetAcceptance(size_t from, size_t to) const -> double
+{
+  if (!Contains(to)) {
+    return 0.0;
+  }
+  auto delta = GetLogDensity(from) - GetLogDensity(to);
+  return delta >= 0.0 ? 1.0 : std::exp(delta);
+}
+
+template<class G>
+inline auto
+WangLandau::Step(size_t from, size_t to, G& rng) -> bool
+{
+  auto prob = GetAcceptance(from, to);
+  auto accepted = prob >= 1.0 || (prob > 0.0 && draw_uniform(1.0, rng) < prob);
+  Visit(accepted ? to : from);
+  return accepted;
+}
+
+inline auto
+WangLandau::Visit(size_t bin) -> void
+{
+  assert(Contains(bin));
+  auto const i = bin - first_;
+  lng_.Add(i, lnf_);
+  steps_++;
+
+  auto const t = static_cast<double>(GetNbins()) / static_cast<double>(steps_);
+  if (inverse_t_) {
+    // the flatness is not checked anymore, the spread of the counts would
+    // only grow the counts of the counts
+    hist_.Add(i);
+    visits_++;
+    lnf_ = t;
+    return;
+  }
+
+  // move the bin to the next count, the lowest count grows when its last
+  // bin leaves it
+  auto const k = hist_.GetCount(i) - min_;
+  hist_.Add(i);
+  visits_++;
+  if (k + 1UL == counts_.size()) {
+    counts_.push_back(0UL);
+  }
+  counts_[k]--;
+  counts_[k + 1UL]++;
+  while (counts_.front() == 0UL) {
+    counts_.pop_front();
+    min_++;
+  }
+
+  if (IsFlat()) {
+    lnf_ *= 0.5;
+    iterations_++;
+    if (lnf_ < t) {
+      inverse_t_ = true;
+      lnf_ = t;
+    }
+    ResetHistogram();
+  }
+}
+
+inline auto
+WangLandau::ResetHistogram() -> void
+{
+  hist_.Reset();
+  visits_ = 0UL;
+  min_ = 0UL;
+  if (inverse_t_) {
+    counts_.clear();
+  } else {
+    counts_.assign(1UL, GetNbins());
+  }
+}
+
+inline auto
+WangLandau::Recount() -> void
+{
+  visits_ = 0UL;
+  min_ = hist_.GetCount(0UL);
+  auto max = min_;
+  for (auto i = 0UL; i < GetNbins(); i++) {
+    auto c = hist_.GetCount(i);
+    visits_ += c;
+    min_ = std::min<unsigned long>(min_, c);
+    max = std::max<unsigned long>(max, c);
+  }
+
+  if (inverse_t_) {
+    min_ = 0UL;
+    counts_.clear();
+    return;
+  }
+  counts_.assign(max - min_ + 1UL, 0UL);
+  for (auto i = 0UL; i < GetNbins(); i++) {
+    counts_[hist_.GetCount(i) - min_]++;
+  }
+}
+
+inline auto
+WangLandau::GetMinCount() const -> unsigned long
+{
+  if (!inverse_t_) {
+    return min_;
+  }
+
+  auto min = hist_.GetCount(0UL);
+  for (auto i = 1UL; i < GetNbins(); i++) {
+    min = std::min(min, hist_.GetCount(i));
+  }
+  return min;
+}
+
+inline auto
+WangLandau::GetLogDensity() const -> std::vector<double>
+{
+  auto lng = std::vector<double>(GetNbins());
+  for (auto i = 0UL; i < lng.size(); i++) {
+    lng[i] = lng_.Sum(i) - lng_.Sum(0UL);
+  }
+  return lng;
+}
+
+template<class Archive>
+inline auto
+WangLandau::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & first_;
+  ar & last_;
+  ar & flatness_;
+  ar & lnf_;
+  ar & lnf_final_;
+  ar & inverse_t_;
+  ar & steps_;
+  ar & iterations_;
+  ar & lng_;
+  ar & hist_;
+  // clang-format on
+
+  if (typename Archive::is_loading()) {
+    Recount();
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,379 @@
+//===-- WangLandauWindows.hpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the WangLandauWindows Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+#include <bwsl/mcutils/WangLandau.hpp>
+
+// fmt
+#include <fmt/format.h>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+namespace exception {
+
+/// The energy windows of a WangLandauWindows are not usable
+class InvalidWindows : public std::exception
+{
+public:
+  InvalidWindows(std::string const& reason)
+    : message_(fmt::format("Invalid windows: {}", reason))
+  {}
+
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return message_.c_str();
+  }
+
+private:
+  std::string message_{};
+}; // class InvalidWindows
+
+} // namespace bwsl::montecarlo::exception
+
+///
+/// Replica exchange Wang-Landau over overlapping windows of bins.
+///
+/// Every window has its own WangLandau sampler and one walker, and all the
+/// windows run at the same time, one task each on a ThreadPool. After a
+/// block of steps the walkers of neighboring windows, the pairs starting
+/// at even and odd windows in turn, exchange their configurations if both
+/// are in the overlap, with probability
+/// min(1, g_i(E_i) g_j(E_j) / (g_i(E_j) g_j(E_i))) (Vogel et al., Phys.
+/// Rev. Lett. 110, 210603, 2013). The statistics of the exchanges of every
+/// pair of windows are kept in a MoveStats.
+///
+/// The log densities of states of the windows are joined by shifting each
+/// one to match the previous one on average over their overlap.
+///
+template<class Walker, class Engine = Philox4x32>
+class WangLandauWindows
+{
+public:
+  /// A window of bins [first, last)
+  using window_type = std::pair<size_t, size_t>;
+
+  /// Default constructor
+  WangLandauWindows() = default;
+
+  /// Sample the @p windows, sorted and overlapping, the walker i starting
+  /// in the window i and drawing from the stream i of the seed @p seed
+  WangLandauWindows(std::vector<Walker> walkers,
+                    std::vector<window_type> const& windows,
+                    std::uint64_t seed,
+                    double flatness = 0.8,
+                    double lnf_final = 1e-6);
+
+  /// Copy constructor
+  WangLandauWindows(WangLandauWindows const& that) = default;
+
+  /// Move constructor
+  WangLandauWindows(WangLandauWindows&& that) = default;
+
+  /// Default destructor
+  ~WangLandauWindows() = default;
+
+  /// Copy assignment operator
+  auto operator=(WangLandauWindows const& that)
+    -> WangLandauWindows& = default;
+
+  /// Move assignment operator
+  auto operator=(WangLandauWindows&& that) -> WangLandauWindows& = default;
+
+  /// Run @p nsteps calls to @p step(walker, rng, sampler) for every window
+  /// on @p pool, then propose the exchanges of the walkers, whose bins are
+  /// given by @p bin(walker)
+  template<class StepFn, class BinFn>
+  auto RunBlock(ThreadPool& pool, size_t nsteps, StepFn step, BinFn bin)
+    -> void;
+
+  /// Check if every window reached the final ln f
+  [[nodiscard]] auto IsDone() const -> bool;
+
+  /// Log density of states of the bins from the first of the first window
+  /// to the last of the last one, zero in the first bin
+  [[nodiscard]] auto GetLogDensity() const -> std::vector<double>;
+
+  /// Sampler of the window @p k
+  [[nodiscard]] auto GetSampler(size_t k) const -> WangLandau const&
+  {
+    return slots_[k].sampler;
+  };
+
+  /// Walker of the window @p k
+  [[nodiscard]] auto GetWalker(size_t k) const -> Walker const&
+  {
+    return slots_[k].walker;
+  };
+
+  /// Statistics of the exchanges between the windows @p k and @p k + 1
+  [[nodiscard]] auto GetSwapStats(size_t k) const -> MoveStats const&
+  {
+    return swaps_[k];
+  };
+
+  /// Number of windows
+  [[nodiscard]] auto GetSize() const -> size_t { return slots_.size(); };
+
+protected:
+  /// The generator of the stream @p stream
+  [[nodiscard]] static auto MakeEngine(std::uint64_t seed,
+                                       std::uint64_t stream) -> Engine;
+
+  /// Statistics of the exchanges between the windows @p k and @p k + 1
+  [[nodiscard]] static auto MakeSwapStats(size_t k) -> MoveStats;
+
+  /// Propose the exchanges of the pairs starting at windows of parity
+  /// @p parity
+  template<class BinFn>
+  auto Exchange(size_t parity, BinFn& bin) -> void;
+
+private:
+  /// State of a window, alone in its cache lines
+  struct alignas(64) Slot
+  {
+    /// The sampler
+    WangLandau sampler{};
+
+    /// The walker
+    Walker walker{};
+
+    /// Its generator
+    Engine engine{};
+
+    /// Serialization method for the struct
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      // clang-format off
+      ar & sampler;
+      ar & walker;
+      ar & engine;
+      // clang-format on
+    }
+  };
+
+  /// The windows
+  std::vector<Slot> slots_{};
+
+  /// Statistics of the exchanges of neighboring windows
+  std::vector<MoveStats> swaps_{};
+
+  /// Generator of the exchanges
+  Engine rng_{};
+
+  /// Number of blocks run
+  unsigned long blocks_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class WangLandauWindows
+
+template<class Walker, class Engine>
+inline WangLandauWindows<Walker, Engine>::WangLandauWindows(
+  std::vector<Walker> walkers,
+  std::vector<window_type> const& windows,
+  std::uint64_t seed,
+  double flatness,
+  double lnf_final)
+  : slots_(windows.size())
+  , rng_(MakeEngine(seed, windows.size()))
+{
+  if (walkers.size() != windows.size()) {
+    throw exception::InvalidWindows(fmt::format(
+      "{} walkers for {} windows", walkers.size(), windows.size()));
+  }
+  for (auto k = 0UL; k < windows.size(); k++) {
+    auto [first, last] = windows[k];
+    if (first >= last) {
+      throw exception::InvalidWindows(fmt::format("window {} is empty", k));
+    }
+    if (k > 0UL && (first <= windows[k - 1UL].first ||
+                    first >= windows[k - 1UL].second ||
+                    last <= windows[k - 1UL].second)) {
+      throw exception::InvalidWindows(
+        fmt::format("windows {} and {} do not overlap in order", k - 1UL, k));
+    }
+
+    slots_[k].sampler = WangLandau(first, last, flatness, lnf_final);
+    slots_[k].walker = std::move(walkers[k]);
+    slots_[k].engine = MakeEngine(seed, k);
+  }
+  for (auto k = 0UL; k + 1UL < slots_.size(); k++) {
+    swaps_.push_back(MakeSwapStats(k));
+  }
+}
+
+template<class Walker, class Engine>
+inline auto
+WangLandauWindows<Walker, Engine>::MakeEngine(std::uint64_t seed,
+                                              std::uint64_t stream) -> Engine
+{
+  if constexpr (is_uniform_buffer<Engine>::value) {
+    return Engine(Philox4x32(seed).Split(stream));
+  } else {
+    return Engine(seed).Split(stream);
+  }
+}
+
+template<class Walker, class Engine>
+inline auto
+WangLandauWindows<Walker, Engine>::MakeSwapStats(size_t k) -> MoveStats
+{
+  return MoveStats(fmt::format("exchange {} <-> {}", k, k + 1UL));
+}
+
+template<class Walker, class Engine>
+template<class StepFn, class BinFn>
+inline auto
+WangLandauWindows<Walker, Engine>::RunBlock(ThreadPool& pool,
+                                            size_t nsteps,
+                                            StepFn step,
+                                            BinFn bin) -> void
+{
+  pool.ParallelFor(0UL, slots_.size(), [&](size_t k) {
+    auto& s = slots_[k];
+    for (auto i = 0UL; i < nsteps; i++) {
+      step(s.walker, s.engine, s.sampler);
+    }
+  });
+
+  Exchange(blocks_++ & 1UL, bin);
+}
+
+template<class Walker, class Engine>
+template<class BinFn>
+inline auto
+WangLandauWindows<Walker, Engine>::Exchange(size_t parity, BinFn& bin) -> void
+{
+  for (auto k = parity; k + 1UL < slots_.size(); k += 2UL) {
+    auto& a = slots_[k];
+    auto& b = slots_[k + 1UL];
+    auto const ea = bin(static_cast<Walker const&>(a.walker));
+    auto const eb = bin(static_cast<Walker const&>(b.walker));
+    if (!a.sampler.Contains(eb) || !b.sampler.Contains(ea)) {
+      swaps_[k].Add(MoveResult::Impossible());
+      continue;
+    }
+
+    auto const delta =
+      a.sampler.GetLogDensity(ea) - a.sampler.GetLogDensity(eb) +
+      b.sampler.GetLogDensity(eb) - b.sampler.GetLogDensity(ea);
+    auto const prob = delta >= 0.0 ? 1.0 : std::exp(delta);
+    if (prob < 1.0 && draw_uniform(1.0, rng_) >= prob) {
+      swaps_[k].Add(MoveResult::Reject(prob));
+      continue;
+    }
+    swaps_[k].Add(MoveResult::Accept(prob));
+    std::swap(a.walker, b.walker);
+  }
+}
+
+template<class Walker, class Engine>
+inline auto
+WangLandauWindows<Walker, Engine>::IsDone() const -> bool
+{
+  return std::all_of(slots_.begin(), slots_.end(), [](Slot const& s) {
+    return s.sampler.IsDone();
+  });
+}
+
+template<class Walker, class Engine>
+inline auto
+WangLandauWindows<Walker, Engine>::GetLogDensity() const
+  -> std::vector<double>
+{
+  if (slots_.empty()) {
+    return {};
+  }
+
+  auto const first = slots_.front().sampler.GetFirst();
+  auto lng = std::vector<double>(slots_.back().sampler.GetLast() - first);
+  auto const& w0 = slots_.front().sampler;
+  for (auto b = w0.GetFirst(); b < w0.GetLast(); b++) {
+    lng[b - first] = w0.GetLogDensity(b) - w0.GetLogDensity(first);
+  }
+
+  // each window takes over from the middle of its overlap with the previous
+  for (auto k = 1UL; k < slots_.size(); k++) {
+    auto const& w = slots_[k].sampler;
+    auto const start = w.GetFirst();
+    auto const end = slots_[k - 1UL].sampler.GetLast();
+
+    auto shift = 0.0;
+    for (auto b = start; b < end; b++) {
+      shift += lng[b - first] - w.GetLogDensity(b);
+    }
+    shift /= static_cast<double>(end - start);
+
+    for (auto b = start + (end - start) / 2UL; b < w.GetLast(); b++) {
+      lng[b - first] = w.GetLogDensity(b) + shift;
+    }
+  }
+  return lng;
+}
+
+template<class Walker, class Engine>
+template<class Archive>
+inline auto
+WangLandauWindows<Walker, Engine>::serialize(Archive& ar,
+                                             const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & slots_;
+  ar & rng_;
+  ar & blocks_;
+  // clang-format on
+
+  // the statistics do not store the names
+  if (typename Archive::is_loading()) {
+    swaps_.clear();
+    for (auto k = 0UL; k + 1UL < slots_.size(); k++) {
+      swaps_.push_back(MakeSwapStats(k));
+    }
+  }
+  for (auto& s : swaps_) {
+    ar& s;
+  }
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,197 @@
+//===-- WolffUpdate.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the WolffUpdate Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/mcutils/MoveResult.hpp>
+#include <bwsl/mcutils/MoveStats.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace bwsl::montecarlo {
+
+/// Probability to bond two equal Ising spins at inverse temperature
+/// @p beta with coupling @p coupling, in the cluster updates
+inline auto
+ising_bond_probability(double beta, double coupling = 1.0) -> double
+{
+  return -std::expm1(-2.0 * beta * coupling);
+}
+
+///
+/// Single cluster update of Ising spins (Wolff, Phys. Rev. Lett. 62, 361,
+/// 1989).
+///
+/// A cluster grows from a random site, adding every neighbor with the same
+/// spin with the bond probability, and is flipped as it grows. The
+/// neighbors of the Lattice are copied once into a single array and the
+/// sites to visit are kept in a stack allocated at construction, as large
+/// as the lattice, so an update allocates nothing.
+///
+/// The size of every cluster is counted in a HistAccumulator, and every
+/// cluster is recorded as an accepted move of probability one in a
+/// MoveStats. The neighbor tables are not serialized: construct the update
+/// from the lattice, then load its statistics.
+///
+class WolffUpdate
+{
+public:
+  /// Default constructor
+  WolffUpdate() = default;
+
+  /// Update the spins of @p lattice with bond probability @p padd
+  explicit WolffUpdate(Lattice const& lattice, double padd = 0.0);
+
+  /// Copy constructor
+  WolffUpdate(WolffUpdate const& that) = default;
+
+  /// Move constructor
+  WolffUpdate(WolffUpdate&& that) = default;
+
+  /// Default destructor
+  ~WolffUpdate() = default;
+
+  /// Copy assignment operator
+  auto operator=(WolffUpdate const& that) -> WolffUpdate& = default;
+
+  /// Move assignment operator
+  auto operator=(WolffUpdate&& that) -> WolffUpdate& = default;
+
+  /// Change the bond probability, see ising_bond_probability
+  auto SetBondProbability(double padd) -> void { padd_ = padd; };
+
+  /// Grow and flip a cluster of @p spins, returns its size
+  template<class Spin, class G>
+  auto Step(std::vector<Spin>& spins, G& rng) -> size_t;
+
+  /// Number of clusters of each size
+  [[nodiscard]] auto GetSizes() const -> HistAccumulator const&
+  {
+    return sizes_;
+  };
+
+  /// Statistics of the updates
+  [[nodiscard]] auto GetStats() const -> MoveStats const& { return stats_; };
+
+  /// Bond probability
+  [[nodiscard]] auto GetBondProbability() const -> double { return padd_; };
+
+  /// Reset the statistics
+  auto Reset() -> void;
+
+private:
+  /// Bond probability
+  double padd_{ 0.0 };
+
+  /// Neighbors of the site i, from first_[i] to first_[i + 1]
+  std::vector<size_t> neighbors_{};
+
+  /// Start of the neighbors of each site
+  std::vector<size_t> first_{ 0UL };
+
+  /// Sites of the cluster still to visit
+  std::vector<size_t> stack_{};
+
+  /// Number of clusters of each size
+  HistAccumulator sizes_{};
+
+  /// Statistics of the updates
+  MoveStats stats_{ "wolff" };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class WolffUpdate
+
+inline WolffUpdate::WolffUpdate(Lattice const& lattice, double padd)
+  : padd_(padd)
+  , stack_(lattice.GetNumSites())
+  , sizes_(lattice.GetNumSites() + 1UL)
+{
+  auto const n = lattice.GetNumSites();
+  first_.reserve(n + 1UL);
+  for (auto i = 0UL; i < n; i++) {
+    auto const& nn = lattice.GetNeighbors(i);
+    neighbors_.insert(neighbors_.end(), nn.begin(), nn.end());
+    first_.push_back(neighbors_.size());
+  }
+}
+
+template<class Spin, class G>
+inline auto
+WolffUpdate::Step(std::vector<Spin>& spins, G& rng) -> size_t
+{
+  auto const n = stack_.size();
+  auto* stack = stack_.data();
+  auto x = draw_uniform(static_cast<double>(n), rng);
+  auto seed = std::min(static_cast<size_t>(x), n - 1UL);
+
+  // a site is flipped when it joins, so it never joins twice
+  auto const old = spins[seed];
+  spins[seed] = -old;
+  stack[0] = seed;
+  auto top = 1UL;
+  auto size = 1UL;
+  while (top > 0UL) {
+    auto i = stack[--top];
+    for (auto k = first_[i]; k < first_[i + 1UL]; k++) {
+      auto j = neighbors_[k];
+      if (spins[j] == old && draw_uniform(1.0, rng) < padd_) {
+        spins[j] = -old;
+        stack[top++] = j;
+        size++;
+      }
+    }
+  }
+
+  sizes_.Add(size);
+  stats_.Add(MoveResult::Accept(1.0));
+  return size;
+}
+
+inline auto
+WolffUpdate::Reset() -> void
+{
+  sizes_.Reset();
+  stats_.Reset();
+}
+
+template<class Archive>
+inline auto
+WolffUpdate::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & padd_;
+  ar & sizes_;
+  ar & stats_;
+  // clang-format on
+}
+
+} // namespace bwsl::montecarlo
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
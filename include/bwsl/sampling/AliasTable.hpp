@@ -0,0 +1,202 @@
+//===-- AliasTable.hpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the AliasTable Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/accumulators/NeumaierAccumulator.hpp>
+#include <bwsl/sampling/SamplingExceptions.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace bwsl::sampling {
+
+///
+/// Walker's alias method, with the construction of Vose.
+///
+/// Every index gets a column of height one, split between itself, with
+/// probability GetThreshold(i), and one alias. Building the table is O(n),
+/// drawing an index takes one uniform number and O(1) work, independently
+/// of the weights. The weights cannot change afterwards: see SumTree for
+/// weights which are updated between draws.
+///
+class AliasTable
+{
+public:
+  /// Default constructor
+  AliasTable() = default;
+
+  /// Build the table for the given weights, which do not need to be
+  /// normalized
+  explicit AliasTable(std::vector<double> const& weights);
+
+  /// Copy constructor
+  AliasTable(AliasTable const& that) = default;
+
+  /// Move constructor
+  AliasTable(AliasTable&& that) = default;
+
+  /// Default destructor
+  ~AliasTable() = default;
+
+  /// Copy assignment operator
+  auto operator=(AliasTable const& that) -> AliasTable& = default;
+
+  /// Move assignment operator
+  auto operator=(AliasTable&& that) -> AliasTable& = default;
+
+  /// Draw an index with probability proportional to its weight, @p rng is a
+  /// generator or a UniformBuffer
+  template<typename G>
+  auto Sample(G& rng) const -> size_t;
+
+  /// Probability of drawing @p idx
+  [[nodiscard]] auto GetProbability(size_t idx) const -> double
+  {
+    return prob_[idx];
+  };
+
+  /// Probability of keeping @p idx once its column is drawn
+  [[nodiscard]] auto GetThreshold(size_t idx) const -> double
+  {
+    return threshold_[idx];
+  };
+
+  /// Index drawn instead of @p idx above the threshold
+  [[nodiscard]] auto GetAlias(size_t idx) const -> size_t
+  {
+    return alias_[idx];
+  };
+
+  /// Sum of the weights
+  [[nodiscard]] auto GetTotal() const -> double { return total_; };
+
+  /// Number of indices
+  [[nodiscard]] auto GetSize() const -> size_t { return alias_.size(); };
+
+private:
+  /// Probability of keeping each index
+  std::vector<double> threshold_{};
+
+  /// Alias of each index
+  std::vector<size_t> alias_{};
+
+  /// Normalized weights
+  std::vector<double> prob_{};
+
+  /// Sum of the weights
+  double total_{ 0.0 };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class AliasTable
+
+inline AliasTable::AliasTable(std::vector<double> const& weights)
+  : threshold_(weights.size())
+  , alias_(weights.size())
+  , prob_(weights.size())
+{
+  auto acc = accumulators::NeumaierAccumulator{};
+  for (auto w : weights) {
+    if (!std::isfinite(w) || w < 0.0) {
+      throw exception::InvalidWeights();
+    }
+    acc.Add(w);
+  }
+  total_ = acc.Sum();
+  if (weights.empty() || !(total_ > 0.0)) {
+    throw exception::InvalidWeights();
+  }
+
+  // columns below and above the average height, used as stacks
+  auto const n = weights.size();
+  auto small = std::vector<size_t>{};
+  auto large = std::vector<size_t>{};
+  small.reserve(n);
+  large.reserve(n);
+
+  auto height = std::vector<double>(n);
+  for (auto i = 0UL; i < n; i++) {
+    prob_[i] = weights[i] / total_;
+    height[i] = prob_[i] * static_cast<double>(n);
+    (height[i] < 1.0 ? small : large).push_back(i);
+  }
+
+  // fill every small column with the excess of a large one
+  while (!small.empty() && !large.empty()) {
+    auto s = small.back();
+    auto l = large.back();
+    small.pop_back();
+    threshold_[s] = height[s];
+    alias_[s] = l;
+
+    height[l] = (height[l] + height[s]) - 1.0;
+    if (height[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // what is left is one up to rounding errors
+  for (auto i : large) {
+    threshold_[i] = 1.0;
+    alias_[i] = i;
+  }
+  for (auto i : small) {
+    threshold_[i] = 1.0;
+    alias_[i] = i;
+  }
+}
+
+template<typename G>
+inline auto
+AliasTable::Sample(G& rng) const -> size_t
+{
+  auto const n = alias_.size();
+  assert(n > 0UL);
+
+  auto u = draw_uniform(static_cast<double>(n), rng);
+  auto idx = std::min(static_cast<size_t>(u), n - 1UL);
+  return u - static_cast<double>(idx) < threshold_[idx] ? idx : alias_[idx];
+}
+
+template<class Archive>
+inline auto
+AliasTable::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & threshold_;
+  ar & alias_;
+  ar & prob_;
+  ar & total_;
+  // clang-format on
+}
+
+} // namespace bwsl::sampling
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,266 @@
+//===-- FenwickTree.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the FenwickTree Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/sampling/SamplingExceptions.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace bwsl::sampling {
+
+///
+/// Weights indexed by a Fenwick (binary indexed) tree.
+///
+/// The tree uses n nodes besides the weights, changing a weight and drawing
+/// an index are both O(log n). Updates add the difference between the new
+/// and the old weight to the nodes: every node keeps a Neumaier
+/// compensation term so that rounding errors do not pile up, and the tree
+/// is rebuilt from the weights after every n updates, which costs O(1) per
+/// update on average.
+///
+class FenwickTree
+{
+public:
+  /// Default constructor
+  FenwickTree() = default;
+
+  /// A tree of @p n zero weights
+  explicit FenwickTree(size_t n);
+
+  /// A tree with the given weights, built in O(n)
+  explicit FenwickTree(std::vector<double> const& weights);
+
+  /// Copy constructor
+  FenwickTree(FenwickTree const& that) = default;
+
+  /// Move constructor
+  FenwickTree(FenwickTree&& that) = default;
+
+  /// Default destructor
+  ~FenwickTree() = default;
+
+  /// Copy assignment operator
+  auto operator=(FenwickTree const& that) -> FenwickTree& = default;
+
+  /// Move assignment operator
+  auto operator=(FenwickTree&& that) -> FenwickTree& = default;
+
+  /// Change the weight of @p idx
+  auto Set(size_t idx, double w) -> void;
+
+  /// Weight of @p idx
+  [[nodiscard]] auto Get(size_t idx) const -> double { return weights_[idx]; };
+
+  /// Sum of the weights before @p idx
+  [[nodiscard]] auto GetPrefix(size_t idx) const -> double;
+
+  /// Index whose interval of cumulative weights contains @p x, for x in
+  /// [0, GetTotal())
+  [[nodiscard]] auto Find(double x) const -> size_t;
+
+  /// Draw an index with probability proportional to its weight, @p rng is a
+  /// generator or a UniformBuffer
+  template<typename G>
+  auto Sample(G& rng) const -> size_t
+  {
+    return Find(draw_uniform(GetTotal(), rng));
+  }
+
+  /// Sum of the weights
+  [[nodiscard]] auto GetTotal() const -> double { return GetPrefix(size_); };
+
+  /// Number of weights
+  [[nodiscard]] auto GetSize() const -> size_t { return size_; };
+
+  /// Recompute the nodes from the weights
+  auto Rebuild() -> void;
+
+protected:
+  /// Value of a node, 1-based
+  [[nodiscard]] auto Node(size_t i) const -> double { return sum_[i] + c_[i]; };
+
+private:
+  /// Number of weights
+  size_t size_{ 0UL };
+
+  /// The weights
+  std::vector<double> weights_{};
+
+  /// Partial sums of the nodes, 1-based
+  std::vector<double> sum_{};
+
+  /// Compensation of the partial sums
+  std::vector<double> c_{};
+
+  /// Updates since the last rebuild
+  size_t updates_{ 0UL };
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class FenwickTree
+
+inline FenwickTree::FenwickTree(size_t n)
+  : size_(n)
+  , weights_(n, 0.0)
+  , sum_(n + 1UL, 0.0)
+  , c_(n + 1UL, 0.0)
+{
+}
+
+inline FenwickTree::FenwickTree(std::vector<double> const& weights)
+  : FenwickTree(weights.size())
+{
+  for (auto i = 0UL; i < size_; i++) {
+    if (!std::isfinite(weights[i]) || weights[i] < 0.0) {
+      throw exception::InvalidWeights();
+    }
+    weights_[i] = weights[i];
+  }
+  Rebuild();
+}
+
+inline auto
+FenwickTree::Rebuild() -> void
+{
+  // every node pushes its sum to its parent, O(n)
+  std::copy(weights_.begin(), weights_.end(), sum_.begin() + 1L);
+  std::fill(c_.begin(), c_.end(), 0.0);
+  for (auto i = 1UL; i <= size_; i++) {
+    auto parent = i + (i & (~i + 1UL));
+    if (parent <= size_) {
+      sum_[parent] += sum_[i];
+    }
+  }
+  updates_ = 0UL;
+}
+
+inline auto
+FenwickTree::Set(size_t idx, double w) -> void
+{
+  assert(idx < size_);
+  if (!std::isfinite(w) || w < 0.0) {
+    throw exception::InvalidWeights();
+  }
+
+  auto const delta = w - weights_[idx];
+  weights_[idx] = w;
+  if (++updates_ >= size_) {
+    Rebuild();
+    return;
+  }
+
+  for (auto i = idx + 1UL; i <= size_; i += i & (~i + 1UL)) {
+    // Neumaier summation on the node
+    auto t = sum_[i] + delta;
+    if (std::abs(sum_[i]) >= std::abs(delta)) {
+      c_[i] += (sum_[i] - t) + delta;
+    } else {
+      c_[i] += (delta - t) + sum_[i];
+    }
+    sum_[i] = t;
+  }
+}
+
+inline auto
+FenwickTree::GetPrefix(size_t idx) const -> double
+{
+  assert(idx <= size_);
+  auto s = 0.0;
+  auto c = 0.0;
+  for (auto i = idx; i > 0UL; i -= i & (~i + 1UL)) {
+    s += sum_[i];
+    c += c_[i];
+  }
+  return s + c;
+}
+
+inline auto
+FenwickTree::Find(double x) const -> size_t
+{
+  if (!(GetTotal() > 0.0)) {
+    throw exception::InvalidWeights();
+  }
+
+  auto step = 1UL;
+  while (2UL * step <= size_) {
+    step *= 2UL;
+  }
+
+  // largest position whose prefix does not exceed x
+  auto pos = 0UL;
+  for (; step > 0UL; step /= 2UL) {
+    auto next = pos + step;
+    if (next <= size_ && Node(next) <= x) {
+      pos = next;
+      x -= Node(next);
+    }
+  }
+
+  // rounding can stop on a zero weight or past the end: move to the
+  // closest positive weight, if the residual of many updates left a positive
+  // total over zero weights there is none
+  if (pos >= size_) {
+    pos = size_ - 1UL;
+  }
+  if (weights_[pos] == 0.0) {
+    auto i = pos;
+    while (i < size_ && weights_[i] == 0.0) {
+      i++;
+    }
+    if (i == size_) {
+      i = pos;
+      while (i > 0UL && weights_[i] == 0.0) {
+        i--;
+      }
+      if (weights_[i] == 0.0) {
+        throw exception::InvalidWeights();
+      }
+    }
+    pos = i;
+  }
+  return pos;
+}
+
+template<class Archive>
+inline auto
+FenwickTree::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & size_;
+  ar & weights_;
+  ar & sum_;
+  ar & c_;
+  ar & updates_;
+  // clang-format on
+}
+
+} // namespace bwsl::sampling
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
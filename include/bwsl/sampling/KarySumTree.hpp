@@ -0,0 +1,230 @@
+//===-- KarySumTree.hpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the KarySumTree Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/sampling/SamplingExceptions.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace bwsl::sampling {
+
+///
+/// Sum tree with @p K children for each node.
+///
+/// The children of a node are contiguous, with the default K = 8 they fill
+/// one cache line, so the tree is log_K(n) levels deep and every level
+/// costs one cache miss. The levels are stored from the leaves up in a
+/// single array. As in SumTree the nodes are recomputed from their
+/// children, so the sums never drift.
+///
+template<size_t K = 8UL>
+class KarySumTree
+{
+  static_assert(K >= 2UL, "A tree needs at least two children per node");
+
+public:
+  /// Default constructor
+  KarySumTree() = default;
+
+  /// A tree of @p n zero weights
+  explicit KarySumTree(size_t n);
+
+  /// A tree with the given weights, built in O(n)
+  explicit KarySumTree(std::vector<double> const& weights);
+
+  /// Copy constructor
+  KarySumTree(KarySumTree const& that) = default;
+
+  /// Move constructor
+  KarySumTree(KarySumTree&& that) = default;
+
+  /// Default destructor
+  ~KarySumTree() = default;
+
+  /// Copy assignment operator
+  auto operator=(KarySumTree const& that) -> KarySumTree& = default;
+
+  /// Move assignment operator
+  auto operator=(KarySumTree&& that) -> KarySumTree& = default;
+
+  /// Change the weight of @p idx
+  auto Set(size_t idx, double w) -> void;
+
+  /// Weight of @p idx
+  [[nodiscard]] auto Get(size_t idx) const -> double { return nodes_[idx]; };
+
+  /// Index whose interval of cumulative weights contains @p x, for x in
+  /// [0, GetTotal())
+  [[nodiscard]] auto Find(double x) const -> size_t;
+
+  /// Draw an index with probability proportional to its weight, @p rng is a
+  /// generator or a UniformBuffer
+  template<typename G>
+  auto Sample(G& rng) const -> size_t
+  {
+    return Find(draw_uniform(GetTotal(), rng));
+  }
+
+  /// Sum of the weights
+  [[nodiscard]] auto GetTotal() const -> double
+  {
+    return nodes_.empty() ? 0.0 : nodes_.back();
+  };
+
+  /// Number of weights
+  [[nodiscard]] auto GetSize() const -> size_t { return size_; };
+
+protected:
+  /// Recompute the node @p i of the level @p l from its children
+  auto Update(size_t l, size_t i) -> void;
+
+private:
+  /// Number of weights
+  size_t size_{ 0UL };
+
+  /// Offset of each level, the leaves first and the root last
+  std::vector<size_t> offsets_{};
+
+  /// All the nodes, each level padded to a multiple of K
+  std::vector<double> nodes_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class KarySumTree
+
+template<size_t K>
+inline KarySumTree<K>::KarySumTree(size_t n)
+  : size_(n)
+{
+  // every level but the root is padded to whole groups of K
+  auto width = std::max(n, size_t{ 1 });
+  auto offset = 0UL;
+  while (width > 1UL) {
+    auto groups = (width + K - 1UL) / K;
+    offsets_.push_back(offset);
+    offset += groups * K;
+    width = groups;
+  }
+  offsets_.push_back(offset);
+  nodes_.assign(offset + 1UL, 0.0);
+}
+
+template<size_t K>
+inline KarySumTree<K>::KarySumTree(std::vector<double> const& weights)
+  : KarySumTree(weights.size())
+{
+  for (auto i = 0UL; i < size_; i++) {
+    if (!std::isfinite(weights[i]) || weights[i] < 0.0) {
+      throw exception::InvalidWeights();
+    }
+    nodes_[i] = weights[i];
+  }
+  for (auto l = 1UL; l < offsets_.size(); l++) {
+    auto const width = (offsets_[l] - offsets_[l - 1UL]) / K;
+    for (auto i = 0UL; i < width; i++) {
+      Update(l, i);
+    }
+  }
+}
+
+template<size_t K>
+inline auto
+KarySumTree<K>::Update(size_t l, size_t i) -> void
+{
+  auto const* children = nodes_.data() + offsets_[l - 1UL] + K * i;
+  auto s = 0.0;
+  for (auto j = 0UL; j < K; j++) {
+    s += children[j];
+  }
+  nodes_[offsets_[l] + i] = s;
+}
+
+template<size_t K>
+inline auto
+KarySumTree<K>::Set(size_t idx, double w) -> void
+{
+  assert(idx < size_);
+  if (!std::isfinite(w) || w < 0.0) {
+    throw exception::InvalidWeights();
+  }
+
+  nodes_[idx] = w;
+  for (auto l = 1UL; l < offsets_.size(); l++) {
+    idx /= K;
+    Update(l, idx);
+  }
+}
+
+template<size_t K>
+inline auto
+KarySumTree<K>::Find(double x) const -> size_t
+{
+  if (!(GetTotal() > 0.0)) {
+    throw exception::InvalidWeights();
+  }
+
+  auto i = 0UL;
+  for (auto l = offsets_.size() - 1UL; l-- > 0UL;) {
+    auto const* children = nodes_.data() + offsets_[l] + K * i;
+
+    // keep the last non empty child in case rounding runs past the end
+    auto chosen = K;
+    auto last = 0UL;
+    for (auto j = 0UL; j < K; j++) {
+      if (children[j] > 0.0) {
+        last = j;
+        if (x < children[j]) {
+          chosen = j;
+          break;
+        }
+        x -= children[j];
+      }
+    }
+    i = K * i + (chosen == K ? last : chosen);
+  }
+  return i;
+}
+
+template<size_t K>
+template<class Archive>
+inline auto
+KarySumTree<K>::serialize(Archive& ar, const unsigned int /* version */)
+  -> void
+{
+  // clang-format off
+  ar & size_;
+  ar & offsets_;
+  ar & nodes_;
+  // clang-format on
+}
+
+} // namespace bwsl::sampling
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
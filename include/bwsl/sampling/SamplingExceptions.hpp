@@ -0,0 +1,33 @@
+//===-- SamplingExceptions.hpp ---------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Exceptions for the samplers
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// std
+#include <exception>
+
+namespace bwsl::exception {
+
+/// The weights of a sampler are negative, not finite or all zero
+class InvalidWeights : public std::exception
+{
+  [[nodiscard]] auto what() const noexcept -> const char* override
+  {
+    return "The weights must be finite, non negative and not all zero";
+  }
+};
+
+} // namespace bwsl::exception
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,200 @@
+//===-- SumTree.hpp --------------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Definitions for the SumTree Class
+///
+//===---------------------------------------------------------------------===//
+#pragma once
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/sampling/SamplingExceptions.hpp>
+
+// boost
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace bwsl::sampling {
+
+///
+/// Weights stored as the leaves of a complete binary tree whose nodes hold
+/// the sum of their children.
+///
+/// Changing a weight recomputes the sums on the path to the root, drawing
+/// an index descends from the root, both in O(log n). Every node is
+/// recomputed from its children rather than corrected by the difference,
+/// so the sums do not drift however many updates are done.
+///
+class SumTree
+{
+public:
+  /// Default constructor
+  SumTree() = default;
+
+  /// A tree of @p n zero weights
+  explicit SumTree(size_t n);
+
+  /// A tree with the given weights, built in O(n)
+  explicit SumTree(std::vector<double> const& weights);
+
+  /// Copy constructor
+  SumTree(SumTree const& that) = default;
+
+  /// Move constructor
+  SumTree(SumTree&& that) = default;
+
+  /// Default destructor
+  ~SumTree() = default;
+
+  /// Copy assignment operator
+  auto operator=(SumTree const& that) -> SumTree& = default;
+
+  /// Move assignment operator
+  auto operator=(SumTree&& that) -> SumTree& = default;
+
+  /// Change the weight of @p idx
+  auto Set(size_t idx, double w) -> void;
+
+  /// Weight of @p idx
+  [[nodiscard]] auto Get(size_t idx) const -> double
+  {
+    return tree_[leaves_ + idx];
+  };
+
+  /// Index whose interval of cumulative weights contains @p x, for x in
+  /// [0, GetTotal())
+  [[nodiscard]] auto Find(double x) const -> size_t;
+
+  /// Draw an index with probability proportional to its weight, @p rng is a
+  /// generator or a UniformBuffer
+  template<typename G>
+  auto Sample(G& rng) const -> size_t
+  {
+    return Find(draw_uniform(GetTotal(), rng));
+  }
+
+  /// Sum of the weights
+  [[nodiscard]] auto GetTotal() const -> double
+  {
+    return tree_.empty() ? 0.0 : tree_[1];
+  };
+
+  /// Number of weights
+  [[nodiscard]] auto GetSize() const -> size_t { return size_; };
+
+protected:
+  /// Recompute all the inner nodes
+  auto Build() -> void;
+
+private:
+  /// Number of weights
+  size_t size_{ 0UL };
+
+  /// Number of leaves, the smallest power of two not below the size
+  size_t leaves_{ 0UL };
+
+  /// Nodes, the root is at 1 and the children of i at 2i and 2i + 1
+  std::vector<double> tree_{};
+
+  // serializaton
+  friend class boost::serialization::access;
+
+  /// Serialization method for the class
+  template<class Archive>
+  void serialize(Archive& ar, unsigned int version);
+}; // class SumTree
+
+inline SumTree::SumTree(size_t n)
+  : size_(n)
+  , leaves_(1UL)
+{
+  while (leaves_ < n) {
+    leaves_ *= 2UL;
+  }
+  tree_.assign(2UL * leaves_, 0.0);
+}
+
+inline SumTree::SumTree(std::vector<double> const& weights)
+  : SumTree(weights.size())
+{
+  for (auto i = 0UL; i < size_; i++) {
+    if (!std::isfinite(weights[i]) || weights[i] < 0.0) {
+      throw exception::InvalidWeights();
+    }
+    tree_[leaves_ + i] = weights[i];
+  }
+  Build();
+}
+
+inline auto
+SumTree::Build() -> void
+{
+  for (auto i = leaves_; i-- > 1UL;) {
+    tree_[i] = tree_[2UL * i] + tree_[2UL * i + 1UL];
+  }
+}
+
+inline auto
+SumTree::Set(size_t idx, double w) -> void
+{
+  assert(idx < size_);
+  if (!std::isfinite(w) || w < 0.0) {
+    throw exception::InvalidWeights();
+  }
+
+  auto i = leaves_ + idx;
+  tree_[i] = w;
+  for (i /= 2UL; i >= 1UL; i /= 2UL) {
+    tree_[i] = tree_[2UL * i] + tree_[2UL * i + 1UL];
+  }
+}
+
+inline auto
+SumTree::Find(double x) const -> size_t
+{
+  if (!(GetTotal() > 0.0)) {
+    throw exception::InvalidWeights();
+  }
+
+  // never enter an empty subtree, so that rounding cannot pick a zero weight
+  auto i = 1UL;
+  while (i < leaves_) {
+    auto left = tree_[2UL * i];
+    if (x < left || tree_[2UL * i + 1UL] == 0.0) {
+      i = 2UL * i;
+    } else {
+      x -= left;
+      i = 2UL * i + 1UL;
+    }
+  }
+  return i - leaves_;
+}
+
+template<class Archive>
+inline auto
+SumTree::serialize(Archive& ar, const unsigned int /* version */) -> void
+{
+  // clang-format off
+  ar & size_;
+  ar & leaves_;
+  ar & tree_;
+  // clang-format on
+}
+
+} // namespace bwsl::sampling
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
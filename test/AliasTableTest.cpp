@@ -0,0 +1,77 @@
+//===-- AliasTableTest.cpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the AliasTable Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/Philox.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/sampling/AliasTable.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("the table reproduces the weights")
+{
+  auto weights = std::vector<double>{ 1.0, 0.0, 3.0, 0.5, 0.5, 5.0 };
+  auto table = sampling::AliasTable(weights);
+
+  REQUIRE(table.GetSize() == 6UL);
+  REQUIRE(table.GetTotal() == 10.0);
+
+  // the columns redistribute exactly the probabilities
+  auto mass = std::vector<double>(weights.size(), 0.0);
+  for (auto i = 0UL; i < table.GetSize(); i++) {
+    REQUIRE(table.GetThreshold(i) >= 0.0);
+    REQUIRE(table.GetThreshold(i) <= 1.0);
+    mass[i] += table.GetThreshold(i) / 6.0;
+    mass[table.GetAlias(i)] += (1.0 - table.GetThreshold(i)) / 6.0;
+  }
+  for (auto i = 0UL; i < weights.size(); i++) {
+    REQUIRE(mass[i] == Approx(weights[i] / 10.0).margin(1e-15));
+    REQUIRE(table.GetProbability(i) == weights[i] / 10.0);
+  }
+
+  auto rng = UniformBuffer<Philox4x32>(Philox4x32(1UL));
+  auto counts = std::vector<double>(weights.size(), 0.0);
+  auto const n = 200000;
+  for (auto i = 0; i < n; i++) {
+    counts[table.Sample(rng)] += 1.0;
+  }
+  REQUIRE(counts[1] == 0.0);
+  for (auto i = 0UL; i < weights.size(); i++) {
+    REQUIRE(counts[i] / n == Approx(weights[i] / 10.0).margin(0.005));
+  }
+}
+
+TEST_CASE("invalid weights are rejected")
+{
+  using sampling::AliasTable;
+  REQUIRE_THROWS_AS(AliasTable(std::vector<double>{}),
+                    exception::InvalidWeights);
+  REQUIRE_THROWS_AS(AliasTable({ 0.0, 0.0 }), exception::InvalidWeights);
+  REQUIRE_THROWS_AS(AliasTable({ 1.0, -1.0 }), exception::InvalidWeights);
+
+  auto rng = std::mt19937_64(3UL);
+  auto single = AliasTable({ 2.0 });
+  REQUIRE(single.Sample(rng) == 0UL);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
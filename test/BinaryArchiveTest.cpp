@@ -0,0 +1,221 @@
+//===-- BinaryArchiveTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the binary archives
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/CountingHistAccumulator.hpp>
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/MultiHistAccumulator.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// boost
+#include <boost/serialization/version.hpp>
+
+// std
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+/// Records the version received by its serialize method
+struct Versioned
+{
+  unsigned int seen{ 0U };
+
+  template<class Archive>
+  void serialize(Archive& /* ar */, const unsigned int version)
+  {
+    seen = version;
+  }
+};
+
+} // namespace
+
+BOOST_CLASS_VERSION(Versioned, 3)
+
+TEST_CASE("standard types survive a round trip")
+{
+  auto a = 42;
+  auto b = 3.25;
+  auto c = std::string("checkpoint");
+  auto d = std::vector<double>{ 1.0, -2.0, 1e300 };
+  auto e = std::vector<bool>{ true, false, true };
+  auto f = std::unordered_map<size_t, std::string>{ { 3UL, "x" }, { 7UL, "" } };
+  auto g = std::array<long, 3>{ -1L, 0L, 1L };
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << a << b << c << d << e << f << g;
+    REQUIRE(oa.GetSize() == ss.str().size());
+  }
+
+  auto a2 = 0;
+  auto b2 = 0.0;
+  auto c2 = std::string{};
+  auto d2 = std::vector<double>{};
+  auto e2 = std::vector<bool>{};
+  auto f2 = std::unordered_map<size_t, std::string>{};
+  auto g2 = std::array<long, 3>{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> a2 >> b2 >> c2 >> d2 >> e2 >> f2 >> g2;
+
+  REQUIRE(a2 == a);
+  REQUIRE(b2 == b);
+  REQUIRE(c2 == c);
+  REQUIRE(d2 == d);
+  REQUIRE(e2 == e);
+  REQUIRE(f2 == f);
+  REQUIRE(g2 == g);
+  REQUIRE_FALSE(ia.IsSwapped());
+
+  auto x = 0;
+  REQUIRE_THROWS_AS(ia >> x, exception::BinaryArchiveError);
+}
+
+TEST_CASE("engines and accumulators survive a round trip")
+{
+  auto rng = std::mt19937_64(19890501UL);
+  auto rng32 = std::mt19937(1UL);
+  for (auto i = 0; i < 1000; i++) {
+    rng();
+    rng32();
+  }
+
+  auto h = HistAccumulator(5UL);
+  h.Add(1UL, 0.5);
+  h.ForceAdd(7UL);
+  auto c = CountingHistAccumulator32(3UL);
+  c.Add(2UL);
+  auto m = MultiHistAccumulator<2>({ 4UL, 4UL });
+  m.Add({ 1UL, 3UL }, 2.0);
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << rng << rng32 << h << c << m;
+  }
+  // raw words: much smaller than the decimal text of the engine
+  REQUIRE(ss.str().size() < 312UL * 8UL + 624UL * 4UL + 1024UL);
+
+  auto rng2 = std::mt19937_64{};
+  auto rng322 = std::mt19937{};
+  auto h2 = HistAccumulator{};
+  auto c2 = CountingHistAccumulator32{};
+  auto m2 = MultiHistAccumulator<2>{};
+  {
+    auto ia = io::BinaryIArchive(ss);
+    ia >> rng2 >> rng322 >> h2 >> c2 >> m2;
+  }
+
+  REQUIRE(rng2 == rng);
+  REQUIRE(rng322 == rng32);
+  REQUIRE(rng2() == rng());
+  REQUIRE(h2.GetNbins() == 8UL);
+  REQUIRE(h2.GetCount() == 2UL);
+  REQUIRE(h2.GetResult(1UL) == h.GetResult(1UL));
+  REQUIRE(c2.GetCount(2UL) == 1UL);
+  REQUIRE(m2.GetResult({ 1UL, 3UL }) == 2.0);
+}
+
+TEST_CASE("archives from machines with the other byte order are swapped")
+{
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << std::uint32_t{ 0x01020304U } << std::vector<std::uint16_t>{ 0x0102U };
+  }
+
+  // rewrite the archive as the other machine would have
+  auto bytes = ss.str();
+  bytes[8] = static_cast<char>(bytes[8] == 1 ? 2 : 1);
+  std::swap(bytes[12], bytes[15]);
+  std::swap(bytes[13], bytes[14]);
+  for (auto i = 0; i < 4; i++) {
+    std::swap(bytes[16 + i], bytes[23 - i]);
+  }
+  std::swap(bytes[24], bytes[25]);
+
+  auto in = std::stringstream(bytes);
+  auto ia = io::BinaryIArchive(in);
+  auto x = std::uint32_t{};
+  auto v = std::vector<std::uint16_t>{};
+  ia >> x >> v;
+  REQUIRE(ia.IsSwapped());
+  REQUIRE(x == 0x01020304U);
+  REQUIRE(v == std::vector<std::uint16_t>{ 0x0102U });
+
+  auto bad = std::stringstream("NOTANARCHIVE");
+  REQUIRE_THROWS_AS(io::BinaryIArchive(bad), exception::BinaryArchiveError);
+}
+
+TEST_CASE("corrupted sizes are reported as archive errors")
+{
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << std::vector<double>{ 1.0, 2.0 } << std::string("checkpoint");
+  }
+  auto const bytes = ss.str();
+
+  // the size of the vector follows the header
+  auto huge = bytes;
+  huge[16] = '\x7f';
+  auto in = std::stringstream(huge);
+  auto ia = io::BinaryIArchive(in);
+  auto v = std::vector<double>{};
+  REQUIRE_THROWS_AS(ia >> v, exception::BinaryArchiveError);
+
+  // a size one past the data of the archive
+  auto truncated = bytes.substr(0UL, bytes.size() - 1UL);
+  auto in2 = std::stringstream(truncated);
+  auto ia2 = io::BinaryIArchive(in2);
+  auto s = std::string{};
+  ia2 >> v;
+  REQUIRE(v == std::vector<double>{ 1.0, 2.0 });
+  REQUIRE_THROWS_AS(ia2 >> s, exception::BinaryArchiveError);
+}
+
+TEST_CASE("serialize methods receive the version of the class")
+{
+  auto ss = std::stringstream{};
+  auto v = Versioned{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << v;
+  }
+  REQUIRE(v.seen == 3U);
+
+  auto v2 = Versioned{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> v2;
+  REQUIRE(v2.seen == 3U);
+
+  // archives of the first format passed no versions
+  auto bytes = ss.str();
+  bytes[9] = 1;
+  auto old = std::stringstream(bytes);
+  REQUIRE_THROWS_AS(io::BinaryIArchive(old), exception::BinaryArchiveError);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
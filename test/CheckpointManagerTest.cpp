@@ -0,0 +1,197 @@
+//===-- CheckpointManagerTest.cpp ------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the CheckpointManager Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/HistAccumulator.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/io/CheckpointManager.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+namespace {
+
+/// Path of a temporary file
+auto
+temp_file(std::string const& name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/// Everything a toy simulation needs to restart
+struct Simulation
+{
+  Lattice lattice{};
+  std::mt19937_64 rng{ 42UL };
+  HistAccumulator hist{ 10UL };
+  montecarlo::MoveStats stats{ "flip" };
+
+  /// Run @p n steps
+  auto Run(int n) -> void
+  {
+    for (auto i = 0; i < n; i++) {
+      hist.Add(rng() % 10UL);
+      stats.Propose();
+      stats.Accept(0.5);
+    }
+  }
+
+  /// Register all the components into @p ckp
+  auto Register(io::CheckpointManager& ckp) -> void
+  {
+    ckp.Register("lattice", lattice);
+    ckp.Register("rng", rng);
+    ckp.Register("hist", hist);
+    ckp.Register("stats", stats);
+  }
+};
+
+} // namespace
+
+TEST_CASE("a simulation restarts from its checkpoint")
+{
+  auto fname = temp_file("bwsl_checkpoint_test.ckp");
+  std::filesystem::remove(fname);
+
+  auto sim = Simulation{};
+  sim.lattice = Lattice(SquareLattice, std::vector<size_t>{ 4UL, 6UL });
+  auto ckp = io::CheckpointManager(fname);
+  sim.Register(ckp);
+  REQUIRE(ckp.GetSize() == 4UL);
+  REQUIRE_FALSE(ckp.Load());
+
+  sim.Run(1000);
+  ckp.Save();
+  REQUIRE(ckp.Exists());
+  REQUIRE_FALSE(std::filesystem::exists(fname + ".tmp"));
+
+  // the lattice comes back without being built again
+  auto restarted = Simulation{};
+  auto other = io::CheckpointManager(fname);
+  restarted.Register(other);
+  REQUIRE(other.Load());
+  REQUIRE(restarted.lattice.GetNumSites() == 24UL);
+  REQUIRE(restarted.lattice.GetNeighbors(5UL) ==
+          sim.lattice.GetNeighbors(5UL));
+  REQUIRE(restarted.lattice.GetDistance(0UL, 7UL) ==
+          sim.lattice.GetDistance(0UL, 7UL));
+  REQUIRE(restarted.rng == sim.rng);
+  REQUIRE(restarted.hist.GetResults() == sim.hist.GetResults());
+  REQUIRE(restarted.stats.GetAccepted() == 1000UL);
+
+  sim.Run(500);
+  restarted.Run(500);
+  REQUIRE(restarted.hist.GetResults() == sim.hist.GetResults());
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("background checkpoints are snapshots")
+{
+  auto fname = temp_file("bwsl_checkpoint_async.ckp");
+  std::filesystem::remove(fname);
+
+  auto sim = Simulation{};
+  auto ckp = io::CheckpointManager(fname);
+  sim.Register(ckp);
+  sim.Run(100);
+  auto rng = sim.rng;
+
+  // changes after SaveAsync returns are not in the checkpoint
+  ckp.SaveAsync();
+  sim.Run(100);
+  ckp.Wait();
+
+  auto restarted = Simulation{};
+  auto other = io::CheckpointManager(fname);
+  restarted.Register(other);
+  REQUIRE(other.Load());
+  REQUIRE(restarted.rng == rng);
+  REQUIRE(restarted.stats.GetProposed() == 100UL);
+
+  // a second checkpoint replaces the first one
+  ckp.SaveAsync();
+  ckp.SaveAsync();
+  REQUIRE(other.Load());
+  REQUIRE(restarted.stats.GetProposed() == 200UL);
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("damaged checkpoints are refused")
+{
+  auto fname = temp_file("bwsl_checkpoint_damaged.ckp");
+  std::filesystem::remove(fname);
+
+  auto sim = Simulation{};
+  auto ckp = io::CheckpointManager(fname);
+  sim.Register(ckp);
+  sim.Run(100);
+  ckp.Save();
+
+  SECTION("a flipped byte")
+  {
+    auto f =
+      std::fstream(fname, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(40);
+    f.put('\x7f');
+  }
+
+  SECTION("a truncated file")
+  {
+    auto size = std::filesystem::file_size(fname);
+    std::filesystem::resize_file(fname, size / 2UL);
+  }
+
+  REQUIRE_THROWS_AS(ckp.Load(), exception::CheckpointError);
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("components are matched by name")
+{
+  auto fname = temp_file("bwsl_checkpoint_names.ckp");
+  std::filesystem::remove(fname);
+
+  auto sim = Simulation{};
+  auto ckp = io::CheckpointManager(fname);
+  sim.Register(ckp);
+  REQUIRE_THROWS_AS(ckp.Register("rng", sim.rng), exception::CheckpointError);
+  ckp.Save();
+
+  // extra components of the file are ignored, missing ones are an error
+  auto rng = std::mt19937_64{};
+  auto fewer = io::CheckpointManager(fname);
+  fewer.Register("rng", rng);
+  REQUIRE(fewer.Load());
+  REQUIRE(rng == sim.rng);
+
+  auto more = io::CheckpointManager(fname);
+  more.Register("rng", rng);
+  more.Register("walkers", rng);
+  REQUIRE_THROWS_AS(more.Load(), exception::CheckpointError);
+
+  std::filesystem::remove(fname);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
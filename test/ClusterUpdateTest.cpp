@@ -0,0 +1,195 @@
+//===-- ClusterUpdateTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the WolffUpdate and SwendsenWangUpdate Classes
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/ThreadPool.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+#include <bwsl/mcutils/SwendsenWangUpdate.hpp>
+#include <bwsl/mcutils/WolffUpdate.hpp>
+
+// std
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+
+namespace {
+
+/// Inverse temperature of the tests, close to the critical one
+constexpr auto beta = 0.4;
+
+/// Energy of the Ising spins on the lattice
+auto
+energy(Lattice const& lattice, std::vector<int> const& spins) -> double
+{
+  auto e = 0.0;
+  for (auto i = 0UL; i < lattice.GetNumSites(); i++) {
+    for (auto j : lattice.GetNeighbors(i)) {
+      e -= 0.5 * spins[i] * spins[j];
+    }
+  }
+  return e;
+}
+
+/// Exact mean energy of the Ising spins on the lattice
+auto
+exact_energy(Lattice const& lattice) -> double
+{
+  auto const n = lattice.GetNumSites();
+  auto z = 0.0;
+  auto ez = 0.0;
+  auto spins = std::vector<int>(n);
+  for (auto state = 0UL; state < (1UL << n); state++) {
+    for (auto i = 0UL; i < n; i++) {
+      spins[i] = ((state >> i) & 1UL) != 0UL ? 1 : -1;
+    }
+    auto e = energy(lattice, spins);
+    auto w = std::exp(-beta * e);
+    z += w;
+    ez += e * w;
+  }
+  return ez / z;
+}
+
+} // namespace
+
+TEST_CASE("Wolff updates sample the Ising model")
+{
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 4UL, 4UL });
+  auto wolff = WolffUpdate(lattice, ising_bond_probability(beta));
+  auto spins = std::vector<int>(16UL, 1);
+  auto rng = Philox4x32(1UL);
+
+  auto e = accumulators::NeumaierAccumulator{};
+  for (auto k = 0; k < 200000; k++) {
+    wolff.Step(spins, rng);
+    e.Add(energy(lattice, spins));
+  }
+  REQUIRE(e.Mean() == Catch::Approx(exact_energy(lattice)).epsilon(0.01));
+
+  REQUIRE(wolff.GetStats().GetAccepted() == 200000UL);
+  REQUIRE(wolff.GetSizes().GetCount() == 200000UL);
+  REQUIRE(wolff.GetSizes().GetNbins() == 17UL);
+  REQUIRE(wolff.GetSizes().GetCount(0UL) == 0UL);
+}
+
+TEST_CASE("Wolff clusters follow the bond probability")
+{
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 6UL, 5UL });
+  auto spins = std::vector<int>(30UL, -1);
+  auto rng = Philox4x32(2UL);
+
+  auto single = WolffUpdate(lattice, 0.0);
+  REQUIRE(single.Step(spins, rng) == 1UL);
+
+  auto all = WolffUpdate(lattice, 1.0);
+  spins.assign(30UL, 1);
+  REQUIRE(all.Step(spins, rng) == 30UL);
+  REQUIRE(spins == std::vector<int>(30UL, -1));
+}
+
+TEST_CASE("Swendsen-Wang updates sample the Ising model")
+{
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 4UL, 4UL });
+  auto sw = SwendsenWangUpdate(lattice, 2UL, ising_bond_probability(beta));
+  REQUIRE(sw.GetNumBlocks() == 2UL);
+  auto spins = std::vector<int>(16UL, 1);
+  auto rng = Philox4x32(3UL);
+  auto pool = ThreadPool(2UL);
+
+  auto e = accumulators::NeumaierAccumulator{};
+  auto nclusters = 0UL;
+  for (auto k = 0; k < 100000; k++) {
+    nclusters += sw.Step(spins, rng, pool);
+    e.Add(energy(lattice, spins));
+
+    // a cluster has a single spin
+    auto const& labels = sw.GetLabels();
+    for (auto i = 0UL; i < 16UL; i++) {
+      REQUIRE(spins[i] == spins[labels[i]]);
+    }
+  }
+  REQUIRE(e.Mean() == Catch::Approx(exact_energy(lattice)).epsilon(0.01));
+  REQUIRE(sw.GetStats().GetProposed() == nclusters);
+  REQUIRE(sw.GetSizes().GetCount() == nclusters);
+  REQUIRE(sw.GetStats().GetAcceptedRatio() == Catch::Approx(0.5).margin(0.01));
+}
+
+TEST_CASE("Swendsen-Wang blocks do not depend on the threads")
+{
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 12UL, 10UL });
+  auto padd = ising_bond_probability(0.44);
+
+  auto run = [&](size_t nthreads) {
+    auto sw = SwendsenWangUpdate(lattice, 4UL, padd);
+    auto spins = std::vector<int>(120UL, 1);
+    auto rng = Philox4x32(4UL);
+    auto pool = ThreadPool(nthreads);
+    for (auto k = 0; k < 200; k++) {
+      sw.Step(spins, rng, pool);
+    }
+    return std::make_pair(spins, sw.GetLabels());
+  };
+
+  auto one = run(1UL);
+  REQUIRE(run(4UL) == one);
+
+  // a single block labels the same clusters
+  auto sw = SwendsenWangUpdate(lattice, 1UL, 1.0);
+  auto spins = std::vector<int>(120UL, 1);
+  auto rng = Philox4x32(5UL);
+  auto pool = ThreadPool(3UL);
+  REQUIRE(sw.Step(spins, rng, pool) == 1UL);
+  auto blocked = SwendsenWangUpdate(lattice, 5UL, 1.0);
+  REQUIRE(blocked.Step(spins, rng, pool) == 1UL);
+  REQUIRE(blocked.GetSizes().GetCount(120UL) == 1UL);
+}
+
+TEST_CASE("cluster statistics survive a checkpoint")
+{
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 4UL, 4UL });
+  auto wolff = WolffUpdate(lattice, 0.5);
+  auto spins = std::vector<int>(16UL, 1);
+  auto rng = Philox4x32(6UL);
+  for (auto k = 0; k < 100; k++) {
+    wolff.Step(spins, rng);
+  }
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << wolff;
+  }
+  auto restored = WolffUpdate(lattice);
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+  REQUIRE(restored.GetBondProbability() == 0.5);
+  REQUIRE(restored.GetSizes().GetResults() == wolff.GetSizes().GetResults());
+
+  auto copy = spins;
+  auto rng2 = rng;
+  REQUIRE(restored.Step(copy, rng2) == wolff.Step(spins, rng));
+  REQUIRE(copy == spins);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
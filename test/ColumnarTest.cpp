@@ -0,0 +1,192 @@
+//===-- ColumnarTest.cpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the binary columnar format
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/IOUtils.hpp>
+#include <bwsl/Lattice.hpp>
+#include <bwsl/ObservableGroup.hpp>
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+auto
+temp_file(std::string const& name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST_CASE("columnar files round trip")
+{
+  auto fname = temp_file("bwsl_columnar.bcol");
+  auto columns = std::vector<io::Column>{ { "step", io::ColumnType::UInt64 },
+                                          { "energy", io::ColumnType::Float64 },
+                                          { "spin", io::ColumnType::Int32 },
+                                          { "ratio", io::ColumnType::Float32 } };
+  {
+    auto out = io::ColumnarWriter(fname, columns, false, 7UL);
+    for (auto i = 0UL; i < 100UL; i++) {
+      out.AppendRow(i, -0.5 * i, (i % 2 == 0) ? 1 : -1, 0.25);
+    }
+    REQUIRE(out.GetNumRows() == 100UL);
+  }
+
+  auto in = io::ColumnarReader(fname);
+
+  REQUIRE(in.GetColumns() == columns);
+  REQUIRE(in.GetNumRows() == 100UL);
+  REQUIRE(in.GetNumBlocks() == 15UL);
+  REQUIRE(!in.IsTruncated());
+
+  auto step = in.GetColumn<std::uint64_t>("step");
+  auto energy = in.GetColumn<double>(1UL);
+  auto spin = in.GetColumn<int>("spin");
+  auto ratio = in.GetColumn<double>("ratio");
+  for (auto i = 0UL; i < 100UL; i++) {
+    REQUIRE(step[i] == i);
+    REQUIRE(energy[i] == -0.5 * i);
+    REQUIRE(spin[i] == ((i % 2 == 0) ? 1 : -1));
+    REQUIRE(ratio[i] == 0.25);
+  }
+
+  auto csv = std::ostringstream{};
+  in.WriteCSV(csv);
+  auto expected = std::string("step,energy,spin,ratio\n0,-0,1,0.25\n1,-0.5,");
+  REQUIRE(csv.str().substr(0, expected.size()) == expected);
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("a torn block is dropped when appending")
+{
+  auto fname = temp_file("bwsl_columnar_torn.bcol");
+  auto columns = std::vector<io::Column>{ { "x", io::ColumnType::Float64 } };
+  {
+    auto out = io::ColumnarWriter(fname, columns, false, 4UL);
+    for (auto i = 0; i < 8; i++) {
+      out.AppendRow(static_cast<double>(i));
+    }
+  }
+  auto size = std::filesystem::file_size(fname);
+
+  // simulate a crash in the middle of the write of a block
+  {
+    auto out = std::ofstream(fname, std::ios::binary | std::ios::app);
+    auto garbage = std::string("BLCK\x04\0\0\0partial", 15);
+    out.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+  }
+
+  {
+    auto in = io::ColumnarReader(fname);
+    REQUIRE(in.IsTruncated());
+    REQUIRE(in.GetNumRows() == 8UL);
+    REQUIRE(in.GetValidSize() == size);
+  }
+
+  {
+    auto out = io::ColumnarWriter(fname, columns, true, 4UL);
+    REQUIRE(out.GetNumRows() == 8UL);
+    out.AppendRow(8.0);
+  }
+
+  auto in = io::ColumnarReader(fname);
+  REQUIRE(!in.IsTruncated());
+  auto x = in.GetColumn<double>("x");
+  REQUIRE(x.size() == 9UL);
+  REQUIRE(x[8] == 8.0);
+
+  auto other = std::vector<io::Column>{ { "y", io::ColumnType::Float64 } };
+  REQUIRE_THROWS_AS(io::ColumnarWriter(fname, other, true),
+                    exception::ColumnarFormatError);
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("rows keep their cells across a flush")
+{
+  auto fname = temp_file("bwsl_columnar_rows.bcol");
+  auto columns = std::vector<io::Column>{ { "x", io::ColumnType::Float64 },
+                                          { "y", io::ColumnType::Int32 } };
+  {
+    auto out = io::ColumnarWriter(fname, columns, false, 4UL);
+    out.AppendRow(0.5, 1);
+    out.AppendRow(1.5, 2);
+
+    // a flush in the middle of a row writes only the completed rows
+    out.Push(2.5);
+    out.Flush();
+    REQUIRE(io::ColumnarReader(fname).GetNumRows() == 2UL);
+    out.Push(3);
+    out.EndRow();
+
+    auto values = std::vector<double>{ 1.0, 2.0, 3.0 };
+    REQUIRE_THROWS_AS(out.AppendRow(values.begin(), values.end()),
+                      exception::ColumnarFormatError);
+  }
+
+  auto in = io::ColumnarReader(fname);
+  auto x = in.GetColumn<double>("x");
+  auto y = in.GetColumn<int>("y");
+  REQUIRE(x == std::vector<double>{ 0.5, 1.5, 2.5 });
+  REQUIRE(y == std::vector<int>{ 1, 2, 3 });
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("observables and lattices can be saved as columns")
+{
+  auto fname = temp_file("bwsl_columnar_og.bcol");
+
+  auto og = ObservableGroup<int>("unused.csv", { 2, 1 });
+  {
+    auto out = io::ColumnarWriter(fname, og.GetColumns());
+    og.Measure(1, 1.0);
+    og.Measure(2, 3.0);
+    og.WriteAndReset(out);
+  }
+  {
+    auto in = io::ColumnarReader(fname);
+    REQUIRE(in.GetColumns()[0].name == "1");
+    REQUIRE(in.GetColumn<double>("2") == std::vector<double>{ 3.0 });
+  }
+
+  auto lattice = Lattice(SquareLattice, std::vector<size_t>{ 3UL, 4UL });
+  lattice.SavePairs(fname, io::TableFormat::Columnar);
+  {
+    auto in = io::ColumnarReader(fname);
+    REQUIRE(in.GetNumColumns() == 9UL);
+    REQUIRE(in.GetNumRows() == pairs::GetNumPairs(12UL));
+    auto a = in.GetColumn<size_t>("a");
+    auto b = in.GetColumn<size_t>("b");
+    auto d0 = in.GetColumn<double>("d0");
+    for (auto i = 0UL; i < in.GetNumRows(); i++) {
+      REQUIRE(d0[i] == lattice.GetVector(a[i], b[i])[0]);
+    }
+  }
+
+  std::filesystem::remove(fname);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,118 @@
+//===-- ConcurrentHistAccumulatorTest.cpp ----------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ConcurrentHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/ConcurrentHistAccumulator.hpp>
+#include <bwsl/HistAccumulator.hpp>
+
+// std
+#include <random>
+#include <thread>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+TEST_CASE("concurrent histograms behave like HistAccumulator")
+{
+  auto gen = std::mt19937(19890501UL);
+  auto d = std::uniform_int_distribution<size_t>(0UL, 9UL);
+  auto w = std::uniform_real_distribution<double>(0.0, 2.0);
+
+  auto h = HistAccumulator(10UL);
+  auto c = ConcurrentHistAccumulator(10UL, 3UL);
+
+  REQUIRE(c.GetNbins() == 10UL);
+  REQUIRE(c.GetNshards() == 3UL);
+  REQUIRE(c.GetResult(4UL) == 0.0);
+
+  for (auto i = 0UL; i < 10000UL; i++) {
+    auto idx = d(gen);
+    if (i % 3UL == 0UL) {
+      auto val = w(gen);
+      h.Add(idx, val);
+      c.Add(idx, val);
+    } else {
+      h.Add(idx);
+      c.Add(idx);
+    }
+  }
+
+  REQUIRE(c.GetCount() == h.GetCount());
+  auto rh = h.GetResults();
+  auto rc = c.GetResults();
+  for (auto i = 0UL; i < 10UL; i++) {
+    REQUIRE(c.GetCount(i) == h.GetCount(i));
+    REQUIRE(c.GetResult(i) == Approx(h.GetResult(i)));
+    REQUIRE(rc[i] == Approx(rh[i]));
+  }
+
+  c.Reset();
+  REQUIRE(c.GetCount() == 0UL);
+  REQUIRE(c.GetResult(4UL) == 0.0);
+  c.Add(4UL);
+  REQUIRE(c.GetResult(4UL) == 1.0);
+}
+
+TEST_CASE("concurrent histograms grow with ForceAdd")
+{
+  auto c = ConcurrentHistAccumulator(4UL, 2UL);
+
+  c.ForceAdd(1000UL);
+  c.ForceAdd(70UL, 2.0);
+  c.Add(3UL);
+
+  REQUIRE(c.GetNbins() == 1001UL);
+  REQUIRE(c.GetCount() == 3UL);
+  REQUIRE(c.GetCount(1000UL) == 1UL);
+  REQUIRE(c.GetResult(70UL) == Approx(2.0 / 3.0));
+  REQUIRE(c.GetResults(3UL)[1000UL] == Approx(1.0));
+}
+
+TEST_CASE("concurrent histograms can be filled by many threads")
+{
+  auto const nthreads = 8UL;
+  auto const nsteps = 20000UL;
+  auto c = ConcurrentHistAccumulator(16UL, 4UL);
+
+  auto threads = std::vector<std::thread>{};
+  for (auto t = 0UL; t < nthreads; t++) {
+    threads.emplace_back([&c, t, nsteps]() {
+      for (auto i = 0UL; i < nsteps; i++) {
+        // every thread also grows the histogram
+        c.ForceAdd((i + t) % (16UL + 64UL * t));
+        c.Add(i % 16UL, 0.5);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  REQUIRE(c.GetNbins() == 16UL + 64UL * (nthreads - 1UL));
+  REQUIRE(c.GetCount() == 2UL * nthreads * nsteps);
+
+  auto sum = 0.0;
+  for (auto r : c.GetResults()) {
+    sum += r;
+  }
+  REQUIRE(sum == Approx(0.75));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,87 @@
+//===-- CountingHistAccumulatorTest.cpp ------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the CountingHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/CountingHistAccumulator.hpp>
+#include <bwsl/HistAccumulator.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+TEST_CASE("counting histograms count like HistAccumulator")
+{
+  auto gen = std::mt19937(19890501UL);
+  auto d = std::uniform_int_distribution<size_t>(0UL, 7UL);
+
+  auto h = HistAccumulator(8UL);
+  auto c = CountingHistAccumulator32(8UL);
+
+  for (auto i = 0UL; i < 100000UL; i++) {
+    auto idx = d(gen);
+    h.Add(idx);
+    c.Add(idx);
+  }
+
+  REQUIRE_FALSE(c.IsPromoted());
+  REQUIRE(c.GetCount() == h.GetCount());
+  for (auto i = 0UL; i < 8UL; i++) {
+    REQUIRE(c.GetCount(i) == h.GetCount(i));
+    REQUIRE(c.GetResult(i) == Approx(h.GetResult(i)));
+  }
+  auto r = c.GetResults(2UL);
+  REQUIRE(r[2] == 1.0);
+  REQUIRE(r[5] == Approx(static_cast<double>(c.GetCount(5UL)) /
+                         static_cast<double>(c.GetCount(2UL))));
+}
+
+TEST_CASE("weighted measurements promote counting histograms")
+{
+  auto h = HistAccumulator(4UL);
+  auto c = CountingHistAccumulator64(4UL);
+
+  for (auto i = 0UL; i < 100UL; i++) {
+    h.Add(i % 4UL);
+    c.Add(i % 4UL);
+  }
+  h.Add(1UL, 0.25);
+  c.Add(1UL, 0.25);
+  REQUIRE(c.IsPromoted());
+
+  h.ForceAdd(6UL);
+  c.ForceAdd(6UL);
+  h.Add(0UL);
+  c.Add(0UL);
+
+  REQUIRE(c.GetNbins() == 7UL);
+  REQUIRE(c.GetCount() == h.GetCount());
+  for (auto i = 0UL; i < 7UL; i++) {
+    REQUIRE(c.GetCount(i) == h.GetCount(i));
+    REQUIRE(c.GetResult(i) == Approx(h.GetResult(i)));
+  }
+
+  c.Reset();
+  REQUIRE_FALSE(c.IsPromoted());
+  REQUIRE(c.GetCount() == 0UL);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
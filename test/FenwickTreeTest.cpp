@@ -0,0 +1,116 @@
+//===-- FenwickTreeTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the FenwickTree Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/sampling/FenwickTree.hpp>
+
+// std
+#include <cmath>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("prefix sums and searches follow the weights")
+{
+  auto tree = sampling::FenwickTree({ 1.0, 0.0, 2.0, 3.0, 0.0, 4.0, 0.5 });
+  REQUIRE(tree.GetSize() == 7UL);
+  REQUIRE(tree.GetTotal() == 10.5);
+  REQUIRE(tree.GetPrefix(0UL) == 0.0);
+  REQUIRE(tree.GetPrefix(3UL) == 3.0);
+  REQUIRE(tree.GetPrefix(6UL) == 10.0);
+
+  REQUIRE(tree.Find(0.0) == 0UL);
+  REQUIRE(tree.Find(0.999) == 0UL);
+  REQUIRE(tree.Find(1.0) == 2UL);
+  REQUIRE(tree.Find(6.0) == 5UL);
+  REQUIRE(tree.Find(10.2) == 6UL);
+  // rounding beyond the total never selects a zero weight
+  REQUIRE(tree.Find(11.0) == 6UL);
+
+  tree.Set(6UL, 0.0);
+  REQUIRE(tree.Find(10.2) == 5UL);
+  tree.Set(1UL, 7.0);
+  REQUIRE(tree.Get(1UL) == 7.0);
+  REQUIRE(tree.Find(1.0) == 1UL);
+  REQUIRE(tree.GetTotal() == 17.0);
+
+  REQUIRE_THROWS_AS(tree.Set(0UL, -1.0), exception::InvalidWeights);
+}
+
+TEST_CASE("many updates do not make the sums drift")
+{
+  auto const n = 1000UL;
+  auto rng = std::mt19937_64(23UL);
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+
+  // rates spanning many orders of magnitude
+  auto tree = sampling::FenwickTree(n);
+  auto exact = std::vector<double>(n, 0.0);
+  for (auto i = 0; i < 200000; i++) {
+    auto idx = rng() % n;
+    auto w = std::pow(10.0, 12.0 * udist(rng) - 6.0);
+    tree.Set(idx, w);
+    exact[idx] = w;
+  }
+
+  auto sum = 0.0L;
+  for (auto w : exact) {
+    sum += w;
+  }
+  REQUIRE(tree.GetTotal() == Approx(static_cast<double>(sum)).epsilon(1e-14));
+
+  tree.Rebuild();
+  auto counts = std::vector<double>(n, 0.0);
+  for (auto i = 0UL; i < n; i++) {
+    tree.Set(i, i % 2UL == 0UL ? 1.0 : 0.0);
+  }
+  for (auto i = 0; i < 100000; i++) {
+    counts[tree.Sample(rng)] += 1.0;
+  }
+  for (auto i = 1UL; i < n; i += 2UL) {
+    REQUIRE(counts[i] == 0.0);
+  }
+}
+
+TEST_CASE("a residual total over zero weights is rejected")
+{
+  auto const n = 64UL;
+  auto rng = std::mt19937_64(4UL);
+
+  auto tree = sampling::FenwickTree(n);
+  for (auto i = 0; i < 10000; i++) {
+    auto w = std::pow(10.0, static_cast<double>(rng() % 13UL) - 6.0);
+    tree.Set(rng() % n, w);
+  }
+  for (auto i = 0UL; i < n; i++) {
+    tree.Set(i, 0.0);
+  }
+
+  // the updates leave a positive rounding residual with no weight behind it
+  REQUIRE(tree.GetTotal() > 0.0);
+  REQUIRE_THROWS_AS(tree.Find(0.0), exception::InvalidWeights);
+  REQUIRE_THROWS_AS(tree.Find(tree.GetTotal()), exception::InvalidWeights);
+
+  tree.Rebuild();
+  REQUIRE(tree.GetTotal() == 0.0);
+  REQUIRE_THROWS_AS(tree.Find(0.0), exception::InvalidWeights);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -16,6 +16,7 @@
 #include <bwsl/accumulators/KahanAccumulator.hpp>
 
 // std
+#include <cstring>
 #include <iostream>
 #include <vector>
 
@@ -73,4 +74,63 @@ TEST_CASE("The sum is correct")
   }
 }
 
+TEST_CASE("Accumulators can be merged")
+{
+  auto a = KahanAccumulator();
+  auto b = KahanAccumulator();
+  auto all = KahanAccumulator();
+  auto eps = epsilon();
+
+  a.Add(1.0);
+  all.Add(1.0);
+  for (auto i = 0UL; i < 1000UL; i++) {
+    a.Add(eps);
+    b.Add(eps);
+    all.Add(eps);
+    all.Add(eps);
+  }
+  a.Merge(b);
+
+  REQUIRE(a.Count() == all.Count());
+  REQUIRE(a.Sum() == all.Sum());
+  REQUIRE(a.Sum() == Approx(1.0 + 2000.0 * eps).epsilon(1e-15));
+}
+
+TEST_CASE("Batches are summed with compensation")
+{
+  auto eps = epsilon();
+  auto x = std::vector<double>{ 1.0 };
+  for (auto i = 0UL; i < 1001UL; i++) {
+    x.push_back(eps);
+  }
+
+  auto single = KahanAccumulator();
+  for (auto v : x) {
+    single.Add(v);
+  }
+  auto batch = KahanAccumulator();
+  batch.Add(0.5);
+  batch.AddBatch(x.data(), x.size());
+
+  REQUIRE(batch.Count() == single.Count() + 1UL);
+  REQUIRE(batch.Sum() - 0.5 == Approx(single.Sum()).epsilon(1e-15));
+  REQUIRE(batch.Sum() == Approx(1.5 + 1001.0 * eps).epsilon(1e-15));
+}
+
+TEST_CASE("Arrays of accumulators can be copied as raw bytes")
+{
+  auto v = std::vector<KahanAccumulator>(16UL);
+  for (auto i = 0UL; i < v.size(); i++) {
+    v[i].Add(1.0);
+    v[i].Add(epsilon() * static_cast<double>(i));
+  }
+
+  auto w = std::vector<KahanAccumulator>(v.size());
+  std::memcpy(w.data(), v.data(), v.size() * sizeof(KahanAccumulator));
+  for (auto i = 0UL; i < v.size(); i++) {
+    REQUIRE(w[i].Sum() == v[i].Sum());
+    REQUIRE(w[i].Count() == 2UL);
+  }
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
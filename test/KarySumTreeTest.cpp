@@ -0,0 +1,79 @@
+//===-- KarySumTreeTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the KarySumTree Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/sampling/FenwickTree.hpp>
+#include <bwsl/sampling/KarySumTree.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("the k-ary tree finds the same indices as the Fenwick tree")
+{
+  auto rng = std::mt19937_64(29UL);
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+
+  for (auto n : { 1UL, 7UL, 8UL, 9UL, 64UL, 1000UL }) {
+    auto weights = std::vector<double>(n);
+    for (auto& w : weights) {
+      w = udist(rng) < 0.3 ? 0.0 : udist(rng);
+    }
+    weights[n - 1UL] = 1.0;
+
+    auto kary = sampling::KarySumTree<>(weights);
+    auto binary = sampling::KarySumTree<2>(weights);
+    auto fenwick = sampling::FenwickTree(weights);
+    REQUIRE(kary.GetSize() == n);
+    REQUIRE(kary.GetTotal() == Approx(fenwick.GetTotal()));
+
+    for (auto i = 0; i < 200; i++) {
+      auto idx = rng() % n;
+      auto w = udist(rng);
+      kary.Set(idx, w);
+      binary.Set(idx, w);
+      fenwick.Set(idx, w);
+      REQUIRE(kary.Get(idx) == w);
+
+      auto x = udist(rng) * fenwick.GetTotal() * 0.999;
+      auto found = fenwick.Find(x);
+      REQUIRE(kary.Find(x) == found);
+      REQUIRE(binary.Find(x) == found);
+    }
+
+    // rounding beyond the total selects the last positive weight
+    REQUIRE(kary.Get(kary.Find(2.0 * kary.GetTotal())) > 0.0);
+  }
+}
+
+TEST_CASE("the k-ary tree rejects invalid weights")
+{
+  auto tree = sampling::KarySumTree<4>(10UL);
+  REQUIRE(tree.GetTotal() == 0.0);
+  REQUIRE_THROWS_AS(tree.Find(0.0), exception::InvalidWeights);
+  REQUIRE_THROWS_AS(tree.Set(3UL, -2.0), exception::InvalidWeights);
+
+  tree.Set(3UL, 2.0);
+  auto rng = std::mt19937_64(1UL);
+  REQUIRE(tree.Sample(rng) == 3UL);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
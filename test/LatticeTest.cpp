@@ -14,10 +14,12 @@
 //===---------------------------------------------------------------------===//
 // bwsl
 #include <bwsl/Lattice.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
 
 // std
 #include <cmath>
 #include <random>
+#include <sstream>
 #include <vector>
 
 // catch
@@ -132,4 +134,27 @@ TEST_CASE("Big Square Lattice")
   }
 }
 
+TEST_CASE("Lattices are restored without computing them again")
+{
+  auto lattice = Lattice(TriangularLattice, std::vector<size_t>{ 4ul, 5ul });
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << lattice;
+  }
+  auto restored = Lattice{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+
+  REQUIRE(restored.GetNumSites() == lattice.GetNumSites());
+  REQUIRE(restored.GetSize() == lattice.GetSize());
+  REQUIRE(restored.HasClosedBoundaries());
+  for (auto i = 0UL; i < lattice.GetNumSites(); i++) {
+    REQUIRE(restored.GetNeighbors(i) == lattice.GetNeighbors(i));
+    REQUIRE(restored.GetPosition(i) == lattice.GetPosition(i));
+    REQUIRE(restored.GetDistance(0UL, i) == lattice.GetDistance(0UL, i));
+  }
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
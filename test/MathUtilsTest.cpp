@@ -0,0 +1,95 @@
+//===-- MathUtilsTest.cpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the searches of MathUtils
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/EytzingerTable.hpp>
+#include <bwsl/MathUtils.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+/// Cumulative sums of uniform or strongly skewed weights, with repetitions
+auto
+make_cdf(size_t n, bool skewed, std::mt19937_64& rng) -> std::vector<double>
+{
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+  auto cdf = std::vector<double>(n);
+  for (auto i = 0UL; i < n; i++) {
+    auto w = skewed ? std::pow(udist(rng), 20.0) * std::exp(-1e-3 * i)
+                    : udist(rng);
+    cdf[i] = udist(rng) < 0.05 ? 0.0 : w;
+  }
+  std::partial_sum(cdf.begin(), cdf.end(), cdf.begin());
+  return cdf;
+}
+
+} // namespace
+
+TEST_CASE("the searches agree with std::upper_bound")
+{
+  auto rng = std::mt19937_64(31UL);
+  auto udist = std::uniform_real_distribution<double>(-0.1, 1.1);
+
+  for (auto skewed : { false, true }) {
+    for (auto n : { 0UL, 1UL, 2UL, 3UL, 100UL, 5000UL, 100000UL }) {
+      auto cdf = make_cdf(n, skewed, rng);
+      auto total = cdf.empty() ? 1.0 : cdf.back();
+      auto table = bwsl::EytzingerTable<double>(cdf);
+      REQUIRE(table.GetSize() == n);
+
+      auto queries = std::vector<double>(cdf.begin(), cdf.end());
+      for (auto i = 0; i < 2000; i++) {
+        queries.push_back(udist(rng) * total);
+      }
+
+      for (auto x : queries) {
+        auto expected = std::upper_bound(cdf.begin(), cdf.end(), x);
+        auto idx = static_cast<size_t>(expected - cdf.begin());
+        REQUIRE(bwsl::upper_bound(cdf.begin(), cdf.end(), x) == expected);
+        REQUIRE(bwsl::upper_bound(cdf.begin(), cdf.end(), x, 2) == expected);
+        REQUIRE(bwsl::branchless_upper_bound(cdf.begin(), cdf.end(), x) ==
+                expected);
+        REQUIRE(table.UpperBound(x) == idx);
+        REQUIRE(table.LowerBound(x) ==
+                static_cast<size_t>(
+                  std::lower_bound(cdf.begin(), cdf.end(), x) - cdf.begin()));
+      }
+    }
+  }
+}
+
+TEST_CASE("integer keys and other iterators are supported")
+{
+  auto keys = std::vector<long>{ 1, 1, 2, 2, 2, 2, 3, 8, 8, 9, 100, 100 };
+  for (auto x = 0L; x < 102L; x++) {
+    auto expected = std::upper_bound(keys.begin(), keys.end(), x);
+    REQUIRE(bwsl::upper_bound(keys.begin(), keys.end(), x, 2) == expected);
+  }
+
+  auto list = std::list<double>{ 1.0, 2.0, 3.0 };
+  REQUIRE(*bwsl::upper_bound(list.begin(), list.end(), 1.5) == 2.0);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
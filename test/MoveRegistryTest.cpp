@@ -0,0 +1,169 @@
+//===-- MoveRegistryTest.cpp -----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the MoveRegistry Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+using Catch::Approx;
+
+namespace {
+
+/// A particle in a harmonic well at unit temperature
+struct Particle
+{
+  double x{ 0.0 };
+  UniformBuffer<Philox4x32> rng{ Philox4x32(11UL) };
+};
+
+/// Metropolis displacement of at most @p step
+auto
+displace(double step, Particle& p) -> MoveResult
+{
+  auto y = p.x + p.rng.Uniform(-step, step);
+  auto prob = std::min(1.0, std::exp(0.5 * (p.x * p.x - y * y)));
+  if (p.rng.Accept(prob)) {
+    p.x = y;
+    return MoveResult::Accept(prob);
+  }
+  return MoveResult::Reject(prob);
+}
+
+} // namespace
+
+TEST_CASE("moves are drawn with their weights")
+{
+  auto registry = MoveRegistry<Particle&>{};
+  auto counts = std::vector<double>(3UL, 0.0);
+  for (auto i = 0UL; i < 3UL; i++) {
+    auto id = registry.Register(
+      fmt::format("Move{}", i),
+      [&counts, i](double, Particle&) {
+        counts[i] += 1.0;
+        return MoveResult::Accept(1.0);
+      },
+      static_cast<double>(i + 1UL));
+    REQUIRE(id == i);
+  }
+  REQUIRE(registry.GetSize() == 3UL);
+  REQUIRE(registry.GetId("Move2") == 2UL);
+  REQUIRE_THROWS_AS(registry.GetId("Move3"), montecarlo::exception::UnknownMove);
+
+  auto p = Particle{};
+  auto rng = Philox4x32(1UL);
+  auto const n = 60000.0;
+  for (auto i = 0; i < 60000; i++) {
+    registry.Step(rng, p);
+  }
+  REQUIRE(counts[0] / n == Approx(1.0 / 6.0).margin(0.01));
+  REQUIRE(counts[1] / n == Approx(2.0 / 6.0).margin(0.01));
+  REQUIRE(counts[2] / n == Approx(3.0 / 6.0).margin(0.01));
+  REQUIRE(registry.GetStats(2UL).GetProposed() ==
+          static_cast<unsigned long>(counts[2]));
+
+  // a move without weight is never drawn
+  registry.SetWeight(0UL, 0.0);
+  for (auto i = 0; i < 1000; i++) {
+    REQUIRE(registry.Select(rng) != 0UL);
+  }
+}
+
+TEST_CASE("step sizes adapt to the target acceptance and then freeze")
+{
+  auto registry = MoveRegistry<Particle&>{};
+  auto id = registry.Register("Displace", displace);
+  registry.SetStep(id, 50.0, 0.4, 0.01, 100.0);
+  registry.SetWindow(500UL);
+
+  auto p = Particle{};
+  auto rng = Philox4x32(2UL);
+  for (auto i = 0; i < 100000; i++) {
+    registry.Step(rng, p);
+  }
+  registry.Freeze();
+  REQUIRE(registry.IsFrozen());
+  REQUIRE(registry.GetStats(id).GetProposed() == 0UL);
+
+  auto step = registry.GetStep(id);
+  REQUIRE(step < 50.0);
+  for (auto i = 0; i < 100000; i++) {
+    registry.Step(rng, p);
+  }
+  REQUIRE(registry.GetStep(id) == step);
+  REQUIRE(registry.GetStats(id).GetAcceptedRatio() ==
+          Approx(0.4).margin(0.03));
+
+  REQUIRE_THROWS_AS(registry.SetStep(id, 1.0),
+                    montecarlo::exception::FrozenMoveRegistry);
+  REQUIRE_THROWS_AS(registry.SetWeight(id, 2.0),
+                    montecarlo::exception::FrozenMoveRegistry);
+  REQUIRE(registry.GetStep(id) == step);
+}
+
+TEST_CASE("registries can be checkpointed")
+{
+  auto registry = MoveRegistry<Particle&>{};
+  registry.Register("Displace", displace, 2.0);
+  registry.SetStep(0UL, 1.0, 0.5);
+  registry.SetWindow(100UL);
+  auto p = Particle{};
+  auto rng = Philox4x32(3UL);
+  for (auto i = 0; i < 1050; i++) {
+    registry.Step(rng, p);
+  }
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << registry;
+  }
+  auto restored = MoveRegistry<Particle&>{};
+  restored.Register("Displace", displace);
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+
+  REQUIRE(restored.GetStep(0UL) == registry.GetStep(0UL));
+  REQUIRE(restored.GetWeight(0UL) == 2.0);
+  REQUIRE(restored.GetStats(0UL).GetAccepted() ==
+          registry.GetStats(0UL).GetAccepted());
+
+  // the moves must be registered before loading
+  ss.clear();
+  ss.seekg(0);
+  auto empty = MoveRegistry<Particle&>{};
+  auto ia2 = io::BinaryIArchive(ss);
+  auto message = std::string{};
+  try {
+    ia2 >> empty;
+  } catch (montecarlo::exception::MoveRegistryMismatch const& e) {
+    message = e.what();
+  }
+  REQUIRE(message == "The registered moves do not match the saved ones");
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -14,8 +14,18 @@
 //===---------------------------------------------------------------------===//
 // bwsl
 #include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// boost
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
 
 // std
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 // catch
@@ -49,4 +59,255 @@ TEST_CASE("vectors can be sized and resized", "[vector]")
   }
 }
 
+TEST_CASE("the sequence of calls is checked", "[movestats]")
+{
+  auto movestats = MoveStats("TestMove");
+  REQUIRE_THROWS_AS(movestats.Accept(0.5), exception::MoveInvalidSequence);
+  movestats.Propose();
+  REQUIRE_THROWS_AS(movestats.Propose(), exception::MoveInvalidSequence);
+}
+
+TEST_CASE("fast statistics match the checked ones", "[movestats]")
+{
+  auto checked = MoveStats("TestMove");
+  auto fast = FastMoveStats("TestMove");
+  auto results = std::vector<MoveResult>{ MoveResult::Accept(0.7),
+                                          MoveResult::Reject(0.2),
+                                          MoveResult::Impossible(),
+                                          MoveResult::Accept(1.0) };
+  for (auto i = 0UL; i < 1000UL; i++) {
+    checked.Add(results[i % results.size()]);
+    fast.Add(results[i % results.size()]);
+  }
+
+  REQUIRE(fast.GetProposed() == checked.GetProposed());
+  REQUIRE(fast.GetAccepted() == checked.GetAccepted());
+  REQUIRE(fast.GetRejected() == checked.GetRejected());
+  REQUIRE(fast.GetImpossible() == checked.GetImpossible());
+  REQUIRE(fast.GetAverageProbability() ==
+          Approx(checked.GetAverageProbability()));
+  REQUIRE(fast.GetAverageProbability() == Approx(0.475));
+
+  // no checks at all
+  fast.Accept(1.0);
+  REQUIRE(fast.GetAccepted() == checked.GetAccepted() + 1UL);
+}
+
+TEST_CASE("statistics can be merged", "[movestats]")
+{
+  auto a = MoveStats("TestMove");
+  auto b = MoveStats("TestMove");
+  auto all = MoveStats("TestMove");
+  for (auto i = 0UL; i < 300UL; i++) {
+    auto res = (i % 3UL == 0UL) ? MoveResult::Accept(0.9)
+                                : MoveResult::Reject(0.1 * (i % 5UL));
+    (i < 100UL ? a : b).Add(res);
+    all.Add(res);
+  }
+  a.Merge(b);
+
+  REQUIRE(a.GetProposed() == all.GetProposed());
+  REQUIRE(a.GetAccepted() == all.GetAccepted());
+  REQUIRE(a.GetRejected() == all.GetRejected());
+  REQUIRE(a.GetAverageProbability() == Approx(all.GetAverageProbability()));
+
+  b.Propose();
+  REQUIRE_THROWS_AS(a.Merge(b), exception::MoveInvalidSequence);
+}
+
+TEST_CASE("per thread statistics merge on read", "[movestats]")
+{
+  auto stats = PerThreadMoveStats<>("TestMove", 4UL);
+  REQUIRE(stats.GetNumThreads() == 4UL);
+
+  auto threads = std::vector<std::thread>{};
+  for (auto t = 0UL; t < stats.GetNumThreads(); t++) {
+    threads.emplace_back([&stats, t]() {
+      auto& s = stats.Get(t);
+      for (auto i = 0UL; i < 1000UL; i++) {
+        s.Add(i % 4UL == t ? MoveResult::Accept(1.0)
+                           : MoveResult::Reject(0.0));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto total = stats.GetTotal();
+  REQUIRE(total.GetName() == "TestMove");
+  REQUIRE(total.GetProposed() == 4000UL);
+  REQUIRE(total.GetAccepted() == 1000UL);
+  REQUIRE(total.GetAcceptedRatio() == Approx(0.25));
+  REQUIRE(total.GetAverageProbability() == Approx(0.25));
+
+  stats.Reset();
+  REQUIRE(stats.GetTotal().GetProposed() == 0UL);
+}
+
+TEST_CASE("moves can be timed", "[movestats]")
+{
+  auto stats = TimedMoveStats("TestMove");
+  auto untimed = FastMoveStats("TestMove");
+  static_assert(sizeof(untimed) == sizeof(BasicMoveStats<false, NoMoveTimer>));
+  static_assert(sizeof(untimed) < sizeof(stats));
+
+  auto sink = 0.0;
+  for (auto i = 0UL; i < 6400UL; i++) {
+    stats.Run([&sink, i]() {
+      // the accepted moves do more work
+      auto n = i % 2UL == 0UL ? 2000UL : 10UL;
+      for (auto j = 0UL; j < n; j++) {
+        sink = sink + std::sqrt(static_cast<double>(i + j));
+      }
+      return i % 2UL == 0UL ? MoveResult::Accept(1.0)
+                            : MoveResult::Reject(0.0);
+    });
+  }
+  REQUIRE(sink > 0.0);
+
+  auto const& timer = stats.GetTimer();
+  REQUIRE(stats.GetProposed() == 6400UL);
+  REQUIRE(timer.GetSamples() == 100UL);
+  REQUIRE(timer.GetMeanTime(MoveStatus::Accepted) >
+          timer.GetMeanTime(MoveStatus::Rejected));
+  REQUIRE(timer.GetMeanTime() > 0.0);
+
+  auto total = 0UL;
+  for (auto h : timer.GetHistogram()) {
+    total += h;
+  }
+  REQUIRE(total == 100UL);
+
+  auto ss = std::stringstream{};
+  ss << stats;
+  REQUIRE(ss.str().find("time = ") != std::string::npos);
+  REQUIRE(ss.str().back() == ')');
+
+  // untimed statistics print as before
+  auto plain = std::stringstream{};
+  plain << untimed;
+  REQUIRE(plain.str().find("time") == std::string::npos);
+
+  auto buf = std::stringstream{};
+  {
+    auto oa = bwsl::io::BinaryOArchive(buf);
+    oa << stats;
+  }
+  auto restored = TimedMoveStats("TestMove");
+  auto ia = bwsl::io::BinaryIArchive(buf);
+  ia >> restored;
+  REQUIRE(restored.GetTimer().GetHistogram() == timer.GetHistogram());
+  REQUIRE(restored.GetTimer().GetMeanTime() == timer.GetMeanTime());
+
+  auto copy = TimedMoveStats("TestMove");
+  copy.Merge(stats);
+  REQUIRE(copy.GetTimer().GetSamples() == 100UL);
+  stats.Reset();
+  REQUIRE(stats.GetTimer().GetSamples() == 0UL);
+}
+
+TEST_CASE("statistics without a timer keep their archives", "[movestats]")
+{
+  // a propose-accept(0.5), propose-reject(0.25), propose-impossible
+  // sequence saved before the timers
+  auto const old =
+    std::string("22 serialization::archive 18 0 0 0 0 7.50000000000000000e-01 "
+                "0.00000000000000000e+00 3 3 1 1 1 0\n");
+
+  auto stats = MoveStats("TestMove");
+  stats.Propose();
+  stats.Accept(0.5);
+  stats.Propose();
+  stats.Reject(0.25);
+  stats.Propose();
+  stats.Impossible();
+
+  auto out = std::ostringstream{};
+  {
+    auto oa = boost::archive::text_oarchive(out);
+    oa << stats;
+  }
+  REQUIRE(out.str() == old);
+
+  auto in = std::istringstream(old);
+  auto ia = boost::archive::text_iarchive(in);
+  auto restored = MoveStats("TestMove");
+  ia >> restored;
+  REQUIRE(restored.GetProposed() == 3UL);
+  REQUIRE(restored.GetAccepted() == 1UL);
+  REQUIRE(restored.GetImpossible() == 1UL);
+  REQUIRE(restored.GetAverageProbability() == Approx(0.25));
+}
+
+TEST_CASE("results are compact", "[movestats]")
+{
+  static_assert(sizeof(MoveResult) == 8UL);
+  static_assert(std::is_trivially_copyable<MoveResult>::value);
+
+  REQUIRE(MoveResult{}.IsImpossible());
+  REQUIRE(MoveResult::Impossible().Probability() == 0.0);
+  auto acc = MoveResult::Accept(0.3);
+  REQUIRE(acc.IsAccepted());
+  REQUIRE(acc.GetStatus() == MoveStatus::Accepted);
+  REQUIRE(acc.Probability() == Approx(0.3).epsilon(1e-15));
+  auto rej = MoveResult::Reject(1.0);
+  REQUIRE(rej.IsRejected());
+  REQUIRE(rej.GetStatus() == MoveStatus::Rejected);
+  REQUIRE(rej.Probability() == 1.0);
+}
+
+TEST_CASE("batches of results are recorded as single ones", "[movestats]")
+{
+  auto results = std::vector<MoveResult>{};
+  for (auto i = 0UL; i < 1003UL; i++) {
+    auto prob = static_cast<double>((i * 37UL) % 101UL) / 100.0;
+    switch (i % 7UL) {
+      case 0UL:
+        results.push_back(MoveResult::Impossible());
+        break;
+      case 1UL:
+      case 2UL:
+      case 3UL:
+        results.push_back(MoveResult::Accept(prob));
+        break;
+      default:
+        results.push_back(MoveResult::Reject(prob));
+        break;
+    }
+  }
+
+  auto check = [&results](auto single, auto batch) {
+    for (auto const& r : results) {
+      single.Add(r);
+    }
+    batch.AddBatch(results);
+    REQUIRE(batch.GetProposed() == single.GetProposed());
+    REQUIRE(batch.GetAccepted() == single.GetAccepted());
+    REQUIRE(batch.GetRejected() == single.GetRejected());
+    REQUIRE(batch.GetImpossible() == single.GetImpossible());
+    REQUIRE(batch.GetAverageProbability() ==
+            Approx(single.GetAverageProbability()).epsilon(1e-14));
+  };
+  check(MoveStats("TestMove"), MoveStats("TestMove"));
+  check(FastMoveStats("TestMove"), FastMoveStats("TestMove"));
+
+  auto stats = MoveStats("TestMove");
+  stats.Propose();
+  REQUIRE_THROWS_AS(stats.AddBatch(results), exception::MoveInvalidSequence);
+
+  // impossible moves count as zero probability whatever they carry
+  results.clear();
+  for (auto i = 0UL; i < 300UL; i++) {
+    results.push_back(i % 2UL == 0UL
+                        ? MoveResult(MoveStatus::Impossible, 0.75)
+                        : MoveResult::Accept(0.5));
+  }
+  check(MoveStats("TestMove"), MoveStats("TestMove"));
+  check(FastMoveStats("TestMove"), FastMoveStats("TestMove"));
+  auto batch = MoveStats("TestMove");
+  batch.AddBatch(results);
+  REQUIRE(batch.GetAverageProbability() == Approx(0.25));
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,112 @@
+//===-- MultiHistAccumulatorTest.cpp ---------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the MultiHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/HyperCubicGrid.hpp>
+#include <bwsl/MultiHistAccumulator.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+TEST_CASE("bins are numbered as the sites of a HyperCubicGrid")
+{
+  auto h = MultiHistAccumulator<3>({ 4UL, 3UL, 5UL });
+  auto g = HyperCubicGrid({ 4UL, 3UL, 5UL }, HyperCubicGrid::boundaries_t::Open);
+
+  REQUIRE(h.GetNbins() == g.GetNumSites());
+  for (auto i = 0UL; i < h.GetNbins(); i++) {
+    auto c = h.GetCoordinates(i);
+    auto d = g.GetCoordinates(i);
+    for (auto k = 0UL; k < 3UL; k++) {
+      REQUIRE(static_cast<long>(c[k]) == d[k]);
+    }
+    REQUIRE(h.GetIndex(c) == i);
+  }
+}
+
+TEST_CASE("multidimensional histograms switch from sparse to dense")
+{
+  auto h = MultiHistAccumulator<2>({ 10UL, 10UL }, 0.1);
+  REQUIRE_FALSE(h.IsDense());
+
+  h.Add({ 1UL, 2UL });
+  h.Add({ 1UL, 2UL });
+  h.Add({ 9UL, 0UL }, 2.0);
+  REQUIRE(h.GetCount() == 3UL);
+  REQUIRE(h.GetCount({ 1UL, 2UL }) == 2UL);
+  REQUIRE(h.GetCount({ 0UL, 0UL }) == 0UL);
+  REQUIRE(h.GetResult({ 9UL, 0UL }) == Approx(2.0 / 3.0));
+  REQUIRE(h.GetNumFilled() == 2UL);
+
+  auto sparse = h.GetResults();
+
+  for (auto i = 0UL; i < 18UL; i++) {
+    h.Add({ 5UL, i % 10UL }, 0.0);
+  }
+  REQUIRE(h.IsDense());
+  REQUIRE(h.GetNumFilled() == 12UL);
+  REQUIRE(h.GetCount({ 1UL, 2UL }) == 2UL);
+  REQUIRE(h.GetResult({ 9UL, 0UL }) == Approx(2.0 / 21.0));
+  REQUIRE(h.GetResults()[12] == Approx(sparse[12] * 3.0 / 21.0));
+
+  h.Reset();
+  REQUIRE_FALSE(h.IsDense());
+  REQUIRE(h.GetCount() == 0UL);
+}
+
+TEST_CASE("multidimensional histograms can be merged")
+{
+  auto gen = std::mt19937(19890501UL);
+  auto d = std::uniform_int_distribution<size_t>(0UL, 7UL);
+
+  auto whole = MultiHistAccumulator<2>({ 8UL, 8UL }, 0.0);
+  auto a = MultiHistAccumulator<2>({ 8UL, 8UL }, 2.0);
+  auto b = MultiHistAccumulator<2>({ 8UL, 8UL });
+  REQUIRE(whole.IsDense());
+
+  auto batch = std::vector<MultiHistAccumulator<2>::coords_t>{};
+  for (auto i = 0; i < 1000; i++) {
+    auto c = MultiHistAccumulator<2>::coords_t{ d(gen), d(gen) % 3UL };
+    whole.Add(c);
+    if (i % 2 == 0) {
+      a.Add(c);
+    } else {
+      batch.push_back(c);
+    }
+  }
+  b.AddBatch(batch.begin(), batch.end());
+  REQUIRE_FALSE(a.IsDense());
+
+  a.Merge(b);
+  REQUIRE(a.GetCount() == whole.GetCount());
+  auto ra = a.GetResults();
+  auto rw = whole.GetResults();
+  for (auto i = 0UL; i < ra.size(); i++) {
+    REQUIRE(ra[i] == Approx(rw[i]));
+  }
+
+  auto c = MultiHistAccumulator<2>({ 8UL, 7UL });
+  REQUIRE_THROWS(a.Merge(c));
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
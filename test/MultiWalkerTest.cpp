@@ -0,0 +1,152 @@
+//===-- MultiWalkerTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the MultiWalker Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+using Catch::Approx;
+
+namespace {
+
+/// A particle in a harmonic well at unit temperature
+struct Particle
+{
+  double x{ 0.0 };
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    // clang-format off
+    ar & x;
+    // clang-format on
+  }
+};
+
+/// Metropolis step of a particle, measuring x^2
+template<class G>
+auto
+step(Particle& p, G& rng, accumulators::KnuthWelfordAccumulator& acc) -> void
+{
+  auto y = p.x + draw_uniform(2.0, rng) - 1.0;
+  if (draw_uniform(1.0, rng) < std::exp(0.5 * (p.x * p.x - y * y))) {
+    p.x = y;
+  }
+  acc.Add(p.x * p.x);
+}
+
+using Driver = MultiWalker<Particle, accumulators::KnuthWelfordAccumulator>;
+
+/// Run a few blocks on @p nthreads threads
+auto
+run(size_t nthreads) -> Driver
+{
+  auto driver = Driver(std::vector<Particle>(13UL), 7UL);
+  auto pool = ThreadPool(nthreads);
+  for (auto b = 0; b < 5; b++) {
+    driver.RunBlock(pool, 2000UL, step<Philox4x32>);
+  }
+  return driver;
+}
+
+} // namespace
+
+TEST_CASE("the results do not depend on the number of threads")
+{
+  auto one = run(1UL);
+  REQUIRE(one.GetNumWalkers() == 13UL);
+  REQUIRE(one.GetBlocks().size() == 5UL);
+  REQUIRE(one.GetBlocks()[0].Count() == 13UL * 2000UL);
+
+  // <x^2> = 1 in the harmonic well
+  auto all = accumulators::KnuthWelfordAccumulator{};
+  for (auto const& b : one.GetBlocks()) {
+    all.Merge(b);
+  }
+  REQUIRE(all.Mean() == Approx(1.0).margin(0.05));
+
+  // walkers draw from different streams
+  REQUIRE(one.GetWalker(0UL).x != one.GetWalker(1UL).x);
+  REQUIRE(one.GetEngine(3UL).GetStream() == 3UL);
+
+  for (auto nthreads : { 2UL, 3UL, 8UL }) {
+    auto many = run(nthreads);
+    for (auto b = 0UL; b < 5UL; b++) {
+      REQUIRE(many.GetBlocks()[b].Mean() == one.GetBlocks()[b].Mean());
+      REQUIRE(many.GetBlocks()[b].ScaledVariance() ==
+              one.GetBlocks()[b].ScaledVariance());
+    }
+    for (auto i = 0UL; i < many.GetNumWalkers(); i++) {
+      REQUIRE(many.GetWalker(i).x == one.GetWalker(i).x);
+    }
+  }
+}
+
+TEST_CASE("merged accumulators match a single one")
+{
+  auto a = accumulators::KnuthWelfordAccumulator{};
+  auto b = accumulators::KnuthWelfordAccumulator{};
+  auto all = accumulators::KnuthWelfordAccumulator{};
+  for (auto i = 0; i < 100; i++) {
+    auto x = std::sin(static_cast<double>(i)) + 3.0;
+    (i < 30 ? a : b).Add(x);
+    all.Add(x);
+  }
+  a.Merge(b);
+  REQUIRE(a.Count() == all.Count());
+  REQUIRE(a.Mean() == Approx(all.Mean()).epsilon(1e-14));
+  REQUIRE(a.Variance(true) == Approx(all.Variance(true)).epsilon(1e-12));
+}
+
+TEST_CASE("drivers can be checkpointed and resumed")
+{
+  using BufferedDriver = MultiWalker<Particle,
+                                     accumulators::KnuthWelfordAccumulator,
+                                     UniformBuffer<Philox4x32>>;
+  auto pool = ThreadPool(2UL);
+  auto driver = BufferedDriver(std::vector<Particle>(4UL), 9UL);
+  driver.RunBlock(pool, 100UL, step<UniformBuffer<Philox4x32>>);
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << driver;
+  }
+  auto restored = BufferedDriver{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+  REQUIRE(restored.GetSeed() == 9UL);
+  REQUIRE(restored.GetBlocks().size() == 1UL);
+
+  driver.RunBlock(pool, 100UL, step<UniformBuffer<Philox4x32>>);
+  restored.RunBlock(pool, 100UL, step<UniformBuffer<Philox4x32>>);
+  REQUIRE(restored.GetBlocks()[1].Mean() == driver.GetBlocks()[1].Mean());
+  for (auto i = 0UL; i < driver.GetNumWalkers(); i++) {
+    REQUIRE(restored.GetWalker(i).x == driver.GetWalker(i).x);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -93,4 +93,20 @@ TEST_CASE("The sum is correct")
   }
 }
 
+TEST_CASE("Merged accumulators keep the compensation")
+{
+  auto a = NeumaierAccumulator();
+  auto b = NeumaierAccumulator();
+  auto big = 1.0e100;
+
+  a.Add(1.0);
+  a.Add(big);
+  b.Add(1.0);
+  b.Add(-big);
+  a.Merge(b);
+
+  REQUIRE(a.Sum() == 2.0);
+  REQUIRE(a.Count() == 4UL);
+}
+
 // vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,227 @@
+//===-- ObservableGroupTest.cpp --------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ObservableGroup Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/ObservableGroup.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// boost
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+auto
+read_lines(std::string const& fname) -> std::vector<std::string>
+{
+  auto in = std::ifstream(fname);
+  auto lines = std::vector<std::string>{};
+  auto line = std::string{};
+  while (std::getline(in, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+TEST_CASE("observables are printed in key order")
+{
+  auto fname =
+    (std::filesystem::temp_directory_path() / "bwsl_observablegroup.csv")
+      .string();
+  auto og = ObservableGroup<std::string>(fname, { "energy", "density" });
+  og.AddObservable("acceptance");
+
+  REQUIRE(og.GetNumObservables() == 3UL);
+
+  og.Measure("energy", 1.0);
+  og.Measure("energy", 3.0);
+  og.Measure("density", 0.5);
+  og.Measure("acceptance", 0.25);
+
+  og.PrintHeaders();
+  og.PrintAndReset(2);
+
+  auto lines = read_lines(fname);
+  REQUIRE(lines.size() == 2UL);
+  REQUIRE(lines[0] == "acceptance,density,energy");
+  REQUIRE(lines[1] == "2.50e-01,5.00e-01,2.00e+00");
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("frozen groups give handles")
+{
+  auto fname =
+    (std::filesystem::temp_directory_path() / "bwsl_observablegroup_h.csv")
+      .string();
+  auto og = ObservableGroup<int>(fname, { 3, 1, 2 });
+
+  REQUIRE_THROWS_AS(og.GetHandle(1), exception::ObservableGroupNotFrozen);
+
+  og.Freeze();
+
+  REQUIRE(og.IsFrozen());
+  REQUIRE_THROWS_AS(og.AddObservable(4), exception::ObservableGroupFrozen);
+  REQUIRE_THROWS_AS(og.GetHandle(4), std::out_of_range);
+
+  auto h1 = og.GetHandle(1);
+  auto h3 = og.GetHandle(3);
+
+  REQUIRE(h1.GetSlot() == 0UL);
+  REQUIRE(h3.GetSlot() == 2UL);
+
+  og.Measure(h1, 2.0);
+  og.Measure(1, 4.0);
+  og.Measure(2, 1.0);
+  og.Measure(h3, -1.0);
+
+  og.PrintHeaders();
+  og.PrintAndReset(1);
+
+  auto lines = read_lines(fname);
+  REQUIRE(lines.size() == 2UL);
+  REQUIRE(lines[0] == "1,2,3");
+  REQUIRE(lines[1] == "3.0e+00,1.0e+00,-1.0e+00");
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("rows can go through a buffered sink")
+{
+  auto fname =
+    (std::filesystem::temp_directory_path() / "bwsl_observablegroup_s.csv")
+      .string();
+
+  for (auto mode : { io::SinkMode::Synchronous, io::SinkMode::Asynchronous }) {
+    auto sink = std::make_shared<io::OutputSink>(fname, false, mode, 16UL);
+    auto og = ObservableGroup<int>(fname, { 0, 1 });
+    og.SetSink(sink);
+
+    og.PrintHeaders();
+    for (auto i = 0; i < 100; i++) {
+      og.Measure(0, static_cast<double>(i));
+      og.Measure(1, 1.0);
+      og.PrintAndReset(1);
+    }
+    og.Flush();
+
+    auto lines = read_lines(fname);
+    REQUIRE(lines.size() == 101UL);
+    REQUIRE(lines[0] == "0,1");
+    REQUIRE(lines[1] == "0.0e+00,1.0e+00");
+    REQUIRE(lines[100] == "9.9e+01,1.0e+00");
+  }
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("saving a group flushes its sink")
+{
+  auto fname =
+    (std::filesystem::temp_directory_path() / "bwsl_observablegroup_f.csv")
+      .string();
+
+  auto sink = std::make_shared<io::OutputSink>(
+    fname, false, io::SinkMode::Asynchronous, 1UL << 20U);
+  auto og = ObservableGroup<int>(fname, { 0 });
+  og.SetSink(sink);
+  og.PrintHeaders();
+  og.Measure(0, 1.0);
+  og.PrintAndReset(1);
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << og;
+  }
+  auto lines = read_lines(fname);
+  REQUIRE(lines.size() == 2UL);
+  REQUIRE(lines[1] == "1.0e+00");
+
+  std::filesystem::remove(fname);
+}
+
+TEST_CASE("archives keep the results but not the output file")
+{
+  auto og = ObservableGroup<int>("first.csv", { 3, 1, 2 });
+  og.Freeze();
+  og.Measure(1, 0.5);
+  og.Measure(og.GetHandle(3), -1.0);
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = boost::archive::text_oarchive(ss);
+    oa << og;
+  }
+  REQUIRE(ss.str().find("first.csv") == std::string::npos);
+
+  auto restored = ObservableGroup<int>("second.csv");
+  auto ia = boost::archive::text_iarchive(ss);
+  ia >> restored;
+  REQUIRE(restored.IsFrozen());
+  REQUIRE(restored.GetNumObservables() == 3UL);
+  REQUIRE(restored.GetHandle(3).GetSlot() == 2UL);
+
+  auto bs = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(bs);
+    oa << og;
+  }
+  REQUIRE(bs.str().find("first.csv") == std::string::npos);
+}
+
+TEST_CASE("archives of the sparse storage can still be loaded")
+{
+  auto fname =
+    (std::filesystem::temp_directory_path() / "bwsl_observablegroup_v0.csv")
+      .string();
+
+  // ObservableGroup<int>("old.csv", { 3, 1, 2 }) with 0.5 and 1.5 measured
+  // on 1, 4.0 on 2 and -1.0 on 3, saved before the dense storage
+  auto ss = std::stringstream(
+    "22 serialization::archive 18 0 0 7 old.csv 0 0 3 0 0 0 1 0 0 "
+    "2.00000000000000000e+00 0.00000000000000000e+00 2 2 "
+    "4.00000000000000000e+00 0.00000000000000000e+00 1 3 "
+    "-1.00000000000000000e+00 0.00000000000000000e+00 1\n");
+
+  auto og = ObservableGroup<int>(fname);
+  auto ia = boost::archive::text_iarchive(ss);
+  ia >> og;
+  REQUIRE_FALSE(og.IsFrozen());
+  REQUIRE(og.GetNumObservables() == 3UL);
+
+  og.PrintHeaders();
+  og.PrintAndReset(1);
+  auto lines = read_lines(fname);
+  REQUIRE(lines.size() == 2UL);
+  REQUIRE(lines[0] == "1,2,3");
+  REQUIRE(lines[1] == "1.0e+00,4.0e+00,-1.0e+00");
+
+  std::filesystem::remove(fname);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
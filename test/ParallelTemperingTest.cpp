@@ -0,0 +1,211 @@
+//===-- ParallelTemperingTest.cpp ------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ParallelTempering Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/Accumulators.hpp>
+#include <bwsl/LinSpace.hpp>
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+using Catch::Approx;
+
+namespace {
+
+/// A particle in a harmonic well
+struct Particle
+{
+  double x{ 0.0 };
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    // clang-format off
+    ar & x;
+    // clang-format on
+  }
+};
+
+/// Energy of a particle
+auto
+energy(Particle const& p) -> double
+{
+  return 0.5 * p.x * p.x;
+}
+
+/// Metropolis step of a particle, with a width growing with the temperature
+auto
+step(Particle& p, double beta, Philox4x32& rng) -> void
+{
+  auto y = p.x + (draw_uniform(2.0, rng) - 1.0) * 3.0 / std::sqrt(beta);
+  auto de = 0.5 * (y * y - p.x * p.x);
+  if (de <= 0.0 || draw_uniform(1.0, rng) < std::exp(-beta * de)) {
+    p.x = y;
+  }
+}
+
+using Tempering = ParallelTempering<Particle>;
+
+/// Temperatures from 1 to 20
+auto
+temperatures() -> std::vector<double>
+{
+  return LinSpace<double>(1.0, 20.0, 5UL).Collect(6UL);
+}
+
+/// Run @p nrounds rounds on @p nthreads threads
+auto
+run(size_t nthreads, size_t nrounds) -> Tempering
+{
+  auto pt = Tempering(std::vector<Particle>(6UL), temperatures(), 11UL);
+  auto pool = ThreadPool(nthreads);
+  for (auto k = 0UL; k < nrounds; k++) {
+    pt.Step(pool, 10UL, step, energy);
+  }
+  return pt;
+}
+
+} // namespace
+
+TEST_CASE("the replicas sample their temperatures")
+{
+  auto pt = Tempering(std::vector<Particle>(6UL), temperatures(), 3UL);
+  REQUIRE(pt.GetSize() == 6UL);
+  REQUIRE(pt.GetTemperature(0UL) == Approx(1.0));
+  REQUIRE(pt.GetTemperature(5UL) == Approx(20.0));
+
+  auto pool = ThreadPool(2UL);
+  auto energies = std::vector<accumulators::NeumaierAccumulator>(6UL);
+  for (auto k = 0UL; k < 20000UL; k++) {
+    pt.Step(pool, 5UL, step, energy);
+    for (auto t = 0UL; t < pt.GetSize(); t++) {
+      energies[t].Add(energy(pt.GetReplicaAtTemperature(t)));
+    }
+
+    // labels and replicas are inverse permutations
+    for (auto t = 0UL; t < pt.GetSize(); t++) {
+      REQUIRE(pt.GetLabel(pt.GetReplicaAt(t)) == t);
+    }
+  }
+
+  // <E> = T / 2
+  for (auto t = 0UL; t < pt.GetSize(); t++) {
+    REQUIRE(energies[t].Mean() ==
+            Approx(0.5 * pt.GetTemperature(t)).epsilon(0.05));
+  }
+
+  // every pair swaps, half of the rounds
+  for (auto t = 0UL; t + 1UL < pt.GetSize(); t++) {
+    auto const& s = pt.GetSwapStats(t);
+    REQUIRE(s.GetProposed() == 10000UL);
+    REQUIRE(s.GetAccepted() > 0UL);
+    REQUIRE(s.GetAccepted() < s.GetProposed());
+  }
+  REQUIRE(pt.GetRoundTrips() > 0UL);
+}
+
+TEST_CASE("the results do not depend on the number of threads")
+{
+  auto one = run(1UL, 500UL);
+  for (auto nthreads : { 2UL, 4UL }) {
+    auto many = run(nthreads, 500UL);
+    for (auto r = 0UL; r < one.GetSize(); r++) {
+      REQUIRE(many.GetReplica(r).x == one.GetReplica(r).x);
+      REQUIRE(many.GetLabel(r) == one.GetLabel(r));
+    }
+    REQUIRE(many.GetRoundTrips() == one.GetRoundTrips());
+  }
+}
+
+TEST_CASE("retuning equalizes the swap rates")
+{
+  auto pt = Tempering(std::vector<Particle>(6UL), temperatures(), 5UL);
+  auto pool = ThreadPool(2UL);
+
+  // spread of the swap rates of the current temperatures
+  auto spread = [&pt, &pool]() {
+    for (auto k = 0UL; k < 20000UL; k++) {
+      pt.Step(pool, 2UL, step, energy);
+    }
+    auto lo = 1.0;
+    auto hi = 0.0;
+    for (auto t = 0UL; t + 1UL < pt.GetSize(); t++) {
+      auto rate = pt.GetSwapStats(t).GetAverageProbability();
+      lo = std::min(lo, rate);
+      hi = std::max(hi, rate);
+    }
+    return hi - lo;
+  };
+
+  auto before = spread();
+  for (auto k = 0; k < 4; k++) {
+    pt.Retune();
+    spread();
+  }
+  pt.Retune();
+  auto after = spread();
+  REQUIRE(after < 0.5 * before);
+
+  // the ends do not move and the order is kept
+  auto temps = pt.GetTemperatures();
+  REQUIRE(temps.front() == Approx(1.0));
+  REQUIRE(temps.back() == Approx(20.0));
+  REQUIRE(std::is_sorted(temps.begin(), temps.end()));
+}
+
+TEST_CASE("the replicas can be checkpointed")
+{
+  auto pt = run(2UL, 100UL);
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << pt;
+  }
+  auto restored = Tempering{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+  REQUIRE(restored.GetSwapStats(2UL).GetName() == "swap 2 <-> 3");
+  REQUIRE(restored.GetSwapStats(2UL).GetProposed() ==
+          pt.GetSwapStats(2UL).GetProposed());
+
+  auto pool = ThreadPool(3UL);
+  for (auto k = 0UL; k < 100UL; k++) {
+    pt.Step(pool, 10UL, step, energy);
+    restored.Step(pool, 10UL, step, energy);
+  }
+  for (auto r = 0UL; r < pt.GetSize(); r++) {
+    REQUIRE(restored.GetReplica(r).x == pt.GetReplica(r).x);
+    REQUIRE(restored.GetLabel(r) == pt.GetLabel(r));
+  }
+}
+
+TEST_CASE("the temperatures must match the replicas")
+{
+  REQUIRE_THROWS_AS(Tempering(std::vector<Particle>(3UL), temperatures(), 1UL),
+                    montecarlo::exception::TemperatureMismatch);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,109 @@
+//===-- PhiloxTest.cpp -----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the Philox4x32 generator
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/Philox.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <random>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("the bijection matches the known answers")
+{
+  // from the known answer tests of Random123
+  using ctr_t = Philox4x32::counter_type;
+  using key_t = Philox4x32::key_type;
+
+  constexpr auto zero = Philox4x32::Generate({}, {});
+  static_assert(zero[0] == 0x6627e8d5U && zero[3] == 0x9b00dbd8U);
+  REQUIRE(zero ==
+          ctr_t{ 0x6627e8d5U, 0xe169c58dU, 0xbc57ac4cU, 0x9b00dbd8U });
+
+  REQUIRE(Philox4x32::Generate(
+            { 0xffffffffU, 0xffffffffU, 0xffffffffU, 0xffffffffU },
+            { 0xffffffffU, 0xffffffffU }) ==
+          ctr_t{ 0x408f276dU, 0x41c83b0eU, 0xa20bc7c6U, 0x6d5451fdU });
+  REQUIRE(Philox4x32::Generate(
+            { 0x243f6a88U, 0x85a308d3U, 0x13198a2eU, 0x03707344U },
+            key_t{ 0xa4093822U, 0x299f31d0U }) ==
+          ctr_t{ 0xd16cfe09U, 0x94fdccebU, 0x5001e420U, 0x24126ea1U });
+
+  auto rng = Philox4x32(0UL);
+  REQUIRE(rng() == 0x6627e8d5U);
+  REQUIRE(rng() == 0xe169c58dU);
+}
+
+TEST_CASE("streams, jumps and bulk fills agree with the sequence")
+{
+  auto rng = Philox4x32(42UL, 3UL);
+  auto seq = std::vector<Philox4x32::result_type>(1000UL);
+  for (auto& x : seq) {
+    x = rng();
+  }
+
+  REQUIRE(rng.GetSeed() == 42UL);
+  REQUIRE(rng.GetStream() == 3UL);
+  REQUIRE(Philox4x32(42UL).Split(3UL) == Philox4x32(42UL, 3UL));
+  REQUIRE(Philox4x32(42UL).Split(4UL)() != Philox4x32(42UL, 3UL)());
+
+  for (auto skip : { 0UL, 1UL, 3UL, 4UL, 5UL, 517UL }) {
+    auto jump = Philox4x32(42UL, 3UL);
+    jump();
+    jump.discard(skip);
+    REQUIRE(jump() == seq[skip + 1UL]);
+  }
+
+  // unaligned start and end around the vectorized part
+  auto fill = Philox4x32(42UL, 3UL);
+  fill();
+  auto out = std::vector<Philox4x32::result_type>(998UL);
+  fill.Fill(out.data(), out.size());
+  REQUIRE(std::equal(out.begin(), out.end(), seq.begin() + 1L));
+  REQUIRE(fill() == seq[999]);
+
+  // usable with the standard distributions
+  auto udist = std::uniform_real_distribution<double>(0.0, 1.0);
+  auto x = udist(rng);
+  REQUIRE(x >= 0.0);
+  REQUIRE(x < 1.0);
+}
+
+TEST_CASE("the generator can be checkpointed")
+{
+  auto rng = Philox4x32(7UL, 1UL);
+  rng.discard(10UL);
+  rng();
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << rng;
+  }
+  auto rng2 = Philox4x32{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> rng2;
+
+  REQUIRE(rng2 == rng);
+  REQUIRE(rng2() == rng());
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
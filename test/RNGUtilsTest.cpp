@@ -0,0 +1,235 @@
+//===-- RNGUtilsTest.cpp ---------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the utilities for random number generators
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/RNGUtils.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+///
+/// Minimal archive keeping raw bytes in memory, enough to drive the
+/// serialization of the engines without linking the Boost archives
+///
+template<bool Saving>
+class MemoryArchive
+{
+public:
+  using is_saving = std::integral_constant<bool, Saving>;
+  using is_loading = std::integral_constant<bool, !Saving>;
+
+  explicit MemoryArchive(std::string bytes = {})
+    : bytes_(std::move(bytes))
+  {}
+
+  template<typename T>
+  auto operator&(T& x) -> MemoryArchive&
+  {
+    if constexpr (std::is_arithmetic<T>::value) {
+      Binary(&x, sizeof(T));
+    } else if constexpr (std::is_same<T, std::string>::value) {
+      auto n = x.size();
+      Binary(&n, sizeof(n));
+      x.resize(n);
+      Binary(x.data(), n);
+    } else {
+      using type = std::remove_const_t<T>;
+      boost::serialization::serialize_adl(
+        *this,
+        const_cast<type&>(x),
+        boost::serialization::version<type>::value);
+    }
+    return *this;
+  }
+
+  template<typename T>
+  auto operator&(T const& x) -> MemoryArchive&
+  {
+    return *this & const_cast<T&>(x);
+  }
+
+  auto save_binary(void const* data, size_t size) -> void
+  {
+    bytes_.append(static_cast<char const*>(data), size);
+  };
+
+  auto load_binary(void* data, size_t size) -> void
+  {
+    REQUIRE(pos_ + size <= bytes_.size());
+    std::memcpy(data, bytes_.data() + pos_, size);
+    pos_ += size;
+  };
+
+  auto Binary(void* data, size_t size) -> void
+  {
+    if constexpr (Saving) {
+      save_binary(data, size);
+    } else {
+      load_binary(data, size);
+    }
+  };
+
+  [[nodiscard]] auto GetBytes() const -> std::string const& { return bytes_; };
+
+private:
+  std::string bytes_{};
+  size_t pos_{ 0UL };
+};
+
+template<typename Engine>
+auto
+save(Engine const& e) -> std::string
+{
+  auto ar = MemoryArchive<true>{};
+  boost::serialization::serialize(
+    ar, const_cast<Engine&>(e), boost::serialization::version<Engine>::value);
+  return ar.GetBytes();
+}
+
+template<typename Engine>
+auto
+load(std::string bytes,
+     unsigned version = boost::serialization::version<Engine>::value)
+  -> Engine
+{
+  auto e = Engine{};
+  auto ar = MemoryArchive<false>(std::move(bytes));
+  boost::serialization::serialize(ar, e, version);
+  return e;
+}
+
+TEST_CASE("the state of the engines can be copied")
+{
+  auto rng = std::mt19937_64(42UL);
+  rng.discard(1000UL);
+
+  auto state = bwsl::get_state(rng);
+  auto copy = std::mt19937_64{};
+  bwsl::set_state(copy, state);
+  REQUIRE(copy == rng);
+  REQUIRE(copy() == rng());
+
+  state.pos = 313UL;
+  REQUIRE_THROWS_AS(bwsl::set_state(copy, state), std::invalid_argument);
+}
+
+TEST_CASE("states of other standard libraries are converted")
+{
+  using Layout = bwsl::MersenneTwisterLayout;
+  auto const n = std::mt19937::state_size;
+
+  // a seeded engine has the words of the sequence in order
+  auto rng = std::mt19937(5489U);
+  auto words = bwsl::get_state(rng);
+
+  // libstdc++ regenerates the words when the position reaches n
+  auto libstdcxx = words;
+  libstdcxx.pos = n;
+  auto copy = std::mt19937{};
+  bwsl::set_state(copy, libstdcxx, Layout::LibStdCxx);
+  REQUIRE(copy == rng);
+
+  // libc++ keeps the oldest word at the position
+  auto libcxx = words;
+  std::rotate(std::begin(libcxx.words),
+              std::begin(libcxx.words) + (n - 100UL),
+              std::end(libcxx.words));
+  libcxx.pos = 100UL;
+  copy = std::mt19937{};
+  bwsl::set_state(copy, libcxx, Layout::LibCxx);
+  REQUIRE(copy == rng);
+  for (auto i = 0; i < 2000; i++) {
+    REQUIRE(copy() == rng());
+  }
+
+  libcxx.pos = n;
+  REQUIRE_THROWS_AS(bwsl::set_state(copy, libcxx, Layout::LibCxx),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(bwsl::set_state(copy, words, Layout::Unknown),
+                    std::invalid_argument);
+}
+
+TEST_CASE("engines are serialized as raw words")
+{
+  auto rng = std::mt19937_64(19890501UL);
+  auto rng32 = std::mt19937(1UL);
+  rng.discard(777UL);
+  rng32.discard(777UL);
+
+  auto bytes = save(rng);
+  auto bytes32 = save(rng32);
+
+  // tags, words and position
+  REQUIRE(bytes.size() == 3UL + 312UL * 8UL + 8UL);
+  REQUIRE(bytes32.size() == 3UL + 624UL * 4UL + 8UL);
+  REQUIRE(bytes[2] == static_cast<char>(bwsl::mersenne_twister_layout));
+
+  // the same engine always gives the same bytes
+  REQUIRE(save(rng) == bytes);
+
+  auto rng2 = load<std::mt19937_64>(bytes);
+  auto rng322 = load<std::mt19937>(bytes32);
+  REQUIRE(rng2 == rng);
+  REQUIRE(rng322 == rng32);
+  REQUIRE(rng2() == rng());
+  REQUIRE(rng322() == rng32());
+
+  SECTION("archives with the other byte order are swapped")
+  {
+    auto other = bytes32;
+    other[0] = static_cast<char>(other[0] == 1 ? 2 : 1);
+    for (auto i = 0UL; i < 624UL; i++) {
+      std::reverse(other.begin() + 3L + 4L * static_cast<long>(i),
+                   other.begin() + 7L + 4L * static_cast<long>(i));
+    }
+    REQUIRE(load<std::mt19937>(other) == load<std::mt19937>(bytes32));
+  }
+
+  SECTION("wrong word sizes are rejected")
+  {
+    REQUIRE_THROWS_AS(load<std::mt19937>(bytes), std::invalid_argument);
+  }
+
+  SECTION("archives of the first version have no layout")
+  {
+    auto first = bytes;
+    first.erase(2UL, 1UL);
+    REQUIRE(load<std::mt19937_64>(first, 1U) == load<std::mt19937_64>(bytes));
+  }
+}
+
+TEST_CASE("engines saved as text can still be loaded")
+{
+  auto rng = std::mt19937_64(7UL);
+  rng.discard(100UL);
+
+  auto oss = std::ostringstream{};
+  oss << rng;
+  auto ar = MemoryArchive<true>{};
+  auto text = oss.str();
+  ar & text;
+
+  REQUIRE(load<std::mt19937_64>(ar.GetBytes(), 0U) == rng);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
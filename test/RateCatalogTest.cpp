@@ -0,0 +1,104 @@
+//===-- RateCatalogTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the RateCatalog Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+#include <bwsl/sampling/KarySumTree.hpp>
+
+// std
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+
+TEST_CASE("events are drawn with their rates and time advances")
+{
+  // two hopping events and one rare desorption
+  auto catalog = RateCatalog<>(3UL, { "Hop", "Desorb" });
+  catalog.SetRate(0UL, 1.0);
+  catalog.SetRate(1UL, 2.0);
+  catalog.SetRate(2UL, 1.0);
+  catalog.SetChannel(2UL, 1UL);
+  REQUIRE(catalog.GetTotalRate() == 4.0);
+  REQUIRE(catalog.GetNumChannels() == 2UL);
+
+  auto rng = UniformBuffer<Philox4x32>(Philox4x32(5UL));
+  auto counts = std::vector<double>(3UL, 0.0);
+  auto const n = 100000;
+  for (auto i = 0; i < n; i++) {
+    catalog.Step(rng, [&](size_t idx) {
+      counts[idx] += 1.0;
+      return idx == 2UL ? MoveResult::Reject(0.0) : MoveResult::Accept(1.0);
+    });
+  }
+
+  REQUIRE(counts[0] / n == Approx(0.25).margin(0.01));
+  REQUIRE(counts[1] / n == Approx(0.5).margin(0.01));
+  // the mean waiting time is the inverse of the total rate
+  REQUIRE(catalog.GetTime() / n == Approx(0.25).margin(0.005));
+
+  auto const& hop = catalog.GetStats(0UL);
+  auto const& desorb = catalog.GetStats(1UL);
+  REQUIRE(hop.GetName() == "Hop");
+  REQUIRE(hop.GetAcceptedRatio() == 1.0);
+  REQUIRE(desorb.GetRejectedRatio() == 1.0);
+
+  // an event without rate is never drawn
+  catalog.SetRate(1UL, 0.0);
+  for (auto i = 0; i < 1000; i++) {
+    REQUIRE(catalog.Select(rng).index != 1UL);
+  }
+}
+
+TEST_CASE("catalogs with a k-ary tree can be checkpointed")
+{
+  auto catalog = RateCatalog<sampling::KarySumTree<>>(100UL, { "A", "B" });
+  for (auto i = 0UL; i < 100UL; i++) {
+    catalog.SetRate(i, 1.0 + static_cast<double>(i));
+    catalog.SetChannel(i, i % 2UL);
+  }
+  auto rng = Philox4x32(3UL);
+  for (auto i = 0; i < 100; i++) {
+    catalog.Step(rng, [](size_t) { return MoveResult::Accept(1.0); });
+  }
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << catalog;
+  }
+  auto restored = RateCatalog<sampling::KarySumTree<>>{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+
+  REQUIRE(restored.GetTime() == catalog.GetTime());
+  REQUIRE(restored.GetTotalRate() == catalog.GetTotalRate());
+  REQUIRE(restored.GetChannel(3UL) == 1UL);
+  REQUIRE(restored.GetStats(1UL).GetName() == "B");
+  REQUIRE(restored.GetStats(1UL).GetAcceptedRatio() == 1.0);
+
+  auto rng2 = rng;
+  REQUIRE(restored.Select(rng2).index == catalog.Select(rng).index);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
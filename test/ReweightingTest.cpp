@@ -0,0 +1,112 @@
+//===-- ReweightingTest.cpp ------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the MultiHistogramReweighting Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/LinSpace.hpp>
+#include <bwsl/Reweighting.hpp>
+
+// std
+#include <cmath>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+TEST_CASE("reweighting recovers the density of states of free spins")
+{
+  auto const nspins = 40;
+  auto const nsamples = 200000UL;
+  auto gen = std::mt19937_64(19890501UL);
+
+  auto energies = std::vector<double>{};
+  for (auto e = 0; e <= nspins; e++) {
+    energies.push_back(e);
+  }
+
+  auto rw = MultiHistogramReweighting(energies, 2UL);
+  for (auto beta : LinSpace<double>(-1.0, 1.0, 4UL).Collect(5UL)) {
+    auto h = HistAccumulator(energies.size());
+    auto p = 1.0 / (1.0 + std::exp(beta));
+    auto d = std::binomial_distribution<int>(nspins, p);
+    for (auto s = 0UL; s < nsamples; s++) {
+      h.Add(static_cast<size_t>(d(gen)));
+    }
+    rw.AddSimulation(beta, h);
+  }
+  REQUIRE(rw.GetNumSimulations() == 5UL);
+
+  auto iters = rw.Solve(1e-10);
+  REQUIRE(iters > 1UL);
+  REQUIRE(rw.GetFreeEnergies()[0] == 0.0);
+
+  // compare the well sampled bins with the exact log binomial coefficients
+  auto const& logg = rw.GetLogDensity();
+  auto lchoose = [](int n, int k) {
+    return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) -
+           std::lgamma(n - k + 1.0);
+  };
+  auto shift = logg[20] - lchoose(nspins, 20);
+  for (auto e = 10; e <= 30; e++) {
+    REQUIRE(logg[e] - shift == Approx(lchoose(nspins, e)).epsilon(1e-2));
+  }
+
+  // interpolate between the simulated temperatures
+  auto betas = LinSpace<double>(-0.9, 0.9, 9UL).Collect(9UL);
+  auto pool = ThreadPool(4UL);
+  auto u =
+    rw.Interpolate(pool, betas, [&rw](double b) { return rw.GetEnergy(b); });
+  for (auto j = 0UL; j < betas.size(); j++) {
+    auto exact = nspins / (1.0 + std::exp(betas[j]));
+    REQUIRE(u[j] == Approx(exact).epsilon(2e-3));
+  }
+
+  auto b = 0.3;
+  auto p = 1.0 / (1.0 + std::exp(b));
+  auto cv = b * b * nspins * p * (1.0 - p);
+  REQUIRE(rw.GetSpecificHeat(b) == Approx(cv).epsilon(2e-2));
+
+  REQUIRE_THROWS(rw.AddSimulation(0.0, HistAccumulator(3UL)));
+}
+
+TEST_CASE("reweighting does not depend on the number of threads")
+{
+  auto energies = std::vector<double>{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+  auto solve = [&energies](size_t nthreads) {
+    auto rw = MultiHistogramReweighting(energies, nthreads);
+    for (auto k = 0UL; k < 3UL; k++) {
+      auto h = HistAccumulator(energies.size());
+      for (auto i = 0UL; i < energies.size(); i++) {
+        for (auto n = 0UL; n < 1UL + (i * (k + 1UL)) % 5UL; n++) {
+          h.Add(i);
+        }
+      }
+      rw.AddSimulation(0.1 * static_cast<double>(k), h);
+    }
+    rw.Solve(1e-12);
+    return rw.GetLogDensity();
+  };
+  REQUIRE(solve(1UL) == solve(3UL));
+  REQUIRE(solve(1UL) == solve(16UL));
+
+  auto empty = MultiHistogramReweighting(energies, 2UL);
+  REQUIRE_THROWS_AS(empty.Solve(), exception::ReweightingNoSimulations);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
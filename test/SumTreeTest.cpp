@@ -0,0 +1,79 @@
+//===-- SumTreeTest.cpp ----------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the SumTree Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/sampling/SumTree.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("indices are found from the cumulative weights")
+{
+  auto tree = sampling::SumTree({ 1.0, 0.0, 2.0, 3.0, 0.0 });
+  REQUIRE(tree.GetSize() == 5UL);
+  REQUIRE(tree.GetTotal() == 6.0);
+
+  REQUIRE(tree.Find(0.0) == 0UL);
+  REQUIRE(tree.Find(0.999) == 0UL);
+  REQUIRE(tree.Find(1.0) == 2UL);
+  REQUIRE(tree.Find(2.999) == 2UL);
+  REQUIRE(tree.Find(3.0) == 3UL);
+  // rounding beyond the total never selects a zero weight
+  REQUIRE(tree.Find(6.0) == 3UL);
+
+  tree.Set(4UL, 4.0);
+  tree.Set(0UL, 0.0);
+  REQUIRE(tree.GetTotal() == 9.0);
+  REQUIRE(tree.Get(4UL) == 4.0);
+  REQUIRE(tree.Find(0.0) == 2UL);
+  REQUIRE(tree.Find(5.5) == 4UL);
+
+  REQUIRE_THROWS_AS(tree.Set(1UL, -1.0), exception::InvalidWeights);
+  REQUIRE_THROWS_AS(sampling::SumTree(3UL).Find(0.0),
+                    exception::InvalidWeights);
+}
+
+TEST_CASE("updates do not drift and samples follow the weights")
+{
+  auto rng = std::mt19937_64(17UL);
+  auto udist = std::uniform_real_distribution<double>(0.0, 1e6);
+  auto tree = sampling::SumTree(1000UL);
+  for (auto i = 0; i < 100000; i++) {
+    tree.Set(rng() % 1000UL, udist(rng));
+  }
+  for (auto i = 0UL; i < 1000UL; i++) {
+    tree.Set(i, i < 4UL ? 1.0 : 0.0);
+  }
+  REQUIRE(tree.GetTotal() == 4.0);
+
+  tree.Set(3UL, 2.0);
+  auto counts = std::vector<double>(5UL, 0.0);
+  auto const n = 100000;
+  for (auto i = 0; i < n; i++) {
+    counts[tree.Sample(rng)] += 1.0;
+  }
+  REQUIRE(counts[0] / n == Approx(0.2).margin(0.01));
+  REQUIRE(counts[3] / n == Approx(0.4).margin(0.01));
+  REQUIRE(counts[4] == 0.0);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
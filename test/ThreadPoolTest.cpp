@@ -0,0 +1,78 @@
+//===-- ThreadPoolTest.cpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ThreadPool Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/ThreadPool.hpp>
+
+// std
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("every task runs once")
+{
+  for (auto nthreads : { 1UL, 3UL, 8UL }) {
+    auto pool = ThreadPool(nthreads);
+    REQUIRE(pool.GetNumThreads() == nthreads);
+
+    auto hits = std::vector<std::atomic<int>>(1000UL);
+    pool.ParallelFor(0UL, hits.size(), [&hits](size_t i) { hits[i]++; });
+    for (auto const& h : hits) {
+      REQUIRE(h.load() == 1);
+    }
+  }
+}
+
+TEST_CASE("tasks can submit other tasks")
+{
+  auto pool = ThreadPool(4UL);
+  auto count = std::atomic<size_t>{ 0UL };
+  for (auto i = 0UL; i < 10UL; i++) {
+    pool.Submit([&pool, &count]() {
+      for (auto j = 0UL; j < 100UL; j++) {
+        pool.Submit([&count]() { count++; });
+      }
+      count++;
+    });
+  }
+  pool.Wait();
+  REQUIRE(count.load() == 1010UL);
+}
+
+TEST_CASE("exceptions reach the waiting thread")
+{
+  auto pool = ThreadPool(2UL);
+  auto count = std::atomic<size_t>{ 0UL };
+  REQUIRE_THROWS_AS(pool.ParallelFor(0UL,
+                                     100UL,
+                                     [&count](size_t i) {
+                                       count++;
+                                       if (i == 42UL) {
+                                         throw std::runtime_error("42");
+                                       }
+                                     }),
+                    std::runtime_error);
+  REQUIRE(count.load() == 100UL);
+
+  // the pool can still be used
+  pool.ParallelFor(0UL, 10UL, [&count](size_t) { count++; });
+  REQUIRE(count.load() == 110UL);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
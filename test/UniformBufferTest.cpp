@@ -0,0 +1,108 @@
+//===-- UniformBufferTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the UniformBuffer Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/MathUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/UniformBuffer.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("numbers come from the upper bits of the generator")
+{
+  auto rng = std::mt19937_64(5UL);
+  auto buf = UniformBuffer<std::mt19937_64>(rng, 100UL);
+  for (auto i = 0; i < 250; i++) {
+    auto expected = static_cast<double>(rng() >> 11U) * 0x1.0p-53;
+    REQUIRE(buf() == expected);
+  }
+  REQUIRE(buf.GetAvailable() == 50UL);
+
+  // two 32 bits words for each double
+  auto philox = Philox4x32(9UL);
+  auto pbuf = UniformBuffer<Philox4x32>(philox, 64UL);
+  for (auto i = 0; i < 100; i++) {
+    auto hi = std::uint64_t{ philox() };
+    auto x = (hi << 32U) | philox();
+    REQUIRE(pbuf() == static_cast<double>(x >> 11U) * 0x1.0p-53);
+  }
+
+  auto fbuf = UniformBuffer<std::mt19937, float>(std::mt19937(1UL), 16UL);
+  auto mt = std::mt19937(1UL);
+  for (auto i = 0; i < 40; i++) {
+    auto x = fbuf();
+    REQUIRE(x == static_cast<float>(mt() >> 8U) * 0x1.0p-24F);
+    REQUIRE(x < 1.0F);
+  }
+
+  REQUIRE_THROWS_AS(UniformBuffer<std::mt19937_64>(rng, 0UL),
+                    std::invalid_argument);
+}
+
+TEST_CASE("bulk fills and helpers use the buffered numbers")
+{
+  auto a = UniformBuffer<Philox4x32>(Philox4x32(3UL), 32UL);
+  auto b = a;
+
+  auto out = std::vector<double>(100UL);
+  a.Fill(out.data(), out.size());
+  for (auto x : out) {
+    REQUIRE(x == b());
+  }
+
+  auto hits = 0;
+  for (auto i = 0; i < 1000; i++) {
+    REQUIRE_FALSE(choose_with_probability(0.0, a));
+    REQUIRE(choose_with_probability(1.0, a));
+    hits += choose_with_probability(0.5, a) ? 1 : 0;
+  }
+  REQUIRE(hits > 400);
+  REQUIRE(hits < 600);
+
+  auto probs = std::vector<double>{ 0.0, 1.0, 0.0 };
+  REQUIRE(choose_between(probs, a) == 1UL);
+  REQUIRE(choose_between_psums(std::vector<double>{ 0.0, 0.0, 2.0 }, a) == 2UL);
+}
+
+TEST_CASE("the buffer can be checkpointed")
+{
+  auto buf = UniformBuffer<std::mt19937_64>(std::mt19937_64(11UL), 8UL);
+  buf();
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << buf;
+  }
+  auto restored = UniformBuffer<std::mt19937_64>{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+
+  for (auto i = 0; i < 20; i++) {
+    REQUIRE(restored() == buf());
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,82 @@
+//===-- UnionFindTest.cpp --------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the UnionFind Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/UnionFind.hpp>
+
+// std
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+
+TEST_CASE("sets are merged")
+{
+  auto uf = UnionFind(10UL);
+  REQUIRE(uf.Size() == 10UL);
+  REQUIRE(uf.Unite(1UL, 2UL));
+  REQUIRE(uf.Unite(3UL, 2UL));
+  REQUIRE_FALSE(uf.Unite(1UL, 3UL));
+  REQUIRE(uf.Unite(7UL, 8UL));
+
+  REQUIRE(uf.Find(1UL) == uf.Find(3UL));
+  REQUIRE(uf.FindRoot(2UL) == uf.Find(1UL));
+  REQUIRE(uf.Find(1UL) != uf.Find(7UL));
+  REQUIRE(uf.GetSize(uf.Find(3UL)) == 3UL);
+  REQUIRE(uf.GetSize(uf.Find(8UL)) == 2UL);
+  REQUIRE(uf.GetSize(uf.Find(0UL)) == 1UL);
+
+  uf.Reset(0UL, 5UL);
+  REQUIRE(uf.Find(1UL) == 1UL);
+  REQUIRE(uf.Find(7UL) == uf.Find(8UL));
+}
+
+TEST_CASE("the sets match a brute force labeling")
+{
+  auto const n = 500UL;
+  auto rng = std::mt19937_64(7UL);
+  auto uf = UnionFind(n);
+  auto labels = std::vector<size_t>(n);
+  for (auto i = 0UL; i < n; i++) {
+    labels[i] = i;
+  }
+
+  for (auto k = 0; k < 300; k++) {
+    auto a = rng() % n;
+    auto b = rng() % n;
+    uf.Unite(a, b);
+    auto from = labels[b];
+    for (auto& l : labels) {
+      if (l == from) {
+        l = labels[a];
+      }
+    }
+  }
+
+  auto total = 0UL;
+  for (auto i = 0UL; i < n; i++) {
+    for (auto j = 0UL; j < n; j += 7UL) {
+      REQUIRE((uf.FindRoot(i) == uf.FindRoot(j)) == (labels[i] == labels[j]));
+    }
+    if (uf.IsRoot(i)) {
+      total += uf.GetSize(i);
+    }
+  }
+  REQUIRE(total == n);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,182 @@
+//===-- ValueHistAccumulatorTest.cpp ---------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the ValueHistAccumulator Class
+///
+//===---------------------------------------------------------------------===//
+
+// bwsl
+#include <bwsl/ValueHistAccumulator.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using Catch::Approx;
+
+/// Reference bin of a value found with a binary search on the edges
+template<class Binning>
+auto
+reference_index(Binning const& b, double x) -> long
+{
+  auto edges = b.GetEdges();
+  auto it = std::upper_bound(edges.begin(), edges.end(), x);
+  return static_cast<long>(it - edges.begin()) - 1L;
+}
+
+TEST_CASE("binnings map values like a search on the edges")
+{
+  auto gen = std::mt19937(19890501UL);
+  auto lin = LinearBinning(LinSpace<double>(-2.0, 3.0, 10UL));
+  auto log = LogBinning(LogSpace<double>(1e-3, 1e3, 12UL));
+  auto log2 = Log2Binning(-4, 6, 3U);
+
+  REQUIRE(lin.GetNbins() == 10UL);
+  REQUIRE(log.GetNbins() == 12UL);
+  REQUIRE(log2.GetNbins() == 80UL);
+  REQUIRE(log2.GetEdges().front() == 1.0 / 16.0);
+  REQUIRE(log2.GetEdges().back() == 64.0);
+
+  auto ulin = std::uniform_real_distribution<double>(-1.99, 2.99);
+  auto ulog = std::uniform_real_distribution<double>(-6.9, 6.9);
+  auto ulog2 = std::uniform_real_distribution<double>(-2.7, 4.1);
+  for (auto i = 0; i < 10000; i++) {
+    auto x = ulin(gen);
+    auto y = std::exp(ulog(gen));
+    auto z = std::exp(ulog2(gen));
+    // values too close to an edge may fall on either side
+    auto k = lin.Index(x);
+    REQUIRE(std::abs(k - reference_index(lin, x)) <= 1L);
+    auto l = log.Index(y);
+    REQUIRE(std::abs(l - reference_index(log, y)) <= 1L);
+    REQUIRE(log2.Index(z) == reference_index(log2, z));
+  }
+
+  REQUIRE(lin.Index(-2.5) < 0L);
+  REQUIRE(lin.Index(3.5) == 10L);
+  REQUIRE(lin.Index(std::numeric_limits<double>::quiet_NaN()) == 10L);
+  REQUIRE(log.Index(-1.0) < 0L);
+  REQUIRE(log2.Index(0.0) < 0L);
+  REQUIRE(log2.Index(1e-3) < 0L);
+  REQUIRE(log2.Index(1e3) == 80L);
+}
+
+TEST_CASE("value histograms count in and out of range values")
+{
+  auto h = ValueHistAccumulator<LinearBinning>(LinearBinning(0.0, 1.0, 4UL));
+
+  auto values = std::vector<double>{ 0.1, 0.3, 0.35, 0.9, -1.0, 2.0, 0.6 };
+  h.AddValues(values.begin(), values.end());
+
+  REQUIRE(h.GetCount() == 7UL);
+  REQUIRE(h.GetUnderflow() == 1UL);
+  REQUIRE(h.GetOverflow() == 1UL);
+  REQUIRE(h.GetCount(0UL) == 1UL);
+  REQUIRE(h.GetCount(1UL) == 2UL);
+  REQUIRE(h.GetCount(2UL) == 1UL);
+  REQUIRE(h.GetCount(3UL) == 1UL);
+  REQUIRE(h.GetResult(1UL) == Approx(2.0 / 7.0));
+
+  // batched and single insertions agree
+  auto g = ValueHistAccumulator<LinearBinning>(LinearBinning(0.0, 1.0, 4UL));
+  for (auto v : values) {
+    g.AddValue(v);
+  }
+  REQUIRE(g.GetResults() == h.GetResults());
+
+  h.AddValue(0.8, 3.0);
+  REQUIRE(h.GetCount() == 8UL);
+  REQUIRE(h.GetResult(3UL) == Approx(4.0 / 8.0));
+  REQUIRE(h.GetResult(1UL) == Approx(2.0 / 8.0));
+
+  h.Reset();
+  REQUIRE(h.GetCount() == 0UL);
+  REQUIRE(h.GetResult(1UL) == 0.0);
+}
+
+TEST_CASE("adaptive value histograms widen their range")
+{
+  SECTION("linear")
+  {
+    auto h = ValueHistAccumulator<LinearBinning>(LinearBinning(0.0, 1.0, 4UL),
+                                                 true);
+    h.AddValue(0.1);
+    h.AddValue(0.3);
+    h.AddValue(3.5);
+    REQUIRE(h.GetEdges().back() == 4.0);
+    REQUIRE(h.GetCount(0UL) == 2UL);
+    REQUIRE(h.GetCount(3UL) == 1UL);
+
+    h.AddValue(-1.0, 2.0);
+    REQUIRE(h.GetEdges().front() == -4.0);
+    REQUIRE(h.GetNbins() == 4UL);
+    REQUIRE(h.GetCount(1UL) == 1UL);
+    REQUIRE(h.GetCount(2UL) == 2UL);
+    REQUIRE(h.GetCount(3UL) == 1UL);
+    REQUIRE(h.GetResult(1UL) == Approx(0.5));
+    REQUIRE(h.GetUnderflow() + h.GetOverflow() == 0UL);
+
+    h.AddValue(std::numeric_limits<double>::quiet_NaN());
+    REQUIRE(h.GetOverflow() == 1UL);
+  }
+
+  SECTION("log2")
+  {
+    auto h = ValueHistAccumulator<Log2Binning>(Log2Binning(0, 2, 2U), true);
+    auto values = std::vector<double>{ 1.1, 1.3, 3.9, 10.0, 0.3 };
+    h.AddValues(values.begin(), values.end());
+
+    auto edges = h.GetEdges();
+    REQUIRE(edges.front() == 0.0625);
+    REQUIRE(h.GetNbins() == 8UL);
+    REQUIRE(edges.back() == 16.0);
+    for (auto v : values) {
+      auto i = reference_index(h.GetBinning(), v);
+      REQUIRE(h.GetCount(static_cast<size_t>(i)) >= 1UL);
+    }
+    REQUIRE(h.GetCount() == values.size());
+  }
+
+  SECTION("out of reach")
+  {
+    REQUIRE_THROWS_AS(ValueHistAccumulator<LinearBinning>(
+                        LinearBinning(0.0, 1.0, 3UL), true),
+                      exception::BinningCannotWiden);
+    REQUIRE_THROWS_AS(
+      ValueHistAccumulator<LogBinning>(LogBinning(1.0, 2.0, 5UL), true),
+      exception::BinningCannotWiden);
+
+    // the doubled range would overflow, the values stay out of range
+    auto h = ValueHistAccumulator<LinearBinning>(
+      LinearBinning(0.0, 1e308, 2UL), true);
+    h.AddValue(1.5e308);
+    h.AddValue(-1.5e308, 2.0);
+    h.AddValue(1.0);
+    REQUIRE(h.GetCount() == 3UL);
+    REQUIRE(h.GetCount(0UL) + h.GetCount(1UL) == 1UL);
+    REQUIRE(h.GetOverflow() + h.GetUnderflow() == 2UL);
+
+    // once every sub-bit is used the octaves cannot double any more
+    auto l = ValueHistAccumulator<Log2Binning>(Log2Binning(0, 2, 1U), true);
+    l.AddValue(1e300);
+    REQUIRE(l.GetOverflow() == 1UL);
+  }
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,134 @@
+//===-- WangLandauTest.cpp -------------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the WangLandau Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/Philox.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+using Catch::Approx;
+
+namespace {
+
+/// Log of the binomial coefficient
+auto
+lnbinomial(double n, double k) -> double
+{
+  return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+}
+
+/// Flip a random coin out of @p n, @p up of which show heads
+auto
+flip(WangLandau& wl, size_t n, size_t& up, Philox4x32& rng) -> void
+{
+  auto heads = draw_uniform(static_cast<double>(n), rng) < up;
+  auto to = heads ? up - 1UL : up + 1UL;
+  if (wl.Step(up, to, rng)) {
+    up = to;
+  }
+}
+
+} // namespace
+
+TEST_CASE("the density of states of coins is binomial")
+{
+  auto const n = 12UL;
+  auto wl = WangLandau(0UL, n + 1UL, 0.8, 1e-5);
+  auto rng = Philox4x32(1UL);
+  auto up = 0UL;
+  while (!wl.IsDone()) {
+    flip(wl, n, up, rng);
+  }
+
+  REQUIRE(wl.IsInverseTime());
+  REQUIRE(wl.GetIterations() > 5UL);
+
+  // the lowest count is still reported once ln f follows 1/t
+  auto min = wl.GetHistogram().GetCount(0UL);
+  for (auto k = 1UL; k <= n; k++) {
+    min = std::min(min, wl.GetHistogram().GetCount(k));
+  }
+  REQUIRE(wl.GetMinCount() == min);
+  auto lng = wl.GetLogDensity();
+  for (auto k = 0UL; k <= n; k++) {
+    REQUIRE(lng[k] == Approx(lnbinomial(n, k)).margin(0.1));
+  }
+}
+
+TEST_CASE("the flatness is tracked at every visit")
+{
+  // never flat, so the histogram is never reset
+  auto wl = WangLandau(5UL, 25UL, 1.1);
+  auto rng = Philox4x32(2UL);
+  for (auto i = 0; i < 20000; i++) {
+    // uneven visits, the first bins more often
+    auto x = draw_uniform(1.0, rng);
+    auto b = 5UL + static_cast<size_t>(20.0 * x * x);
+    wl.Visit(b);
+
+    auto min = wl.GetHistogram().GetCount(0UL);
+    for (auto k = 1UL; k < wl.GetNbins(); k++) {
+      min = std::min(min, wl.GetHistogram().GetCount(k));
+    }
+    REQUIRE(wl.GetMinCount() == min);
+    REQUIRE_FALSE(wl.IsFlat());
+  }
+  REQUIRE(wl.GetIterations() == 0UL);
+  REQUIRE(wl.GetHistogram().GetCount() == 20000UL);
+}
+
+TEST_CASE("a sampler resumes from its checkpoint")
+{
+  auto const n = 10UL;
+  auto wl = WangLandau(0UL, n + 1UL);
+  auto rng = Philox4x32(3UL);
+  auto up = 0UL;
+  for (auto i = 0; i < 5000; i++) {
+    flip(wl, n, up, rng);
+  }
+
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << wl;
+  }
+  auto restored = WangLandau{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+  REQUIRE(restored.GetMinCount() == wl.GetMinCount());
+
+  auto rng2 = rng;
+  auto up2 = up;
+  for (auto i = 0; i < 5000; i++) {
+    flip(wl, n, up, rng);
+    flip(restored, n, up2, rng2);
+  }
+  REQUIRE(restored.GetLogDensity() == wl.GetLogDensity());
+  REQUIRE(restored.GetLogFactor() == wl.GetLogFactor());
+  REQUIRE(restored.GetIterations() == wl.GetIterations());
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //
@@ -0,0 +1,169 @@
+//===-- WangLandauWindowsTest.cpp ------------------------------*- C++ -*-===//
+//
+//                       BeagleWarlord's Support Library
+//
+// Copyright 2016-2022 Guido Masella. All Rights Reserved.
+// See LICENSE file for details
+//
+//===---------------------------------------------------------------------===//
+///
+/// @file
+/// @author     Guido Masella (guido.masella@gmail.com)
+/// @brief      Tests for the WangLandauWindows Class
+///
+//===---------------------------------------------------------------------===//
+// bwsl
+#include <bwsl/MonteCarloUtils.hpp>
+#include <bwsl/io/BinaryArchive.hpp>
+
+// std
+#include <cmath>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+// catch
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+using namespace bwsl;
+using namespace bwsl::montecarlo;
+using Catch::Approx;
+
+namespace {
+
+/// Number of coins
+constexpr auto ncoins = 16UL;
+
+/// Coins, the bin is the number of heads
+struct Coins
+{
+  std::vector<int> heads = std::vector<int>(ncoins, 0);
+  size_t up{ 0UL };
+
+  template<class Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    // clang-format off
+    ar & heads;
+    ar & up;
+    // clang-format on
+  }
+};
+
+/// Coins with @p up heads
+auto
+coins(size_t up) -> Coins
+{
+  auto c = Coins{};
+  for (auto i = 0UL; i < up; i++) {
+    c.heads[i] = 1;
+  }
+  c.up = up;
+  return c;
+}
+
+/// Flip a random coin
+auto
+flip(Coins& c, Philox4x32& rng, WangLandau& wl) -> void
+{
+  auto i = static_cast<size_t>(draw_uniform(static_cast<double>(ncoins), rng));
+  auto to = c.heads[i] == 1 ? c.up - 1UL : c.up + 1UL;
+  if (wl.Step(c.up, to, rng)) {
+    c.heads[i] = 1 - c.heads[i];
+    c.up = to;
+  }
+}
+
+/// Bin of the coins
+auto
+bin(Coins const& c) -> size_t
+{
+  return c.up;
+}
+
+using Windows = WangLandauWindows<Coins>;
+
+/// Three overlapping windows
+auto
+make(std::uint64_t seed) -> Windows
+{
+  return Windows({ coins(0UL), coins(6UL), coins(16UL) },
+                 { { 0UL, 8UL }, { 5UL, 13UL }, { 10UL, 17UL } },
+                 seed,
+                 0.8,
+                 1e-4);
+}
+
+} // namespace
+
+TEST_CASE("windows join into the binomial density of states")
+{
+  auto windows = make(1UL);
+  auto pool = ThreadPool(3UL);
+  while (!windows.IsDone()) {
+    windows.RunBlock(pool, 1000UL, flip, bin);
+  }
+
+  auto lng = windows.GetLogDensity();
+  REQUIRE(lng.size() == ncoins + 1UL);
+  for (auto k = 0UL; k <= ncoins; k++) {
+    auto exact = std::lgamma(ncoins + 1.0) - std::lgamma(k + 1.0) -
+                 std::lgamma(ncoins - k + 1.0);
+    REQUIRE(lng[k] == Approx(exact).margin(0.15));
+  }
+
+  for (auto k = 0UL; k + 1UL < windows.GetSize(); k++) {
+    REQUIRE(windows.GetSwapStats(k).GetAccepted() > 0UL);
+  }
+}
+
+TEST_CASE("windows do not depend on the number of threads")
+{
+  auto run = [](size_t nthreads) {
+    auto windows = make(2UL);
+    auto pool = ThreadPool(nthreads);
+    for (auto b = 0; b < 50; b++) {
+      windows.RunBlock(pool, 200UL, flip, bin);
+    }
+    return windows;
+  };
+
+  auto one = run(1UL);
+  auto many = run(4UL);
+  REQUIRE(many.GetLogDensity() == one.GetLogDensity());
+  for (auto k = 0UL; k < one.GetSize(); k++) {
+    REQUIRE(many.GetWalker(k).heads == one.GetWalker(k).heads);
+  }
+
+  // checkpoint and resume
+  auto ss = std::stringstream{};
+  {
+    auto oa = io::BinaryOArchive(ss);
+    oa << one;
+  }
+  auto restored = Windows{};
+  auto ia = io::BinaryIArchive(ss);
+  ia >> restored;
+  REQUIRE(restored.GetSwapStats(1UL).GetName() == "exchange 1 <-> 2");
+
+  auto pool = ThreadPool(2UL);
+  for (auto b = 0; b < 10; b++) {
+    one.RunBlock(pool, 200UL, flip, bin);
+    restored.RunBlock(pool, 200UL, flip, bin);
+  }
+  REQUIRE(restored.GetLogDensity() == one.GetLogDensity());
+}
+
+TEST_CASE("windows must overlap in order")
+{
+  using montecarlo::exception::InvalidWindows;
+  auto two = std::vector<Coins>(2UL);
+  REQUIRE_THROWS_AS(Windows(two, { { 0UL, 5UL }, { 5UL, 9UL } }, 1UL),
+                    InvalidWindows);
+  REQUIRE_THROWS_AS(Windows(two, { { 4UL, 9UL }, { 0UL, 5UL } }, 1UL),
+                    InvalidWindows);
+  REQUIRE_THROWS_AS(Windows(two, { { 0UL, 5UL } }, 1UL), InvalidWindows);
+}
+
+// vim: set ft=cpp ts=2 sts=2 et sw=2 tw=80: //